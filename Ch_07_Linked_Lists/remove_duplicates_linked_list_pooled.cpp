@@ -0,0 +1,310 @@
+/* SinglyLinkedList from remove_duplicates_linked_list_variant.cpp, with pooled node storage.
+ *
+ * The original list allocates every node with its own std::make_unique, and owns the nodes
+ * through a chain of unique_ptrs.  That has two problems for long lists:
+ *   - Destroying the list (or a removed block) destroys the first unique_ptr, which destroys
+ *     the next node, which destroys the next unique_ptr, ... - one level of recursion per
+ *     node, which overflows the stack somewhere around a million nodes.
+ *   - Every node is a separate heap allocation and deallocation.
+ *
+ * Here the nodes live in slabs of 4096 nodes owned by a NodePool, and link to each other with
+ * plain pointers.  Nodes that are removed from the list go onto the pool's free list, and a
+ * removed block is already a chain of nodes, so it is put on the free list in O(1) by linking
+ * its last node to the old free list head - no matter how long the block is.  Destroying the
+ * list just frees the slabs, one by one, with no recursion.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Copy of Node and SinglyLinkedList from remove_duplicates_linked_list_variant.cpp, kept here
+// as the reference for correctness checks and benchmarking.  The only change is the
+// destructor, which unlinks nodes one at a time so that the benchmark can destroy a
+// 10^7-node list without overflowing the stack.
+template <typename T>
+struct Node {
+    std::unique_ptr<Node<T>> next;
+    T data;
+
+    Node(const T& data) : data(data) {}
+};
+
+template <typename T>
+class SinglyLinkedList {
+  public:
+    SinglyLinkedList() {}
+
+    ~SinglyLinkedList() {
+        std::unique_ptr<Node<T>> curr_ptr = std::move(_head);
+        while (curr_ptr != nullptr) {
+            curr_ptr = std::move(curr_ptr->next);
+        }
+    }
+
+    void Append(const T& value) {
+        _tail->next = std::make_unique<Node<T>>(value);
+        _tail = _tail->next.get();
+    }
+
+    Node<T>* FindLastOccurrenceOf(Node<T>* before_start_ptr, std::size_t* el_count) {
+        const T target_value = before_start_ptr->next->data;
+        Node<T>* curr_ptr = before_start_ptr->next.get();
+        *el_count = 1;
+        while ((curr_ptr->next != nullptr) && (curr_ptr->next->data == target_value)) {
+            curr_ptr = curr_ptr->next.get();
+            ++*el_count;
+        }
+        return curr_ptr;
+    }
+
+    void RemoveElementsMoreThanM(std::size_t m) {
+        Node<T>* before_start_ptr = _head.get();
+        while (before_start_ptr->next != nullptr) {
+            std::size_t el_count = 0;
+            Node<T>* end_ptr = FindLastOccurrenceOf(before_start_ptr, &el_count);
+            if (el_count > m) {
+                if (end_ptr == _tail) {
+                    _tail = before_start_ptr;
+                }
+                before_start_ptr->next = std::move(end_ptr->next);
+            } else {
+                before_start_ptr = end_ptr;
+            }
+        }
+    }
+
+    std::string to_string() {
+        std::ostringstream oss;
+        oss << "[";
+        Node<T>* curr_ptr = _head->next.get();
+        while (curr_ptr->next != nullptr) {
+            oss << curr_ptr->data << ", ";
+            curr_ptr = curr_ptr->next.get();
+        }
+        oss << curr_ptr->data << "]";
+        return oss.str();
+    }
+
+  private:
+    std::unique_ptr<Node<T>> _head = std::make_unique<Node<T>>(T{});
+    Node<T>* _tail = _head.get();
+};
+
+template <typename T>
+struct PooledNode {
+    PooledNode<T>* next = nullptr;
+    T data;
+};
+
+// Hands out nodes from slabs of kSlabSize nodes, and takes back whole chains of nodes at once
+template <typename T>
+class NodePool {
+  public:
+    static constexpr std::size_t kSlabSize = 4096;
+
+    NodePool() {}
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    PooledNode<T>* Allocate(const T& value) {
+        PooledNode<T>* node = _free_list;
+        if (node != nullptr) {
+            _free_list = node->next;
+        } else {
+            if (_slab_used == kSlabSize) {
+                _slabs.push_back(std::make_unique_for_overwrite<PooledNode<T>[]>(kSlabSize));
+                _slab_used = 0;
+            }
+            node = &_slabs.back()[_slab_used++];
+        }
+        node->next = nullptr;
+        node->data = value;
+        return node;
+    }
+
+    // Returns the chain first -> ... -> last to the pool in O(1)
+    void FreeChain(PooledNode<T>* first, PooledNode<T>* last) {
+        last->next = _free_list;
+        _free_list = first;
+    }
+
+  private:
+    std::vector<std::unique_ptr<PooledNode<T>[]>> _slabs;
+    std::size_t _slab_used = kSlabSize;  // nodes handed out from _slabs.back()
+    PooledNode<T>* _free_list = nullptr;
+};
+
+template <typename T>
+class PooledSinglyLinkedList {
+  public:
+    PooledSinglyLinkedList() : _head(_pool.Allocate(T{})), _tail(_head) {}
+
+    PooledSinglyLinkedList(const PooledSinglyLinkedList&) = delete;
+    PooledSinglyLinkedList& operator=(const PooledSinglyLinkedList&) = delete;
+
+    void Append(const T& value) {
+        _tail->next = _pool.Allocate(value);
+        _tail = _tail->next;
+    }
+
+    // Helper function to find last occurence of the element in a block,
+    // assuming list is partitioned into groups of equal-valued elements
+    // Requirement: before_start_ptr's next field is not a nullptr
+    PooledNode<T>* FindLastOccurrenceOf(PooledNode<T>* before_start_ptr, std::size_t* el_count) {
+        const T target_value = before_start_ptr->next->data;
+        PooledNode<T>* curr_ptr = before_start_ptr->next;
+        *el_count = 1;
+        while ((curr_ptr->next != nullptr) && (curr_ptr->next->data == target_value)) {
+            curr_ptr = curr_ptr->next;
+            ++*el_count;
+        }
+        return curr_ptr;
+    }
+
+    // Remove all instances of elements occurring more than M times
+    // Assumption: list is *sorted* (or at least partitioned into groups of equal elements)
+    void RemoveElementsMoreThanM(std::size_t m) {
+        PooledNode<T>* before_start_ptr = _head;
+        while (before_start_ptr->next != nullptr) {
+            std::size_t el_count = 0;
+            PooledNode<T>* end_ptr = FindLastOccurrenceOf(before_start_ptr, &el_count);
+            if (el_count > m) {
+                if (end_ptr == _tail) {
+                    _tail = before_start_ptr;
+                }
+                PooledNode<T>* start_ptr = before_start_ptr->next;
+                before_start_ptr->next = end_ptr->next;
+                _pool.FreeChain(start_ptr, end_ptr);
+            } else {
+                before_start_ptr = end_ptr;
+            }
+        }
+    }
+
+    std::string to_string() {
+        std::ostringstream oss;
+        oss << "[";
+        PooledNode<T>* curr_ptr = _head->next;
+        while (curr_ptr->next != nullptr) {
+            oss << curr_ptr->data << ", ";
+            curr_ptr = curr_ptr->next;
+        }
+        oss << curr_ptr->data << "]";
+        return oss.str();
+    }
+
+  private:
+    NodePool<T> _pool;  // declared first, since _head is allocated from it
+    PooledNode<T>* _head;
+    PooledNode<T>* _tail;  // track tail for O(1) append
+};
+
+// Set m = 2, corresponds to removing all blocks of 3 or more elements
+const int kM = 2;
+
+const std::vector<std::vector<int>> kTestCaseVectors{
+        {1, 2, 2, 3, 3, 3},  // simple case
+        {1, 2, 2, 3, 3, 3, 4, 4, 4, 4},  // adjacent removals
+        {1, 2, 2, 3, 3, 3, 4, 4, 4, 4, 5},  // above, but end with non-removed value
+        {1, 2, 2, 3, 3, 3, 4, 4, 4, 4, 5, 6, 7, 7, 7, 8, 8, 8, 9, 10, 10, 10},  // multiple groups
+};
+
+// Sorted values in blocks of 1 to 5 equal elements
+std::vector<int> GenerateBlocks(std::size_t size, std::mt19937& rng) {
+    std::uniform_int_distribution<int> block_size_dist(1, 5);
+    std::vector<int> values;
+    values.reserve(size);
+    int value = 0;
+    while (values.size() < size) {
+        const int block_size = block_size_dist(rng);
+        for (int k = 0; (k < block_size) && (values.size() < size); ++k) {
+            values.push_back(value);
+        }
+        ++value;
+    }
+    return values;
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+// Append, RemoveElementsMoreThanM and destruction times for one list type
+template <typename List>
+void RunBenchmark(const std::string& name, const std::vector<int>& values,
+                  std::string* result_string) {
+    auto list = std::make_unique<List>();
+    const double append_seconds = TimeSeconds([&]() {
+        for (const int value : values) {
+            list->Append(value);
+        }
+    });
+    const double remove_seconds = TimeSeconds([&]() {
+        list->RemoveElementsMoreThanM(kM);
+    });
+    *result_string = list->to_string();
+    const double destroy_seconds = TimeSeconds([&]() {
+        list.reset();
+    });
+    std::cout << "    " << name << ": append " << append_seconds << " s, remove "
+              << remove_seconds << " s, destroy " << destroy_seconds << " s, total "
+              << append_seconds + remove_seconds + destroy_seconds << " s" << std::endl;
+}
+
+int main() {
+    for (const std::vector<int>& test_vector : kTestCaseVectors) {
+        PooledSinglyLinkedList<int> test_ll;
+        for (const int& value : test_vector) {
+            test_ll.Append(value);
+        }
+        std::cout << "Before removal: " << test_ll.to_string() << std::endl;
+        test_ll.RemoveElementsMoreThanM(kM);
+        std::cout << "After removal:  " << test_ll.to_string() << std::endl << std::endl;
+    }
+
+    // Reusing freed nodes must not disturb the list: remove, append more, remove again.
+    // (Each round ends with a single value, since to_string does not handle empty lists.)
+    std::mt19937 rng(12345);
+    for (int trial = 0; trial < 200; ++trial) {
+        const std::vector<int> values = GenerateBlocks(1 + trial, rng);
+        SinglyLinkedList<int> reference_ll;
+        PooledSinglyLinkedList<int> pooled_ll;
+        for (int round = 0; round < 3; ++round) {
+            for (const int value : values) {
+                reference_ll.Append(value + 1000 * round);
+                pooled_ll.Append(value + 1000 * round);
+            }
+            reference_ll.Append(1000 * round + 999);
+            pooled_ll.Append(1000 * round + 999);
+            reference_ll.RemoveElementsMoreThanM(kM);
+            pooled_ll.RemoveElementsMoreThanM(kM);
+            if (reference_ll.to_string() != pooled_ll.to_string()) {
+                std::cout << "MISMATCH: " << reference_ll.to_string() << " vs "
+                          << pooled_ll.to_string() << std::endl;
+                return 1;
+            }
+        }
+    }
+    std::cout << "Random lists: pooled list matches original" << std::endl << std::endl;
+
+    const std::size_t kSize = 10'000'000;
+    const std::vector<int> values = GenerateBlocks(kSize, rng);
+    std::cout << "Benchmark: " << kSize << " nodes, m = " << kM << std::endl;
+    std::string reference_string;
+    std::string pooled_string;
+    RunBenchmark<SinglyLinkedList<int>>("Original", values, &reference_string);
+    RunBenchmark<PooledSinglyLinkedList<int>>("Pooled  ", values, &pooled_string);
+    std::cout << "    " << (reference_string == pooled_string ? "Results match" : "MISMATCH")
+              << std::endl;
+
+    return 0;
+}
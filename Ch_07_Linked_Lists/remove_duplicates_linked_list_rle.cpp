@@ -0,0 +1,361 @@
+/* Run-length-encoded sibling of SinglyLinkedList from remove_duplicates_linked_list_variant.cpp.
+ *
+ * When the list is mostly long blocks of repeated values, storing every element in its own
+ * node wastes both memory and time: RemoveElementsMoreThanM walks every node just to count
+ * each block.  Instead, each node here stores a run (value, count) of equal elements:
+ *   - Append of the same value as the last element just increments the last run's count.
+ *   - Adjacent runs always have different values, so each run is exactly one block of equal
+ *     elements, and RemoveElementsMoreThanM only has to look at each run's count: O(runs).
+ *
+ * Removing a run can leave two runs with the same value next to each other, e.g. removing
+ * the 2s from [1, 1, 2, 2, 2, 1].  The original list counts those as two separate blocks in
+ * that same call (it has already moved past the first one), so we only merge the second run
+ * into the first after deciding whether to keep it - which keeps the runs distinct for the
+ * next call, where the original would see [1, 1, 1] as a single block.
+ *
+ * Iterating the list (and to_string) gives back the expanded elements, in order.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Copy of Node and SinglyLinkedList from remove_duplicates_linked_list_variant.cpp, kept here
+// as the reference for correctness checks and benchmarking.  The only change is the
+// destructor, which unlinks nodes one at a time so that the benchmark can destroy a
+// 10^7-node list without overflowing the stack.
+template <typename T>
+struct Node {
+    std::unique_ptr<Node<T>> next;
+    T data;
+
+    Node(const T& data) : data(data) {}
+};
+
+template <typename T>
+class SinglyLinkedList {
+  public:
+    SinglyLinkedList() {}
+
+    ~SinglyLinkedList() {
+        std::unique_ptr<Node<T>> curr_ptr = std::move(_head);
+        while (curr_ptr != nullptr) {
+            curr_ptr = std::move(curr_ptr->next);
+        }
+    }
+
+    void Append(const T& value) {
+        _tail->next = std::make_unique<Node<T>>(value);
+        _tail = _tail->next.get();
+    }
+
+    Node<T>* FindLastOccurrenceOf(Node<T>* before_start_ptr, std::size_t* el_count) {
+        const T target_value = before_start_ptr->next->data;
+        Node<T>* curr_ptr = before_start_ptr->next.get();
+        *el_count = 1;
+        while ((curr_ptr->next != nullptr) && (curr_ptr->next->data == target_value)) {
+            curr_ptr = curr_ptr->next.get();
+            ++*el_count;
+        }
+        return curr_ptr;
+    }
+
+    void RemoveElementsMoreThanM(std::size_t m) {
+        Node<T>* before_start_ptr = _head.get();
+        while (before_start_ptr->next != nullptr) {
+            std::size_t el_count = 0;
+            Node<T>* end_ptr = FindLastOccurrenceOf(before_start_ptr, &el_count);
+            if (el_count > m) {
+                if (end_ptr == _tail) {
+                    _tail = before_start_ptr;
+                }
+                before_start_ptr->next = std::move(end_ptr->next);
+            } else {
+                before_start_ptr = end_ptr;
+            }
+        }
+    }
+
+    std::string to_string() {
+        std::ostringstream oss;
+        oss << "[";
+        Node<T>* curr_ptr = _head->next.get();
+        while (curr_ptr->next != nullptr) {
+            oss << curr_ptr->data << ", ";
+            curr_ptr = curr_ptr->next.get();
+        }
+        oss << curr_ptr->data << "]";
+        return oss.str();
+    }
+
+  private:
+    std::unique_ptr<Node<T>> _head = std::make_unique<Node<T>>(T{});
+    Node<T>* _tail = _head.get();
+};
+
+template <typename T>
+struct RunNode {
+    std::unique_ptr<RunNode<T>> next;
+    T value;
+    std::size_t count;
+
+    RunNode(const T& value, std::size_t count) : value(value), count(count) {}
+};
+
+template <typename T>
+class RunLengthEncodedList {
+  public:
+    // Forward iterator over the expanded elements
+    class const_iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() {}
+        explicit const_iterator(const RunNode<T>* run) : _run(run) {}
+
+        reference operator*() const {
+            return _run->value;
+        }
+
+        const_iterator& operator++() {
+            if (++_index_in_run == _run->count) {
+                _run = _run->next.get();
+                _index_in_run = 0;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return (_run == other._run) && (_index_in_run == other._index_in_run);
+        }
+
+      private:
+        const RunNode<T>* _run = nullptr;
+        std::size_t _index_in_run = 0;
+    };
+
+    RunLengthEncodedList() {}
+
+    // Unlink runs one at a time, so long lists don't destroy recursively
+    ~RunLengthEncodedList() {
+        std::unique_ptr<RunNode<T>> curr_ptr = std::move(_head);
+        while (curr_ptr != nullptr) {
+            curr_ptr = std::move(curr_ptr->next);
+        }
+    }
+
+    // Appends count copies of value (none for count == 0, which must not create an empty run)
+    void Append(const T& value, std::size_t count = 1) {
+        if (count == 0) {
+            return;
+        }
+        if ((_tail != _head.get()) && (_tail->value == value)) {
+            _tail->count += count;
+        } else {
+            _tail->next = std::make_unique<RunNode<T>>(value, count);
+            _tail = _tail->next.get();
+        }
+    }
+
+    // Remove all instances of elements occurring more than M times
+    // Assumption: list is *sorted* (or at least partitioned into groups of equal elements)
+    void RemoveElementsMoreThanM(std::size_t m) {
+        RunNode<T>* before_run_ptr = _head.get();
+        while (before_run_ptr->next != nullptr) {
+            RunNode<T>* run_ptr = before_run_ptr->next.get();
+            const bool remove_run = run_ptr->count > m;
+            // A kept run next to an equal run (left behind by a removal) is merged into it
+            const bool merge_run = !remove_run && (before_run_ptr != _head.get()) &&
+                                   (before_run_ptr->value == run_ptr->value);
+            if (merge_run) {
+                before_run_ptr->count += run_ptr->count;
+            }
+            if (remove_run || merge_run) {
+                if (run_ptr == _tail) {
+                    _tail = before_run_ptr;
+                }
+                before_run_ptr->next = std::move(run_ptr->next);
+            } else {
+                before_run_ptr = run_ptr;
+            }
+        }
+    }
+
+    const_iterator begin() const {
+        return const_iterator(_head->next.get());
+    }
+
+    const_iterator end() const {
+        return const_iterator();
+    }
+
+    std::size_t num_runs() const {
+        std::size_t num_runs = 0;
+        for (const RunNode<T>* run = _head->next.get(); run != nullptr; run = run->next.get()) {
+            ++num_runs;
+        }
+        return num_runs;
+    }
+
+    std::string to_string() const {
+        std::ostringstream oss;
+        oss << "[";
+        bool first = true;
+        for (const RunNode<T>* run = _head->next.get(); run != nullptr; run = run->next.get()) {
+            for (std::size_t k = 0; k < run->count; ++k) {
+                if (!first) {
+                    oss << ", ";
+                }
+                oss << run->value;
+                first = false;
+            }
+        }
+        oss << "]";
+        return oss.str();
+    }
+
+  private:
+    // Dummy head run, so that every real run has a predecessor
+    std::unique_ptr<RunNode<T>> _head = std::make_unique<RunNode<T>>(T{}, 0);
+    RunNode<T>* _tail = _head.get();  // track tail for O(1) append
+};
+
+// Set m = 2, corresponds to removing all blocks of 3 or more elements
+const int kM = 2;
+
+const std::vector<std::vector<int>> kTestCaseVectors{
+        {1, 2, 2, 3, 3, 3},  // simple case
+        {1, 2, 2, 3, 3, 3, 4, 4, 4, 4},  // adjacent removals
+        {1, 2, 2, 3, 3, 3, 4, 4, 4, 4, 5},  // above, but end with non-removed value
+        {1, 2, 2, 3, 3, 3, 4, 4, 4, 4, 5, 6, 7, 7, 7, 8, 8, 8, 9, 10, 10, 10},  // multiple groups
+        {1, 1, 2, 2, 2, 1},  // not sorted: removal leaves two runs of 1s next to each other
+};
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+int main() {
+    for (const std::vector<int>& test_vector : kTestCaseVectors) {
+        RunLengthEncodedList<int> test_ll;
+        for (const int& value : test_vector) {
+            test_ll.Append(value);
+        }
+        std::cout << "Before removal: " << test_ll.to_string() << std::endl;
+        test_ll.RemoveElementsMoreThanM(kM);
+        std::cout << "After removal:  " << test_ll.to_string() << std::endl << std::endl;
+    }
+
+    // Random partitioned (but not sorted) lists, removing repeatedly with decreasing m, must
+    // match the original list element for element.  Each list ends with a lone value, since
+    // the original to_string does not handle empty lists.  Half of the blocks are appended to
+    // the run-length-encoded list as a single Append(value, count), and Append(value, 0) calls
+    // (which must not change the list) are mixed in.
+    std::mt19937 rng(12345);
+    for (int trial = 0; trial < 500; ++trial) {
+        std::uniform_int_distribution<int> value_dist(0, 3);
+        std::uniform_int_distribution<int> block_size_dist(1, 6);
+        SinglyLinkedList<int> reference_ll;
+        RunLengthEncodedList<int> rle_ll;
+        for (int block = 0; block < trial % 30; ++block) {
+            const int value = value_dist(rng);
+            const int block_size = block_size_dist(rng);
+            for (int k = 0; k < block_size; ++k) {
+                reference_ll.Append(value);
+            }
+            if (rng() % 2 == 0) {
+                rle_ll.Append(value, block_size);
+            } else {
+                for (int k = 0; k < block_size; ++k) {
+                    rle_ll.Append(value);
+                }
+            }
+            if (rng() % 3 == 0) {
+                rle_ll.Append(value_dist(rng), 0);
+            }
+        }
+        reference_ll.Append(-1);
+        rle_ll.Append(-1);
+        for (std::size_t m = 8; m >= 1; --m) {
+            reference_ll.RemoveElementsMoreThanM(m);
+            rle_ll.RemoveElementsMoreThanM(m);
+            std::vector<int> iterated(rle_ll.begin(), rle_ll.end());
+            std::ostringstream iterated_string;
+            iterated_string << "[";
+            for (std::size_t i = 0; i < iterated.size(); ++i) {
+                iterated_string << iterated[i] << (i + 1 < iterated.size() ? ", " : "");
+            }
+            iterated_string << "]";
+            if ((reference_ll.to_string() != rle_ll.to_string()) ||
+                    (iterated_string.str() != rle_ll.to_string())) {
+                std::cout << "MISMATCH: " << reference_ll.to_string() << " vs "
+                          << rle_ll.to_string() << std::endl;
+                return 1;
+            }
+        }
+    }
+    std::cout << "Random lists: run-length-encoded list matches original" << std::endl
+              << std::endl;
+
+    // Sorted blocks of 1 to 1000 equal elements
+    const std::size_t kSize = 10'000'000;
+    std::vector<int> values;
+    values.reserve(kSize);
+    std::uniform_int_distribution<int> block_size_dist(1, 1000);
+    for (int value = 0; values.size() < kSize; ++value) {
+        for (int k = block_size_dist(rng); (k > 0) && (values.size() < kSize); --k) {
+            values.push_back(value);
+        }
+    }
+    const std::size_t kLongM = 500;
+    std::cout << "Benchmark: " << kSize << " elements in blocks of 1-1000, m = " << kLongM
+              << std::endl;
+    auto reference_ll = std::make_unique<SinglyLinkedList<int>>();
+    auto rle_ll = std::make_unique<RunLengthEncodedList<int>>();
+    const double reference_append_seconds = TimeSeconds([&]() {
+        for (const int value : values) {
+            reference_ll->Append(value);
+        }
+    });
+    const double reference_remove_seconds = TimeSeconds([&]() {
+        reference_ll->RemoveElementsMoreThanM(kLongM);
+    });
+    const double rle_append_seconds = TimeSeconds([&]() {
+        for (const int value : values) {
+            rle_ll->Append(value);
+        }
+    });
+    std::cout << "    Runs: " << rle_ll->num_runs() << std::endl;
+    const double rle_remove_seconds = TimeSeconds([&]() {
+        rle_ll->RemoveElementsMoreThanM(kLongM);
+    });
+    std::cout << "    Original: append " << reference_append_seconds << " s, remove "
+              << reference_remove_seconds << " s" << std::endl;
+    std::cout << "    RLE:      append " << rle_append_seconds << " s, remove "
+              << rle_remove_seconds << " s (remove speedup "
+              << reference_remove_seconds / rle_remove_seconds << "x)" << std::endl;
+    std::cout << "    " << (reference_ll->to_string() == rle_ll->to_string() ? "Results match"
+                                                                             : "MISMATCH")
+              << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,369 @@
+/* Unrolled version of SinglyLinkedList from remove_duplicates_linked_list_variant.cpp.
+ *
+ * Each node of the original list holds a single element, so every step of a traversal is a
+ * pointer chase to a new cache line.  In an unrolled list, each node holds a small array of
+ * consecutive elements instead - here, as many as fit in a 128-byte (two cache line) node,
+ * e.g. 29 ints.  Traversals then scan arrays, with one pointer chase per node.
+ *
+ * Removing a block of equal elements [start, end), which may span several nodes:
+ *   - If it lies within one node, the rest of that node's elements shift down over it.
+ *   - Otherwise the start node is cut off at start (split), every node strictly inside the
+ *     block is dropped whole, and the end node's elements before end are removed.
+ * Either way, if the start node is now less than half full and the node after it fits into
+ * it, they are merged, so nodes don't become fragmented into lots of nearly empty ones.
+ * (Merging whenever two nodes fit together would keep nodes fuller, but then nearly every
+ * removal merges, copying a node's worth of elements and freeing a node each time.)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Copy of Node and SinglyLinkedList from remove_duplicates_linked_list_variant.cpp, kept here
+// as the reference for correctness checks and benchmarking.  The only change is the
+// destructor, which unlinks nodes one at a time so that the benchmark can destroy a
+// 10^7-node list without overflowing the stack.
+template <typename T>
+struct Node {
+    std::unique_ptr<Node<T>> next;
+    T data;
+
+    Node(const T& data) : data(data) {}
+};
+
+template <typename T>
+class SinglyLinkedList {
+  public:
+    SinglyLinkedList() {}
+
+    ~SinglyLinkedList() {
+        std::unique_ptr<Node<T>> curr_ptr = std::move(_head);
+        while (curr_ptr != nullptr) {
+            curr_ptr = std::move(curr_ptr->next);
+        }
+    }
+
+    void Append(const T& value) {
+        _tail->next = std::make_unique<Node<T>>(value);
+        _tail = _tail->next.get();
+    }
+
+    Node<T>* FindLastOccurrenceOf(Node<T>* before_start_ptr, std::size_t* el_count) {
+        const T target_value = before_start_ptr->next->data;
+        Node<T>* curr_ptr = before_start_ptr->next.get();
+        *el_count = 1;
+        while ((curr_ptr->next != nullptr) && (curr_ptr->next->data == target_value)) {
+            curr_ptr = curr_ptr->next.get();
+            ++*el_count;
+        }
+        return curr_ptr;
+    }
+
+    void RemoveElementsMoreThanM(std::size_t m) {
+        Node<T>* before_start_ptr = _head.get();
+        while (before_start_ptr->next != nullptr) {
+            std::size_t el_count = 0;
+            Node<T>* end_ptr = FindLastOccurrenceOf(before_start_ptr, &el_count);
+            if (el_count > m) {
+                if (end_ptr == _tail) {
+                    _tail = before_start_ptr;
+                }
+                before_start_ptr->next = std::move(end_ptr->next);
+            } else {
+                before_start_ptr = end_ptr;
+            }
+        }
+    }
+
+    std::string to_string() {
+        std::ostringstream oss;
+        oss << "[";
+        Node<T>* curr_ptr = _head->next.get();
+        while (curr_ptr->next != nullptr) {
+            oss << curr_ptr->data << ", ";
+            curr_ptr = curr_ptr->next.get();
+        }
+        oss << curr_ptr->data << "]";
+        return oss.str();
+    }
+
+  private:
+    std::unique_ptr<Node<T>> _head = std::make_unique<Node<T>>(T{});
+    Node<T>* _tail = _head.get();
+};
+
+constexpr std::size_t kUnrolledNodeBytes = 128;
+
+template <typename T>
+struct alignas(64) UnrolledNode {
+    static constexpr std::size_t kCapacity = std::max<std::size_t>(1,
+            (kUnrolledNodeBytes - sizeof(std::unique_ptr<int>) - sizeof(std::uint32_t)) /
+            sizeof(T));
+
+    std::unique_ptr<UnrolledNode<T>> next;
+    std::uint32_t count = 0;
+    T elements[kCapacity];
+};
+
+template <typename T>
+class UnrolledSinglyLinkedList {
+  public:
+    static constexpr std::size_t kCapacity = UnrolledNode<T>::kCapacity;
+
+    UnrolledSinglyLinkedList() {}
+
+    UnrolledSinglyLinkedList(const UnrolledSinglyLinkedList&) = delete;
+    UnrolledSinglyLinkedList& operator=(const UnrolledSinglyLinkedList&) = delete;
+
+    // Unlink nodes one at a time, so long lists don't destroy recursively
+    ~UnrolledSinglyLinkedList() {
+        std::unique_ptr<UnrolledNode<T>> curr_ptr = std::move(_head);
+        while (curr_ptr != nullptr) {
+            curr_ptr = std::move(curr_ptr->next);
+        }
+    }
+
+    void Append(const T& value) {
+        if (_tail->count == kCapacity) {
+            _tail->next = std::make_unique<UnrolledNode<T>>();
+            _tail = _tail->next.get();
+        }
+        _tail->elements[_tail->count++] = value;
+    }
+
+    // Remove all instances of elements occurring more than M times
+    // Assumption: list is *sorted* (or at least partitioned into groups of equal elements)
+    void RemoveElementsMoreThanM(std::size_t m) {
+        UnrolledNode<T>* node = _head.get();
+        std::uint32_t index = 0;
+        SkipToElement(&node, &index);
+        while (node != nullptr) {
+            // Find the end of the block of elements equal to the one at (node, index)
+            UnrolledNode<T>* const start_node = node;
+            const std::uint32_t start_index = index;
+            const T target_value = node->elements[index];
+            std::size_t el_count = 0;
+            while (node != nullptr) {
+                std::uint32_t i = index;
+                while ((i < node->count) && (node->elements[i] == target_value)) {
+                    ++i;
+                }
+                el_count += i - index;
+                index = i;
+                if (i < node->count) {
+                    break;
+                }
+                node = node->next.get();
+                index = 0;
+            }
+            if (el_count > m) {
+                // The element after the block ends up at (start_node, start_index)
+                RemoveRange(start_node, start_index, node, index);
+                node = start_node;
+                index = start_index;
+                SkipToElement(&node, &index);
+            }
+        }
+    }
+
+    std::string to_string() {
+        std::ostringstream oss;
+        oss << "[";
+        bool first = true;
+        for (UnrolledNode<T>* node = _head.get(); node != nullptr; node = node->next.get()) {
+            for (std::uint32_t i = 0; i < node->count; ++i) {
+                if (!first) {
+                    oss << ", ";
+                }
+                oss << node->elements[i];
+                first = false;
+            }
+        }
+        oss << "]";
+        return oss.str();
+    }
+
+    std::size_t num_nodes() const {
+        std::size_t num_nodes = 0;
+        for (UnrolledNode<T>* node = _head.get(); node != nullptr; node = node->next.get()) {
+            ++num_nodes;
+        }
+        return num_nodes;
+    }
+
+  private:
+    // Moves (node, index) forward past the ends of nodes, until it points at an element
+    // (or node is null at the end of the list)
+    static void SkipToElement(UnrolledNode<T>** node, std::uint32_t* index) {
+        while ((*node != nullptr) && (*index == (*node)->count)) {
+            *node = (*node)->next.get();
+            *index = 0;
+        }
+    }
+
+    static void EraseFromNode(UnrolledNode<T>* node, std::uint32_t begin, std::uint32_t end) {
+        std::move(node->elements + end, node->elements + node->count, node->elements + begin);
+        node->count -= end - begin;
+    }
+
+    // Removes the elements from (start_node, start_index) up to, but not including,
+    // (end_node, end_index), where end_node is null if the range runs to the end of the list
+    void RemoveRange(UnrolledNode<T>* start_node, std::uint32_t start_index,
+                     UnrolledNode<T>* end_node, std::uint32_t end_index) {
+        if (start_node == end_node) {
+            EraseFromNode(start_node, start_index, end_index);
+        } else {
+            start_node->count = start_index;
+            while (start_node->next.get() != end_node) {
+                start_node->next = std::move(start_node->next->next);
+            }
+            if (end_node != nullptr) {
+                EraseFromNode(end_node, 0, end_index);
+            } else {
+                _tail = start_node;
+            }
+        }
+        MergeWithNext(start_node);
+    }
+
+    void MergeWithNext(UnrolledNode<T>* node) {
+        UnrolledNode<T>* next = node->next.get();
+        if ((next != nullptr) && (2 * node->count < kCapacity) &&
+                (node->count + next->count <= kCapacity)) {
+            std::move(next->elements, next->elements + next->count,
+                      node->elements + node->count);
+            node->count += next->count;
+            if (next == _tail) {
+                _tail = node;
+            }
+            node->next = std::move(next->next);
+        }
+    }
+
+    // Unlike the original, the first node holds real elements (the list is empty if the
+    // first node is), so no dummy head node is needed
+    std::unique_ptr<UnrolledNode<T>> _head = std::make_unique<UnrolledNode<T>>();
+    UnrolledNode<T>* _tail = _head.get();  // track tail for O(1) append
+};
+
+// Set m = 2, corresponds to removing all blocks of 3 or more elements
+const int kM = 2;
+
+const std::vector<std::vector<int>> kTestCaseVectors{
+        {1, 2, 2, 3, 3, 3},  // simple case
+        {1, 2, 2, 3, 3, 3, 4, 4, 4, 4},  // adjacent removals
+        {1, 2, 2, 3, 3, 3, 4, 4, 4, 4, 5},  // above, but end with non-removed value
+        {1, 2, 2, 3, 3, 3, 4, 4, 4, 4, 5, 6, 7, 7, 7, 8, 8, 8, 9, 10, 10, 10},  // multiple groups
+};
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+int main() {
+    for (const std::vector<int>& test_vector : kTestCaseVectors) {
+        UnrolledSinglyLinkedList<int> test_ll;
+        for (const int& value : test_vector) {
+            test_ll.Append(value);
+        }
+        std::cout << "Before removal: " << test_ll.to_string() << std::endl;
+        test_ll.RemoveElementsMoreThanM(kM);
+        std::cout << "After removal:  " << test_ll.to_string() << std::endl << std::endl;
+    }
+
+    // Random partitioned lists with blocks both shorter and longer than a node, removing
+    // repeatedly with decreasing m and appending in between, must match the original.
+    // Each round ends with a lone value, since the original to_string does not handle
+    // empty lists.
+    std::mt19937 rng(12345);
+    for (int trial = 0; trial < 500; ++trial) {
+        std::uniform_int_distribution<int> value_dist(0, 3);
+        std::uniform_int_distribution<int> block_size_dist(1, (trial % 2 == 0) ? 6 : 100);
+        SinglyLinkedList<int> reference_ll;
+        UnrolledSinglyLinkedList<int> unrolled_ll;
+        for (int round = 0; round < 4; ++round) {
+            for (int block = 0; block < trial % 20; ++block) {
+                const int value = value_dist(rng);
+                for (int k = block_size_dist(rng); k > 0; --k) {
+                    reference_ll.Append(value);
+                    unrolled_ll.Append(value);
+                }
+            }
+            reference_ll.Append(-1 - round);
+            unrolled_ll.Append(-1 - round);
+            reference_ll.RemoveElementsMoreThanM(40 - 10 * round);
+            unrolled_ll.RemoveElementsMoreThanM(40 - 10 * round);
+            if (reference_ll.to_string() != unrolled_ll.to_string()) {
+                std::cout << "MISMATCH: " << reference_ll.to_string() << " vs "
+                          << unrolled_ll.to_string() << std::endl;
+                return 1;
+            }
+        }
+    }
+    std::cout << "Random lists: unrolled list matches original" << std::endl << std::endl;
+
+    // Sorted blocks of 1 to 5 equal elements
+    const std::size_t kSize = 10'000'000;
+    std::vector<int> values;
+    values.reserve(kSize);
+    std::uniform_int_distribution<int> block_size_dist(1, 5);
+    for (int value = 0; values.size() < kSize; ++value) {
+        for (int k = block_size_dist(rng); (k > 0) && (values.size() < kSize); --k) {
+            values.push_back(value);
+        }
+    }
+    std::cout << "Benchmark: " << kSize << " elements in blocks of 1-5, "
+              << UnrolledSinglyLinkedList<int>::kCapacity << " ints per unrolled node"
+              << std::endl;
+    // With m larger than any block, RemoveElementsMoreThanM is a pure scan of the list
+    const std::size_t kNoRemoval = std::numeric_limits<std::size_t>::max();
+    SinglyLinkedList<int> reference_ll;
+    UnrolledSinglyLinkedList<int> unrolled_ll;
+    const double reference_append_seconds = TimeSeconds([&]() {
+        for (const int value : values) {
+            reference_ll.Append(value);
+        }
+    });
+    const double unrolled_append_seconds = TimeSeconds([&]() {
+        for (const int value : values) {
+            unrolled_ll.Append(value);
+        }
+    });
+    const double reference_scan_seconds = TimeSeconds([&]() {
+        reference_ll.RemoveElementsMoreThanM(kNoRemoval);
+    });
+    const double unrolled_scan_seconds = TimeSeconds([&]() {
+        unrolled_ll.RemoveElementsMoreThanM(kNoRemoval);
+    });
+    const double reference_remove_seconds = TimeSeconds([&]() {
+        reference_ll.RemoveElementsMoreThanM(kM);
+    });
+    const double unrolled_remove_seconds = TimeSeconds([&]() {
+        unrolled_ll.RemoveElementsMoreThanM(kM);
+    });
+    std::cout << "    Original: append " << reference_append_seconds << " s, scan "
+              << reference_scan_seconds << " s (" << kSize / reference_scan_seconds / 1e6
+              << " M elements/s), remove " << reference_remove_seconds << " s" << std::endl;
+    std::cout << "    Unrolled: append " << unrolled_append_seconds << " s, scan "
+              << unrolled_scan_seconds << " s (" << kSize / unrolled_scan_seconds / 1e6
+              << " M elements/s), remove " << unrolled_remove_seconds << " s" << std::endl;
+    std::cout << "    Scan speedup " << reference_scan_seconds / unrolled_scan_seconds
+              << "x, remove speedup " << reference_remove_seconds / unrolled_remove_seconds
+              << "x, " << unrolled_ll.num_nodes() << " unrolled nodes left" << std::endl;
+    std::cout << "    " << (reference_ll.to_string() == unrolled_ll.to_string() ? "Results match"
+                                                                             : "MISMATCH")
+              << std::endl;
+
+    return 0;
+}
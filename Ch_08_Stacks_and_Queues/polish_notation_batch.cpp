@@ -0,0 +1,470 @@
+/* Batched (columnar) evaluation of one polish notation expression over many rows.
+ *
+ * Builds on the compiled evaluator in polish_notation_compiled.cpp, adding variable tokens:
+ * an expression like {"+", "*", "x", "3", "y"} is compiled once against a list of variable
+ * names, and then evaluated over columns of input values, one column per variable.
+ *
+ * Instead of running the whole program once per row, we run each instruction over a block
+ * of rows at a time.  The stack holds one block-sized array per stack slot, so every operator
+ * becomes a simple loop over contiguous ints with no branches, which the compiler can
+ * auto-vectorize.  Arithmetic is done in 64 bits and range-checked, so overflow and division
+ * by zero are recorded in a per-row status instead of aborting the whole batch.  A row that
+ * hits an error keeps its error flags through the rest of the expression.
+ */
+
+#include <cctype>
+#include <cstdint>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+bool IsNumeric(const std::string& s) {
+    for (const char c : s) {
+        if (!std::isdigit(c)) return false;
+    }
+    return true;
+}
+
+bool IsVariableName(const std::string& s) {
+    if (s.empty() || !(std::isalpha(s[0]) || (s[0] == '_'))) return false;
+    for (const char c : s) {
+        if (!(std::isalnum(c) || (c == '_'))) return false;
+    }
+    return true;
+}
+
+enum class OpCode : unsigned char {
+    kPushLiteral, kPushVariable, kAdd, kSubtract, kMultiply, kDivide };
+
+struct Instruction {
+    OpCode op_code;
+    int operand;  // literal value for kPushLiteral, column index for kPushVariable
+};
+
+struct CompiledExpression {
+    std::vector<Instruction> program;
+    size_t max_stack_depth = 0;
+    size_t num_variables = 0;
+};
+
+// Per-row status flags, OR-ed together as errors occur
+enum RowStatus : uint8_t {
+    kRowOk = 0,
+    kRowDivisionByZero = 1 << 0,
+    kRowOverflow = 1 << 1,
+};
+
+// Compile an expression whose variable tokens must appear in variable_names; the index of
+// a variable in variable_names is the index of the column it reads during evaluation.
+// Throws std::invalid_argument on unknown tokens or malformed expressions.
+CompiledExpression CompilePolishNotation(
+        const std::vector<std::string>& input_expression,
+        const std::vector<std::string>& variable_names) {
+    CompiledExpression compiled;
+    compiled.num_variables = variable_names.size();
+    compiled.program.reserve(input_expression.size());
+    size_t stack_depth = 0;
+    // Read backwards, so binary operators find their left operand on top of the stack
+    for (auto it = input_expression.rbegin(); it != input_expression.rend(); ++it) {
+        const std::string& token = *it;
+        Instruction instruction{OpCode::kPushLiteral, 0};
+        if (token == "+") {
+            instruction.op_code = OpCode::kAdd;
+        } else if (token == "-") {
+            instruction.op_code = OpCode::kSubtract;
+        } else if (token == "*") {
+            instruction.op_code = OpCode::kMultiply;
+        } else if (token == "/") {
+            instruction.op_code = OpCode::kDivide;
+        } else if (!token.empty() && IsNumeric(token)) {
+            instruction.operand = std::stoi(token);
+        } else if (IsVariableName(token)) {
+            const auto name_it = std::find(variable_names.begin(), variable_names.end(), token);
+            if (name_it == variable_names.end()) {
+                throw std::invalid_argument("Unbound variable in expression: " + token);
+            }
+            instruction.op_code = OpCode::kPushVariable;
+            instruction.operand = static_cast<int>(name_it - variable_names.begin());
+        } else {
+            throw std::invalid_argument("Unknown token in expression: " + token);
+        }
+        const bool is_push = (instruction.op_code == OpCode::kPushLiteral) ||
+                             (instruction.op_code == OpCode::kPushVariable);
+        if (is_push) {
+            ++stack_depth;
+            compiled.max_stack_depth = std::max(compiled.max_stack_depth, stack_depth);
+        } else {
+            if (stack_depth < 2) {
+                throw std::invalid_argument("Operator is missing operands: " + token);
+            }
+            --stack_depth;
+        }
+        compiled.program.push_back(instruction);
+    }
+    if (stack_depth != 1) {
+        throw std::invalid_argument("Expression does not reduce to a single value");
+    }
+    return compiled;
+}
+
+// Rows processed per instruction; small enough that the whole block stack stays in L1/L2
+constexpr size_t kBlockSize = 256;
+
+// Apply a checked add/subtract/multiply over one block.  The operation is computed in
+// 64 bits, where it cannot overflow, and then range-checked against int.
+template <typename WideOp>
+void ApplyCheckedArithmeticBlock(WideOp wide_op, const int* left, const int* right, int* result,
+                                 uint8_t* status, size_t num_rows) {
+    constexpr int64_t kIntMin = std::numeric_limits<int>::min();
+    constexpr int64_t kIntMax = std::numeric_limits<int>::max();
+    for (size_t i = 0; i < num_rows; ++i) {
+        const int64_t wide_result = wide_op(static_cast<int64_t>(left[i]),
+                                            static_cast<int64_t>(right[i]));
+        const bool overflow = (wide_result < kIntMin) | (wide_result > kIntMax);
+        status[i] |= overflow ? kRowOverflow : kRowOk;
+        result[i] = static_cast<int>(wide_result);  // wraps on overflow, but row is flagged
+    }
+}
+
+// Apply a binary operator over one block.  result may alias right (the evaluator writes the
+// result into the lower of the two popped stack slots).  Each loop is straight-line code
+// with no data-dependent branches, so the compiler can vectorize it.
+void ApplyOperatorBlock(OpCode op_code, const int* left, const int* right, int* result,
+                        uint8_t* status, size_t num_rows) {
+    switch (op_code) {
+        case OpCode::kAdd:
+            ApplyCheckedArithmeticBlock(std::plus<int64_t>(), left, right, result, status,
+                                        num_rows);
+            break;
+        case OpCode::kSubtract:
+            ApplyCheckedArithmeticBlock(std::minus<int64_t>(), left, right, result, status,
+                                        num_rows);
+            break;
+        case OpCode::kMultiply:
+            ApplyCheckedArithmeticBlock(std::multiplies<int64_t>(), left, right, result, status,
+                                        num_rows);
+            break;
+        case OpCode::kDivide:
+            // Division has no SIMD instruction, but keeping it branch-free still avoids
+            // mispredictions; bad divisors are replaced by 1 and the row is flagged
+            for (size_t i = 0; i < num_rows; ++i) {
+                const int a = left[i];
+                const int b = right[i];
+                const bool divide_by_zero = (b == 0);
+                const bool overflow = (a == std::numeric_limits<int>::min()) & (b == -1);
+                status[i] |= (divide_by_zero ? kRowDivisionByZero : kRowOk) |
+                             (overflow ? kRowOverflow : kRowOk);
+                const int safe_b = (divide_by_zero | overflow) ? 1 : b;
+                result[i] = a / safe_b;
+            }
+            break;
+        case OpCode::kPushLiteral:
+        case OpCode::kPushVariable:
+            break;  // not operators
+    }
+}
+
+// Evaluate a compiled expression over num_rows rows.  columns[v] points to the values of
+// variable v for every row.  results and row_status are resized to num_rows; rows whose
+// status is not kRowOk have an unspecified result.
+void EvaluateBatch(const CompiledExpression& compiled,
+                   const std::vector<const int*>& columns,
+                   size_t num_rows,
+                   std::vector<int>& results,
+                   std::vector<uint8_t>& row_status) {
+    if (columns.size() != compiled.num_variables) {
+        throw std::invalid_argument("Number of columns does not match number of variables");
+    }
+    results.resize(num_rows);
+    row_status.assign(num_rows, kRowOk);
+    // One kBlockSize slot per stack entry, allocated once per batch
+    std::vector<int> block_stack(compiled.max_stack_depth * kBlockSize);
+    for (size_t block_start = 0; block_start < num_rows; block_start += kBlockSize) {
+        const size_t block_rows = std::min(kBlockSize, num_rows - block_start);
+        uint8_t* block_status = row_status.data() + block_start;
+        int* stack_top = block_stack.data();  // points one slot past the top slot
+        for (const Instruction& instruction : compiled.program) {
+            if (instruction.op_code == OpCode::kPushLiteral) {
+                std::fill(stack_top, stack_top + block_rows, instruction.operand);
+                stack_top += kBlockSize;
+            } else if (instruction.op_code == OpCode::kPushVariable) {
+                const int* column = columns[instruction.operand] + block_start;
+                std::copy(column, column + block_rows, stack_top);
+                stack_top += kBlockSize;
+            } else {
+                int* left = stack_top - kBlockSize;
+                int* right = stack_top - 2 * kBlockSize;
+                ApplyOperatorBlock(instruction.op_code, left, right, right, block_status,
+                                   block_rows);
+                stack_top -= kBlockSize;
+            }
+        }
+        std::copy(block_stack.data(), block_stack.data() + block_rows,
+                  results.data() + block_start);
+    }
+}
+
+// Scalar row-at-a-time evaluation with the same error semantics (including the flags and
+// results after an error), for benchmarking.  Its arithmetic is written out here rather than
+// calling ApplyOperatorBlock, so the two are checked against each other.
+int EvaluateRow(const CompiledExpression& compiled, const std::vector<const int*>& columns,
+                size_t row, std::vector<int>& stack_buffer, uint8_t* status) {
+    stack_buffer.resize(compiled.max_stack_depth);
+    int* stack_top = stack_buffer.data();
+    *status = kRowOk;
+    for (const Instruction& instruction : compiled.program) {
+        if (instruction.op_code == OpCode::kPushLiteral) {
+            *stack_top++ = instruction.operand;
+        } else if (instruction.op_code == OpCode::kPushVariable) {
+            *stack_top++ = columns[instruction.operand][row];
+        } else {
+            const int64_t left_operand = stack_top[-1];
+            const int64_t right_operand = stack_top[-2];
+            int64_t wide_result = 0;
+            switch (instruction.op_code) {
+                case OpCode::kAdd: wide_result = left_operand + right_operand; break;
+                case OpCode::kSubtract: wide_result = left_operand - right_operand; break;
+                case OpCode::kMultiply: wide_result = left_operand * right_operand; break;
+                case OpCode::kDivide:
+                    if (right_operand == 0) {
+                        *status |= kRowDivisionByZero;
+                        wide_result = left_operand;  // divide by 1 instead, as the batch does
+                    } else {
+                        wide_result = left_operand / right_operand;
+                    }
+                    break;
+                case OpCode::kPushLiteral:
+                case OpCode::kPushVariable:
+                    break;  // not operators
+            }
+            if ((wide_result < std::numeric_limits<int>::min()) ||
+                    (wide_result > std::numeric_limits<int>::max())) {
+                *status |= kRowOverflow;
+            }
+            stack_top[-2] = static_cast<int>(wide_result);
+            --stack_top;
+        }
+    }
+    return stack_buffer[0];
+}
+
+bool IsInteger(const std::string& s) {
+    const size_t digits_start = (!s.empty() && (s[0] == '-')) ? 1 : 0;
+    return (s.size() > digits_start) && IsNumeric(s.substr(digits_start));
+}
+
+// Copy of EvaluatePolishNotation from polish_notation.cpp, minus the debug print, kept here as
+// the reference for correctness checks.  Variables are first replaced by their values in the
+// given row.  The original only reduces nonnegative numbers and doesn't check its arithmetic,
+// so this copy also accepts negative numbers, and computes in 64 bits.  Returns the status of
+// the first error (the batch may flag more than one), or kRowOk and the result in *result.
+uint8_t EvaluatePolishNotation(const std::vector<std::string>& input_expression,
+                               const std::vector<std::string>& variable_names,
+                               const std::vector<const int*>& columns, size_t row,
+                               int* result) {
+    static const std::unordered_map<std::string, std::function<int64_t(int64_t, int64_t)>>
+            kOpFunctions{
+                    {"+", std::plus<int64_t>()},
+                    {"-", std::minus<int64_t>()},
+                    {"*", std::multiplies<int64_t>()},
+                    {"/", std::divides<int64_t>()}};
+    std::vector<std::string> stack;
+    for (const std::string& token : input_expression) {
+        const auto name_it = std::find(variable_names.begin(), variable_names.end(), token);
+        stack.push_back((name_it == variable_names.end())
+                                ? token
+                                : std::to_string(columns[name_it - variable_names.begin()][row]));
+        while ((stack.size() >= 3) && IsInteger(stack.back()) &&
+                IsInteger(stack[stack.size() - 2])) {
+            const int64_t right_operand = std::stoll(stack.back());
+            stack.pop_back();
+            const int64_t left_operand = std::stoll(stack.back());
+            stack.pop_back();
+            if ((stack.back() == "/") && (right_operand == 0)) {
+                return kRowDivisionByZero;
+            }
+            const int64_t value = kOpFunctions.at(stack.back())(left_operand, right_operand);
+            stack.pop_back();
+            if ((value < std::numeric_limits<int>::min()) ||
+                    (value > std::numeric_limits<int>::max())) {
+                return kRowOverflow;
+            }
+            stack.push_back(std::to_string(value));
+        }
+    }
+    *result = std::stoi(stack.back());
+    return kRowOk;
+}
+
+// Random prefix expression over the given variables, small literals and all four operators
+void GenerateRandomExpression(int depth, const std::vector<std::string>& variable_names,
+                              std::mt19937& rng, std::vector<std::string>& tokens) {
+    static const std::vector<std::string> kOperators{"+", "-", "*", "/"};
+    static const std::vector<std::string> kLiterals{"0", "1", "2", "7", "65536", "2147483647"};
+    if ((depth == 0) || (rng() % 4 == 0)) {
+        if (rng() % 3 == 0) {
+            tokens.push_back(kLiterals[rng() % kLiterals.size()]);
+        } else {
+            tokens.push_back(variable_names[rng() % variable_names.size()]);
+        }
+        return;
+    }
+    tokens.push_back(kOperators[rng() % kOperators.size()]);
+    GenerateRandomExpression(depth - 1, variable_names, rng, tokens);
+    GenerateRandomExpression(depth - 1, variable_names, rng, tokens);
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+std::string StatusToString(uint8_t status) {
+    if (status == kRowOk) return "ok";
+    std::string result;
+    if (status & kRowDivisionByZero) result += "division by zero ";
+    if (status & kRowOverflow) result += "overflow ";
+    result.pop_back();
+    return result;
+}
+
+int main() {
+    // (x - 1) * 5 + (y / z)
+    const std::vector<std::string> expression{"+", "*", "-", "x", "1", "5", "/", "y", "z"};
+    const std::vector<std::string> variable_names{"x", "y", "z"};
+    const CompiledExpression compiled = CompilePolishNotation(expression, variable_names);
+
+    const std::vector<int> x_column{3, 10, 7, 2147483647, -4};
+    const std::vector<int> y_column{110, 9, 1, 0, 8};
+    const std::vector<int> z_column{1, 3, 0, 1, -2};
+    std::vector<int> results;
+    std::vector<uint8_t> row_status;
+    EvaluateBatch(compiled, {x_column.data(), y_column.data(), z_column.data()},
+                  x_column.size(), results, row_status);
+    for (size_t row = 0; row < results.size(); ++row) {
+        std::cout << "x = " << x_column[row] << ", y = " << y_column[row]
+                  << ", z = " << z_column[row] << " -> ";
+        if (row_status[row] == kRowOk) {
+            std::cout << results[row] << std::endl;
+        } else {
+            std::cout << "error (" << StatusToString(row_status[row]) << ")" << std::endl;
+        }
+    }
+    std::cout << std::endl;
+
+    // Random expressions over columns mixing small values with edge cases, against the copy of
+    // the original evaluator: a row must have an error in the batch (and row-at-a-time)
+    // evaluation exactly when the reference finds one, the reference's error must be among
+    // its flags, and rows without errors must have the same result
+    std::mt19937 rng(12345);
+    const std::vector<int> kEdgeValues{0, 1, -1, 2, -2, 46341, -46341, 65536,
+                                       std::numeric_limits<int>::max(),
+                                       std::numeric_limits<int>::min()};
+    const size_t kNumCheckRows = 1000;  // not a multiple of the block size
+    std::vector<std::vector<int>> check_columns(variable_names.size(),
+                                                std::vector<int>(kNumCheckRows));
+    std::vector<const int*> check_column_ptrs;
+    for (std::vector<int>& column : check_columns) {
+        for (int& value : column) {
+            value = (rng() % 2 == 0) ? kEdgeValues[rng() % kEdgeValues.size()]
+                                     : static_cast<int>(rng() % 201) - 100;
+        }
+        check_column_ptrs.push_back(column.data());
+    }
+    size_t num_check_errors = 0;
+    std::vector<int> check_stack_buffer;
+    for (int trial = 0; trial < 300; ++trial) {
+        std::vector<std::string> tokens;
+        GenerateRandomExpression(1 + trial % 6, variable_names, rng, tokens);
+        const CompiledExpression check_compiled = CompilePolishNotation(tokens, variable_names);
+        EvaluateBatch(check_compiled, check_column_ptrs, kNumCheckRows, results, row_status);
+        for (size_t row = 0; row < kNumCheckRows; ++row) {
+            int expected = 0;
+            const uint8_t expected_status = EvaluatePolishNotation(
+                    tokens, variable_names, check_column_ptrs, row, &expected);
+            uint8_t scalar_status = kRowOk;
+            const int scalar_result = EvaluateRow(check_compiled, check_column_ptrs, row,
+                                                  check_stack_buffer, &scalar_status);
+            const bool matches = (row_status[row] == scalar_status) &&
+                    ((expected_status == kRowOk)
+                             ? ((row_status[row] == kRowOk) && (results[row] == expected) &&
+                                (scalar_result == expected))
+                             : ((row_status[row] & expected_status) != 0));
+            if (!matches) {
+                std::cout << "MISMATCH on row " << row << " of expression";
+                for (const std::string& token : tokens) {
+                    std::cout << " " << token;
+                }
+                std::cout << std::endl;
+                return 1;
+            }
+            num_check_errors += (expected_status != kRowOk);
+        }
+    }
+    std::cout << "Random expressions: 300 x " << kNumCheckRows << " rows (" << num_check_errors
+              << " with errors) match the reference evaluator" << std::endl << std::endl;
+
+    // Benchmark: row-at-a-time vs. batched, with random inputs that include some errors
+    const size_t kNumRows = 10'000'000;
+    std::uniform_int_distribution<int> value_dist(-100000, 100000);
+    std::vector<std::vector<int>> bench_columns(variable_names.size(), std::vector<int>(kNumRows));
+    for (std::vector<int>& column : bench_columns) {
+        for (int& value : column) {
+            value = value_dist(rng);
+        }
+    }
+    bench_columns[2][17] = 0;  // force at least one division by zero
+    std::vector<const int*> bench_column_ptrs;
+    for (const std::vector<int>& column : bench_columns) {
+        bench_column_ptrs.push_back(column.data());
+    }
+
+    std::vector<int> row_results(kNumRows);
+    std::vector<uint8_t> row_statuses(kNumRows);
+    const double row_seconds = TimeSeconds([&]() {
+        std::vector<int> stack_buffer;
+        for (size_t row = 0; row < kNumRows; ++row) {
+            row_results[row] = EvaluateRow(compiled, bench_column_ptrs, row, stack_buffer,
+                                           &row_statuses[row]);
+        }
+    });
+    const double batch_seconds = TimeSeconds([&]() {
+        EvaluateBatch(compiled, bench_column_ptrs, kNumRows, results, row_status);
+    });
+
+    size_t mismatches = 0;
+    size_t error_rows = 0;
+    for (size_t row = 0; row < kNumRows; ++row) {
+        if (row_status[row] != row_statuses[row]) {
+            ++mismatches;
+        } else if (row_status[row] == kRowOk) {
+            mismatches += (results[row] != row_results[row]);
+        } else {
+            ++error_rows;
+        }
+    }
+    std::cout << "Benchmark: " << kNumRows << " rows" << std::endl;
+    std::cout << "    Row-at-a-time: " << row_seconds << " s ("
+              << kNumRows / row_seconds / 1e6 << " M rows/s)" << std::endl;
+    std::cout << "    Batched:       " << batch_seconds << " s ("
+              << kNumRows / batch_seconds / 1e6 << " M rows/s)" << std::endl;
+    std::cout << "    Speedup: " << row_seconds / batch_seconds << "x" << std::endl;
+    std::cout << "    Rows with errors: " << error_rows << ", mismatches: " << mismatches
+              << std::endl;
+    if (mismatches != 0) {
+        return 1;
+    }
+
+    return 0;
+}
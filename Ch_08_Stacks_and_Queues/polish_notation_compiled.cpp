@@ -0,0 +1,239 @@
+/* Compiled version of EvaluatePolishNotation (see polish_notation.cpp).
+ *
+ * The string-stack evaluator re-parses every intermediate result: it checks IsNumeric on
+ * the top two stack entries after every push, std::stoi's both operands, and std::to_string's
+ * the result back onto the stack.  When the same expression is evaluated many times, all of
+ * that work can be done once up front.
+ *
+ * Approach: a prefix expression read right-to-left is just a postfix expression whose binary
+ * operators take their *left* operand from the top of the stack.  So we compile the tokens in
+ * reverse order into a flat program of (opcode, literal) instructions, and evaluate it with
+ * an integer stack.  While compiling we also compute the maximum stack depth, so the
+ * evaluator can size its stack once and never allocate during evaluation.
+ */
+
+#include <cctype>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+bool IsNumeric(const std::string& s) {
+    for (const char c : s) {
+        if (!std::isdigit(c)) return false;
+    }
+    return true;
+}
+
+// Copy of EvaluatePolishNotation from polish_notation.cpp, minus the debug print,
+// kept here as the reference implementation for correctness checks and benchmarking
+int EvaluatePolishNotation(const std::vector<std::string>& input_expression) {
+    static const std::unordered_map<std::string, std::function<int(int, int)>> kOpFunctions{
+            {"+", std::plus<int>()},
+            {"-", std::minus<int>()},
+            {"*", std::multiplies<int>()},
+            {"/", std::divides<int>()}};
+    std::vector<std::string> stack;
+    for (const std::string& current_element : input_expression) {
+        stack.push_back(current_element);
+        while ((stack.size() >= 3) && IsNumeric(stack.back()) && IsNumeric(stack[stack.size() - 2])) {
+            int right_operand = std::stoi(stack.back());
+            stack.pop_back();
+            int left_operand = std::stoi(stack.back());
+            stack.pop_back();
+            const auto& op_func = kOpFunctions.at(stack.back());
+            stack.pop_back();
+            stack.push_back(std::to_string(op_func(left_operand, right_operand)));
+        }
+    }
+    return std::stoi(stack.back());
+}
+
+enum class OpCode : unsigned char { kPushLiteral, kAdd, kSubtract, kMultiply, kDivide };
+
+struct Instruction {
+    OpCode op_code;
+    int literal;  // only meaningful for kPushLiteral
+};
+
+struct CompiledExpression {
+    std::vector<Instruction> program;
+    size_t max_stack_depth = 0;
+};
+
+// Compile a polish notation expression into a flat program, throwing std::invalid_argument
+// if it contains an unknown token or is not well-formed (unlike the string evaluator,
+// compilation happens once, so we can afford to validate the input here)
+CompiledExpression CompilePolishNotation(const std::vector<std::string>& input_expression) {
+    CompiledExpression compiled;
+    compiled.program.reserve(input_expression.size());
+    size_t stack_depth = 0;
+    for (auto it = input_expression.rbegin(); it != input_expression.rend(); ++it) {
+        const std::string& token = *it;
+        Instruction instruction{OpCode::kPushLiteral, 0};
+        if (token == "+") {
+            instruction.op_code = OpCode::kAdd;
+        } else if (token == "-") {
+            instruction.op_code = OpCode::kSubtract;
+        } else if (token == "*") {
+            instruction.op_code = OpCode::kMultiply;
+        } else if (token == "/") {
+            instruction.op_code = OpCode::kDivide;
+        } else if (!token.empty() && IsNumeric(token)) {
+            instruction.literal = std::stoi(token);
+        } else {
+            throw std::invalid_argument("Unknown token in expression: " + token);
+        }
+        if (instruction.op_code == OpCode::kPushLiteral) {
+            ++stack_depth;
+            compiled.max_stack_depth = std::max(compiled.max_stack_depth, stack_depth);
+        } else {
+            // Binary operator: pops two operands, pushes one result
+            if (stack_depth < 2) {
+                throw std::invalid_argument("Operator is missing operands: " + token);
+            }
+            --stack_depth;
+        }
+        compiled.program.push_back(instruction);
+    }
+    if (stack_depth != 1) {
+        throw std::invalid_argument("Expression does not reduce to a single value");
+    }
+    return compiled;
+}
+
+// Evaluate a compiled expression using the given stack buffer, which is grown to the
+// required depth on first use - reuse the same buffer across calls to avoid allocation
+int EvaluateCompiled(const CompiledExpression& compiled, std::vector<int>& stack_buffer) {
+    if (stack_buffer.size() < compiled.max_stack_depth) {
+        stack_buffer.resize(compiled.max_stack_depth);
+    }
+    int* stack_top = stack_buffer.data();  // points one past the top element
+    for (const Instruction& instruction : compiled.program) {
+        if (instruction.op_code == OpCode::kPushLiteral) {
+            *stack_top++ = instruction.literal;
+            continue;
+        }
+        // Left operand is on top, since we are reading the prefix expression backwards
+        const int left_operand = stack_top[-1];
+        const int right_operand = stack_top[-2];
+        --stack_top;
+        int& result = stack_top[-1];
+        switch (instruction.op_code) {
+            case OpCode::kAdd: result = left_operand + right_operand; break;
+            case OpCode::kSubtract: result = left_operand - right_operand; break;
+            case OpCode::kMultiply: result = left_operand * right_operand; break;
+            case OpCode::kDivide: result = left_operand / right_operand; break;
+            case OpCode::kPushLiteral: break;  // handled above
+        }
+    }
+    return stack_buffer[0];
+}
+
+int EvaluateCompiled(const CompiledExpression& compiled) {
+    std::vector<int> stack_buffer;
+    return EvaluateCompiled(compiled, stack_buffer);
+}
+
+// Generate a random expression tree of the given depth, appending its prefix tokens and
+// returning its value.  Right operands of * and / are nonzero single digits, so there is no
+// division by zero and values stay small enough not to overflow.  Subtraction operands are
+// ordered so that no intermediate result is negative, since IsNumeric does not accept a
+// leading minus sign and the string evaluator would otherwise never reduce that subtree.
+int GenerateRandomExpression(int depth, std::mt19937& rng, std::vector<std::string>& tokens) {
+    std::uniform_int_distribution<int> digit_dist(1, 9);
+    if (depth == 0) {
+        const int digit = digit_dist(rng);
+        tokens.push_back(std::to_string(digit));
+        return digit;
+    }
+    static const std::vector<std::string> kOperators{"+", "-", "*", "/"};
+    const std::string& op = kOperators[std::uniform_int_distribution<int>(0, 3)(rng)];
+    std::vector<std::string> left_tokens;
+    std::vector<std::string> right_tokens;
+    int left_value = GenerateRandomExpression(depth - 1, rng, left_tokens);
+    int right_value = 0;
+    if ((op == "*") || (op == "/")) {
+        right_value = digit_dist(rng);
+        right_tokens.push_back(std::to_string(right_value));
+    } else {
+        right_value = GenerateRandomExpression(depth - 1, rng, right_tokens);
+        if ((op == "-") && (left_value < right_value)) {
+            std::swap(left_tokens, right_tokens);
+            std::swap(left_value, right_value);
+        }
+    }
+    tokens.push_back(op);
+    tokens.insert(tokens.end(), left_tokens.begin(), left_tokens.end());
+    tokens.insert(tokens.end(), right_tokens.begin(), right_tokens.end());
+    if (op == "+") return left_value + right_value;
+    if (op == "-") return left_value - right_value;
+    if (op == "*") return left_value * right_value;
+    return left_value / right_value;
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+int main() {
+    const std::vector<std::string> test_input{"+", "*", "-", "3", "1", "5", "+", "44", "66"};
+    const CompiledExpression compiled_test = CompilePolishNotation(test_input);
+    std::cout << "String evaluator result:   " << EvaluatePolishNotation(test_input) << std::endl;
+    std::cout << "Compiled evaluator result: " << EvaluateCompiled(compiled_test) << std::endl;
+
+    // Correctness check on random expressions
+    std::mt19937 rng(12345);
+    for (int trial = 0; trial < 1000; ++trial) {
+        std::vector<std::string> tokens;
+        GenerateRandomExpression(1 + trial % 8, rng, tokens);
+        if (EvaluatePolishNotation(tokens) != EvaluateCompiled(CompilePolishNotation(tokens))) {
+            std::cout << "MISMATCH on trial " << trial << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Random expressions: all results match" << std::endl << std::endl;
+
+    // Benchmark: evaluate the same expression many times
+    std::vector<std::string> bench_tokens;
+    GenerateRandomExpression(8, rng, bench_tokens);
+    const int kIterations = 20000;
+    std::cout << "Benchmark: " << bench_tokens.size() << " tokens, "
+              << kIterations << " evaluations" << std::endl;
+    long long checksum_string = 0;
+    const double string_seconds = TimeSeconds([&]() {
+        for (int i = 0; i < kIterations; ++i) {
+            checksum_string += EvaluatePolishNotation(bench_tokens);
+        }
+    });
+    long long checksum_compiled = 0;
+    CompiledExpression bench_compiled;
+    const double compile_seconds = TimeSeconds([&]() {
+        bench_compiled = CompilePolishNotation(bench_tokens);
+    });
+    std::vector<int> stack_buffer;
+    const double compiled_seconds = TimeSeconds([&]() {
+        for (int i = 0; i < kIterations; ++i) {
+            checksum_compiled += EvaluateCompiled(bench_compiled, stack_buffer);
+        }
+    });
+    std::cout << "    String evaluator:   " << string_seconds << " s" << std::endl;
+    std::cout << "    Compile (once):     " << compile_seconds << " s" << std::endl;
+    std::cout << "    Compiled evaluator: " << compiled_seconds << " s" << std::endl;
+    std::cout << "    Speedup: " << string_seconds / compiled_seconds << "x" << std::endl;
+    std::cout << "    Checksums match: " << std::boolalpha
+              << (checksum_string == checksum_compiled) << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,457 @@
+/* Parallel evaluation of very large polish notation expressions.
+ *
+ * In a prefix expression, every subtree occupies a contiguous range of tokens: an operator at
+ * index i is followed by its left subtree, which is immediately followed by its right
+ * subtree.  So if we know where each subtree ends, the left and right operands of any
+ * operator are two disjoint token ranges that can be evaluated independently.
+ *
+ * Step 1 computes subtree_end[i] for every token in one right-to-left pass with a stack of
+ * indices (the same pass we use for evaluation, but pushing indices instead of values):
+ *     literal at i:  subtree_end[i] = i + 1
+ *     operator at i: its left child is at i + 1 and its right child starts at
+ *                    subtree_end[i + 1], so subtree_end[i] = subtree_end[right child]
+ *
+ * Step 2 evaluates recursively: when both children of an operator are large, the right
+ * subtree is handed to another thread while this thread evaluates the left one.  Small
+ * subtrees are evaluated sequentially with the usual integer stack.  Integer results do not
+ * depend on evaluation order, so the result is exactly that of the sequential evaluator.
+ *
+ * Arithmetic wraps around on overflow (two's complement) rather than being undefined, and
+ * division by zero throws std::domain_error, from whichever thread runs into it.
+ */
+
+#include <cctype>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+bool IsNumeric(const std::string& s) {
+    for (const char c : s) {
+        if (!std::isdigit(c)) return false;
+    }
+    return true;
+}
+
+enum class OpCode : unsigned char { kPushLiteral, kAdd, kSubtract, kMultiply, kDivide };
+
+struct Instruction {
+    OpCode op_code;
+    int literal;  // only meaningful for kPushLiteral
+};
+
+// Unlike polish_notation_compiled.cpp, the program is kept in prefix (token) order here,
+// so that subtrees stay contiguous and can be addressed by index range
+std::vector<Instruction> CompilePrefix(const std::vector<std::string>& input_expression) {
+    std::vector<Instruction> program;
+    program.reserve(input_expression.size());
+    for (const std::string& token : input_expression) {
+        if (token == "+") {
+            program.push_back({OpCode::kAdd, 0});
+        } else if (token == "-") {
+            program.push_back({OpCode::kSubtract, 0});
+        } else if (token == "*") {
+            program.push_back({OpCode::kMultiply, 0});
+        } else if (token == "/") {
+            program.push_back({OpCode::kDivide, 0});
+        } else if (!token.empty() && IsNumeric(token)) {
+            program.push_back({OpCode::kPushLiteral, std::stoi(token)});
+        } else {
+            throw std::invalid_argument("Unknown token in expression: " + token);
+        }
+    }
+    return program;
+}
+
+// +, - and * wrap around on overflow (computed in unsigned arithmetic, where that's defined),
+// and so does INT_MIN / -1.  Throws std::domain_error on division by zero.
+inline int ApplyOperator(OpCode op_code, int left_operand, int right_operand) {
+    const unsigned left_bits = static_cast<unsigned>(left_operand);
+    const unsigned right_bits = static_cast<unsigned>(right_operand);
+    switch (op_code) {
+        case OpCode::kAdd: return static_cast<int>(left_bits + right_bits);
+        case OpCode::kSubtract: return static_cast<int>(left_bits - right_bits);
+        case OpCode::kMultiply: return static_cast<int>(left_bits * right_bits);
+        case OpCode::kDivide:
+            if (right_operand == 0) {
+                throw std::domain_error("Division by zero");
+            }
+            if ((left_operand == INT_MIN) && (right_operand == -1)) {
+                return INT_MIN;
+            }
+            return left_operand / right_operand;
+        case OpCode::kPushLiteral: break;
+    }
+    return 0;
+}
+
+// Sequential evaluation of the subtree occupying program[start, end), right-to-left
+int EvaluateRangeSequential(const std::vector<Instruction>& program, size_t start, size_t end,
+                            std::vector<int>& stack) {
+    stack.clear();
+    for (size_t i = end; i-- > start;) {
+        const Instruction& instruction = program[i];
+        if (instruction.op_code == OpCode::kPushLiteral) {
+            stack.push_back(instruction.literal);
+        } else {
+            const int left_operand = stack.back();
+            stack.pop_back();
+            stack.back() = ApplyOperator(instruction.op_code, left_operand, stack.back());
+        }
+    }
+    return stack.back();
+}
+
+// Step 1: one linear pass computing the (exclusive) end index of every subtree.
+// Throws std::invalid_argument if the program is not a single well-formed expression.
+std::vector<size_t> ComputeSubtreeEnds(const std::vector<Instruction>& program) {
+    std::vector<size_t> subtree_end(program.size());
+    std::vector<size_t> index_stack;
+    for (size_t i = program.size(); i-- > 0;) {
+        if (program[i].op_code == OpCode::kPushLiteral) {
+            subtree_end[i] = i + 1;
+        } else {
+            if (index_stack.size() < 2) {
+                throw std::invalid_argument("Operator is missing operands");
+            }
+            index_stack.pop_back();  // left child, always at i + 1
+            subtree_end[i] = subtree_end[index_stack.back()];
+            index_stack.pop_back();  // right child
+        }
+        index_stack.push_back(i);
+    }
+    if (index_stack.size() != 1) {
+        throw std::invalid_argument("Expression does not reduce to a single value");
+    }
+    return subtree_end;
+}
+
+class ParallelPrefixEvaluator {
+  public:
+    // Subtree extents are computed once here, so the same expression can then be
+    // evaluated any number of times
+    explicit ParallelPrefixEvaluator(const std::vector<Instruction>& program,
+                                     size_t sequential_cutoff = 1 << 14)
+            : _program(program),
+              _subtree_end(ComputeSubtreeEnds(program)),
+              _sequential_cutoff(sequential_cutoff) {}
+
+    int Evaluate(size_t num_threads) {
+        _spare_threads = static_cast<int>(num_threads) - 1;
+        return EvaluateSubtree(0);
+    }
+
+  private:
+    // Operator on the path down to a large subtree, whose other operand was small and has
+    // already been evaluated
+    struct PendingOperator {
+        OpCode op_code;
+        int small_operand;
+        bool large_subtree_is_left;
+    };
+
+    int EvaluateSubtree(size_t start) {
+        // Walk down through operators where only one child is large (e.g. long chains like
+        // "+ + + ... 1 2 3"), evaluating the small child right away and remembering the
+        // operator, so that unbalanced expressions do not recurse once per token
+        std::vector<PendingOperator> pending_operators;
+        std::vector<int> stack;
+        int value = 0;
+        while (true) {
+            const size_t end = _subtree_end[start];
+            if ((end - start < _sequential_cutoff) ||
+                    (_program[start].op_code == OpCode::kPushLiteral)) {
+                value = EvaluateRangeSequential(_program, start, end, stack);
+                break;
+            }
+            const OpCode op_code = _program[start].op_code;
+            const size_t left_start = start + 1;
+            const size_t right_start = _subtree_end[left_start];
+            const size_t left_size = right_start - left_start;
+            const size_t right_size = end - right_start;
+            if (left_size < _sequential_cutoff) {
+                pending_operators.push_back({op_code,
+                        EvaluateRangeSequential(_program, left_start, right_start, stack),
+                        /*large_subtree_is_left=*/false});
+                start = right_start;
+                continue;
+            }
+            if (right_size < _sequential_cutoff) {
+                pending_operators.push_back({op_code,
+                        EvaluateRangeSequential(_program, right_start, end, stack),
+                        /*large_subtree_is_left=*/true});
+                start = left_start;
+                continue;
+            }
+            // Both children are large: hand the right one to another thread if one is free
+            int left_value = 0;
+            int right_value = 0;
+            if (TryAcquireThread()) {
+                std::future<int> right_future = std::async(std::launch::async,
+                        [this, right_start]() {
+                            ThreadReleaser releaser(*this);
+                            return EvaluateSubtree(right_start);
+                        });
+                left_value = EvaluateSubtree(left_start);
+                right_value = right_future.get();
+            } else {
+                left_value = EvaluateSubtree(left_start);
+                right_value = EvaluateSubtree(right_start);
+            }
+            value = ApplyOperator(op_code, left_value, right_value);
+            break;
+        }
+        // Apply the remembered operators from the bottom of the path back up to start
+        for (auto it = pending_operators.rbegin(); it != pending_operators.rend(); ++it) {
+            value = it->large_subtree_is_left
+                    ? ApplyOperator(it->op_code, value, it->small_operand)
+                    : ApplyOperator(it->op_code, it->small_operand, value);
+        }
+        return value;
+    }
+
+    // Gives an acquired thread back when the task that used it ends, even if the task throws
+    class ThreadReleaser {
+      public:
+        explicit ThreadReleaser(ParallelPrefixEvaluator& evaluator) : _evaluator(evaluator) {}
+        ThreadReleaser(const ThreadReleaser&) = delete;
+        ThreadReleaser& operator=(const ThreadReleaser&) = delete;
+        ~ThreadReleaser() {
+            _evaluator.ReleaseThread();
+        }
+
+      private:
+        ParallelPrefixEvaluator& _evaluator;
+    };
+
+    bool TryAcquireThread() {
+        int spare = _spare_threads.load();
+        while (spare > 0) {
+            if (_spare_threads.compare_exchange_weak(spare, spare - 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ReleaseThread() {
+        ++_spare_threads;
+    }
+
+    const std::vector<Instruction>& _program;
+    std::vector<size_t> _subtree_end;
+    size_t _sequential_cutoff;
+    std::atomic<int> _spare_threads = 0;
+};
+
+// Like IsNumeric, but also accepts a leading '-' (for negative intermediate results)
+bool IsInteger(const std::string& s) {
+    const size_t digits_start = (!s.empty() && (s[0] == '-')) ? 1 : 0;
+    return (s.size() > digits_start) && IsNumeric(s.substr(digits_start));
+}
+
+// Copy of EvaluatePolishNotation from polish_notation.cpp, minus the debug print, kept here as
+// the reference for correctness checks.  The original only reduces nonnegative numbers and
+// doesn't check its arithmetic, so this copy also accepts negative intermediate results, and
+// computes in 64 bits, throwing std::overflow_error if a value doesn't fit in an int and
+// std::domain_error on division by zero.
+int EvaluatePolishNotation(const std::vector<std::string>& input_expression) {
+    static const std::unordered_map<std::string,
+                                    std::function<long long(long long, long long)>> kOpFunctions{
+            {"+", std::plus<long long>()},
+            {"-", std::minus<long long>()},
+            {"*", std::multiplies<long long>()},
+            {"/", std::divides<long long>()}};
+    std::vector<std::string> stack;
+    for (const std::string& current_element : input_expression) {
+        stack.push_back(current_element);
+        while ((stack.size() >= 3) && IsInteger(stack.back()) &&
+                IsInteger(stack[stack.size() - 2])) {
+            const long long right_operand = std::stoll(stack.back());
+            stack.pop_back();
+            const long long left_operand = std::stoll(stack.back());
+            stack.pop_back();
+            if ((stack.back() == "/") && (right_operand == 0)) {
+                throw std::domain_error("Division by zero");
+            }
+            const long long result = kOpFunctions.at(stack.back())(left_operand, right_operand);
+            stack.pop_back();
+            if ((result < INT_MIN) || (result > INT_MAX)) {
+                throw std::overflow_error("Result does not fit in an int");
+            }
+            stack.push_back(std::to_string(result));
+        }
+    }
+    return std::stoi(stack.back());
+}
+
+// Shapes of random test expressions: any shape, or chains where every operator's left (or
+// right) operand is a literal, which are as deep as possible
+enum class ExpressionShape { kRandom, kLeftDeep, kRightDeep };
+
+// Generate a random test expression with exactly num_literals literals (digits 0-9, so
+// division by zero does happen) as prefix tokens, using all four operators
+void GenerateTestExpression(size_t num_literals, ExpressionShape shape, std::mt19937& rng,
+                            std::vector<std::string>& tokens) {
+    std::uniform_int_distribution<int> digit_dist(0, 9);
+    if (num_literals == 1) {
+        tokens.push_back(std::to_string(digit_dist(rng)));
+        return;
+    }
+    // Mostly + and -, so that some longer expressions don't overflow
+    static const std::vector<std::string> kOperators{"+", "+", "+", "-", "-", "-", "*", "/"};
+    tokens.push_back(kOperators[std::uniform_int_distribution<size_t>(0, 7)(rng)]);
+    size_t left_literals = 1;
+    if (shape == ExpressionShape::kLeftDeep) {
+        left_literals = num_literals - 1;
+    } else if (shape == ExpressionShape::kRandom) {
+        left_literals = std::uniform_int_distribution<size_t>(1, num_literals - 1)(rng);
+    }
+    GenerateTestExpression(left_literals, shape, rng, tokens);
+    GenerateTestExpression(num_literals - left_literals, shape, rng, tokens);
+}
+
+// Generate a random expression with exactly num_literals literals as prefix tokens.  Uses
+// + and - (and / by a nonzero digit), so values stay small and there is no division by zero.
+void GenerateRandomExpression(size_t num_literals, std::mt19937& rng,
+                              std::vector<std::string>& tokens) {
+    std::uniform_int_distribution<int> digit_dist(0, 9);
+    if (num_literals == 1) {
+        tokens.push_back(std::to_string(digit_dist(rng)));
+        return;
+    }
+    if (std::uniform_int_distribution<int>(0, 9)(rng) == 0) {
+        tokens.push_back("/");
+        GenerateRandomExpression(num_literals - 1, rng, tokens);
+        tokens.push_back(std::to_string(1 + digit_dist(rng) % 9));
+        return;
+    }
+    tokens.push_back(std::uniform_int_distribution<int>(0, 1)(rng) ? "+" : "-");
+    const size_t left_literals =
+            std::uniform_int_distribution<size_t>(1, num_literals - 1)(rng);
+    GenerateRandomExpression(left_literals, rng, tokens);
+    GenerateRandomExpression(num_literals - left_literals, rng, tokens);
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+int main() {
+    const std::vector<std::string> test_input{"+", "*", "-", "3", "1", "5", "+", "44", "66"};
+    const std::vector<Instruction> test_program = CompilePrefix(test_input);
+    ParallelPrefixEvaluator test_evaluator(test_program, /*sequential_cutoff=*/2);
+    const int test_result = test_evaluator.Evaluate(4);
+    std::cout << "Result = " << test_result << std::endl << std::endl;
+    if (test_result != EvaluatePolishNotation(test_input)) {
+        std::cout << "MISMATCH against the reference evaluator" << std::endl;
+        return 1;
+    }
+
+    // Random small expressions of every shape, with every cutoff and several thread counts,
+    // against the reference evaluator.  Where the reference overflows, the parallel result
+    // (which wraps around) isn't comparable, so those are only checked not to crash.  Division
+    // by zero must throw std::domain_error from the parallel evaluator too.
+    std::mt19937 rng(12345);
+    size_t num_compared = 0;
+    size_t num_division_by_zero = 0;
+    size_t num_overflow = 0;
+    for (int trial = 0; trial < 3000; ++trial) {
+        const ExpressionShape shape = static_cast<ExpressionShape>(trial % 3);
+        std::vector<std::string> test_tokens;
+        GenerateTestExpression(1 + trial % 40, shape, rng, test_tokens);
+        enum class Outcome { kValue, kDivisionByZero, kOverflow };
+        Outcome expected_outcome = Outcome::kValue;
+        int expected_value = 0;
+        try {
+            expected_value = EvaluatePolishNotation(test_tokens);
+        } catch (const std::domain_error&) {
+            expected_outcome = Outcome::kDivisionByZero;
+        } catch (const std::overflow_error&) {
+            expected_outcome = Outcome::kOverflow;
+        }
+        num_compared += (expected_outcome == Outcome::kValue);
+        num_division_by_zero += (expected_outcome == Outcome::kDivisionByZero);
+        num_overflow += (expected_outcome == Outcome::kOverflow);
+        const std::vector<Instruction> random_program = CompilePrefix(test_tokens);
+        for (const size_t cutoff : {1, 2, 3, 5, 8, 16, 64}) {
+            ParallelPrefixEvaluator random_evaluator(random_program, cutoff);
+            for (const size_t num_threads : {1, 2, 3, 4, 8}) {
+                Outcome outcome = Outcome::kValue;
+                int value = 0;
+                try {
+                    value = random_evaluator.Evaluate(num_threads);
+                } catch (const std::domain_error&) {
+                    outcome = Outcome::kDivisionByZero;
+                }
+                const bool matches = (expected_outcome == Outcome::kOverflow) ||
+                        ((outcome == expected_outcome) && (value == expected_value));
+                if (!matches) {
+                    std::cout << "MISMATCH with cutoff " << cutoff << " and " << num_threads
+                              << " threads for:";
+                    for (const std::string& token : test_tokens) {
+                        std::cout << " " << token;
+                    }
+                    std::cout << std::endl;
+                    return 1;
+                }
+            }
+        }
+    }
+    std::cout << "Random expressions (" << num_compared << " with a value, "
+              << num_division_by_zero << " dividing by zero, " << num_overflow
+              << " overflowing), cutoffs 1-64 and 1-8 threads: results match the reference"
+              << std::endl << std::endl;
+
+    const size_t kNumLiterals = 5'000'000;
+    std::vector<std::string> tokens;
+    GenerateRandomExpression(kNumLiterals, rng, tokens);
+    const std::vector<Instruction> program = CompilePrefix(tokens);
+    std::cout << "Benchmark: " << program.size() << " tokens" << std::endl;
+
+    int sequential_result = 0;
+    const double sequential_seconds = TimeSeconds([&]() {
+        std::vector<int> stack;
+        sequential_result = EvaluateRangeSequential(program, 0, program.size(), stack);
+    });
+    std::cout << "    Sequential: " << sequential_seconds << " s, result = "
+              << sequential_result << std::endl;
+
+    // Computing the extents is a one-time, linear, sequential pass per expression
+    std::unique_ptr<ParallelPrefixEvaluator> evaluator;
+    const double extents_seconds = TimeSeconds([&]() {
+        evaluator = std::make_unique<ParallelPrefixEvaluator>(program);
+    });
+    std::cout << "    Computing subtree extents (once): " << extents_seconds << " s" << std::endl;
+
+    const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t num_threads = 1; num_threads <= std::max<size_t>(max_threads, 16);
+            num_threads *= 2) {
+        int parallel_result = 0;
+        const double parallel_seconds = TimeSeconds([&]() {
+            parallel_result = evaluator->Evaluate(num_threads);
+        });
+        std::cout << "    " << num_threads << " thread(s): " << parallel_seconds << " s, "
+                  << "speedup " << sequential_seconds / parallel_seconds << "x, "
+                  << (parallel_result == sequential_result ? "result matches" : "MISMATCH")
+                  << std::endl;
+    }
+    std::cout << "(hardware threads available: " << max_threads << ")" << std::endl;
+
+    return 0;
+}
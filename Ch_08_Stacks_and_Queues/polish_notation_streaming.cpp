@@ -0,0 +1,494 @@
+/* Streaming evaluation of a file of polish notation expressions, one expression per line,
+ * e.g. "+ * - 3 1 5 + 44 66".
+ *
+ * The file is read in fixed-size chunks into a single reusable buffer, and every line and
+ * token is a std::string_view pointing straight into that buffer - no std::string is ever
+ * built.  A line that straddles the end of a chunk is moved to the front of the buffer
+ * before the next read, so memory use is constant (one chunk, plus the longest line if that
+ * happens to be longer than a chunk) no matter how big the file is.
+ *
+ * Evaluation uses the same trick as polish_notation_compiled.cpp: a prefix expression read
+ * right-to-left can be evaluated with a plain integer stack, operators taking their left
+ * operand from the top.  Since the whole line is sitting in the buffer, we simply walk its
+ * tokens backwards.
+ *
+ * The lines are untrusted input, so anything that isn't a valid expression over ints, or
+ * whose evaluation would divide by zero or overflow an int, is counted as an error.
+ *
+ * Usage: polish_notation_streaming [input_file]
+ * Without an input file, a temporary file of random expressions is generated first.
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Reads a file line by line through one reusable buffer.  Returned views stay valid only
+// until the next call to NextLine.
+class ChunkedLineReader {
+  public:
+    explicit ChunkedLineReader(const std::string& file_path, size_t chunk_size = 1 << 20)
+            : _file(std::fopen(file_path.c_str(), "rb")), _buffer(chunk_size) {}
+
+    ~ChunkedLineReader() {
+        if (_file != nullptr) {
+            std::fclose(_file);
+        }
+    }
+
+    ChunkedLineReader(const ChunkedLineReader&) = delete;
+    ChunkedLineReader& operator=(const ChunkedLineReader&) = delete;
+
+    bool is_open() const {
+        return _file != nullptr;
+    }
+
+    size_t bytes_read() const {
+        return _bytes_read;
+    }
+
+    // Whether reading stopped because of an error rather than the end of the file
+    bool read_error() const {
+        return _read_error;
+    }
+
+    // Returns false once the file is exhausted, or on a read error (check read_error()).
+    // A final line without a trailing newline is still returned, unless reading failed.
+    bool NextLine(std::string_view* line) {
+        while (true) {
+            if (_read_error) {
+                return false;
+            }
+            const char* begin = _buffer.data() + _line_start;
+            const char* end = _buffer.data() + _data_end;
+            const char* newline = static_cast<const char*>(
+                    std::memchr(begin, '\n', end - begin));
+            if (newline != nullptr) {
+                *line = std::string_view(begin, newline - begin);
+                _line_start += (newline - begin) + 1;
+                return true;
+            }
+            if (_at_eof) {
+                if (begin == end) {
+                    return false;
+                }
+                *line = std::string_view(begin, end - begin);
+                _line_start = _data_end;
+                return true;
+            }
+            Refill();
+        }
+    }
+
+  private:
+    // Move the partial line to the front of the buffer and read more data after it,
+    // growing the buffer only if a single line does not fit in it
+    void Refill() {
+        const size_t partial_size = _data_end - _line_start;
+        std::memmove(_buffer.data(), _buffer.data() + _line_start, partial_size);
+        _line_start = 0;
+        _data_end = partial_size;
+        if (_data_end == _buffer.size()) {
+            _buffer.resize(_buffer.size() * 2);
+        }
+        const size_t count = (_file == nullptr) ? 0 :
+                std::fread(_buffer.data() + _data_end, 1, _buffer.size() - _data_end, _file);
+        _data_end += count;
+        _bytes_read += count;
+        _at_eof = (count == 0);
+        _read_error = (_file != nullptr) && std::ferror(_file);
+    }
+
+    std::FILE* _file;
+    std::vector<char> _buffer;
+    size_t _line_start = 0;  // start of the next unread line in _buffer
+    size_t _data_end = 0;    // end of valid data in _buffer
+    size_t _bytes_read = 0;
+    bool _at_eof = false;
+    bool _read_error = false;
+};
+
+bool IsWhitespace(char c) {
+    return (c == ' ') || (c == '\t') || (c == '\r');
+}
+
+// Evaluate one prefix expression given as a line of space-separated tokens, walking the
+// tokens from right to left.  stack is scratch space reused between calls.
+// Returns false (leaving *result untouched) for malformed lines, division by zero, and
+// results that don't fit in an int.
+bool EvaluatePolishNotationLine(std::string_view line, std::vector<int>& stack, int* result) {
+    stack.clear();
+    size_t token_end = line.size();
+    while (true) {
+        while ((token_end > 0) && IsWhitespace(line[token_end - 1])) {
+            --token_end;
+        }
+        if (token_end == 0) {
+            break;
+        }
+        size_t token_start = token_end;
+        while ((token_start > 0) && !IsWhitespace(line[token_start - 1])) {
+            --token_start;
+        }
+        const std::string_view token = line.substr(token_start, token_end - token_start);
+        token_end = token_start;
+        if ((token.size() == 1) && std::strchr("+-*/", token[0]) != nullptr) {
+            if (stack.size() < 2) {
+                return false;
+            }
+            // Left operand is on top, since we are reading the expression backwards
+            const int left_operand = stack.back();
+            stack.pop_back();
+            int& right_operand_and_result = stack.back();
+            const int right_operand = right_operand_and_result;
+            bool overflow = false;
+            switch (token[0]) {
+                case '+':
+                    overflow = __builtin_add_overflow(left_operand, right_operand,
+                                                      &right_operand_and_result);
+                    break;
+                case '-':
+                    overflow = __builtin_sub_overflow(left_operand, right_operand,
+                                                      &right_operand_and_result);
+                    break;
+                case '*':
+                    overflow = __builtin_mul_overflow(left_operand, right_operand,
+                                                      &right_operand_and_result);
+                    break;
+                case '/':
+                    if ((right_operand == 0) ||
+                            ((left_operand == INT_MIN) && (right_operand == -1))) {
+                        return false;
+                    }
+                    right_operand_and_result = left_operand / right_operand;
+                    break;
+            }
+            if (overflow) {
+                return false;
+            }
+        } else {
+            int value = 0;
+            const auto [parse_end, error] =
+                    std::from_chars(token.data(), token.data() + token.size(), value);
+            if ((error != std::errc()) || (parse_end != token.data() + token.size())) {
+                return false;
+            }
+            stack.push_back(value);
+        }
+    }
+    if (stack.size() != 1) {
+        return false;
+    }
+    *result = stack.back();
+    return true;
+}
+
+bool IsNumeric(const std::string& s) {
+    for (const char c : s) {
+        if (!std::isdigit(c)) return false;
+    }
+    return true;
+}
+
+bool IsInteger(const std::string& s) {
+    const size_t digits_start = (!s.empty() && (s[0] == '-')) ? 1 : 0;
+    return (s.size() > digits_start) && IsNumeric(s.substr(digits_start));
+}
+
+// EvaluatePolishNotation from polish_notation.cpp, minus the debug print, kept here as the
+// reference for correctness checks.  The original assumes a well-formed expression of
+// nonnegative values, so this copy also accepts negative numbers, does its arithmetic in
+// 64 bits, and returns nullopt wherever the original would crash, throw or overflow.
+std::optional<int> EvaluatePolishNotation(const std::vector<std::string>& input_expression) {
+    static const std::unordered_map<std::string,
+                                    std::function<long long(long long, long long)>> kOpFunctions{
+            {"+", std::plus<long long>()},
+            {"-", std::minus<long long>()},
+            {"*", std::multiplies<long long>()},
+            {"/", std::divides<long long>()}};
+    std::vector<std::string> stack;
+    for (const std::string& current_element : input_expression) {
+        if (!IsInteger(current_element) && (kOpFunctions.count(current_element) == 0)) {
+            return std::nullopt;
+        }
+        stack.push_back(current_element);
+        while ((stack.size() >= 3) && IsInteger(stack.back()) &&
+                IsInteger(stack[stack.size() - 2])) {
+            long long right_operand = 0;
+            long long left_operand = 0;
+            try {
+                right_operand = std::stoll(stack.back());
+                left_operand = std::stoll(stack[stack.size() - 2]);
+            } catch (const std::out_of_range&) {
+                return std::nullopt;
+            }
+            stack.pop_back();
+            stack.pop_back();
+            if ((kOpFunctions.count(stack.back()) == 0) ||
+                    (left_operand < INT_MIN) || (left_operand > INT_MAX) ||
+                    (right_operand < INT_MIN) || (right_operand > INT_MAX) ||
+                    ((stack.back() == "/") && (right_operand == 0))) {
+                return std::nullopt;
+            }
+            const auto& op_func = kOpFunctions.at(stack.back());
+            stack.pop_back();
+            stack.push_back(std::to_string(op_func(left_operand, right_operand)));
+        }
+    }
+    if ((stack.size() != 1) || !IsInteger(stack.back())) {
+        return std::nullopt;
+    }
+    long long result = 0;
+    try {
+        result = std::stoll(stack.back());
+    } catch (const std::out_of_range&) {
+        return std::nullopt;
+    }
+    if ((result < INT_MIN) || (result > INT_MAX)) {
+        return std::nullopt;
+    }
+    return static_cast<int>(result);
+}
+
+// Random token sequences for the correctness check: expression trees over edge-case operands,
+// half of them then broken by dropping, inserting or swapping tokens
+std::vector<std::string> RandomTestTokens(std::mt19937& rng) {
+    static const std::vector<std::string> kOperators{"+", "-", "*", "/"};
+    static const std::vector<std::string> kOperands{
+            "0", "1", "-1", "2", "-2", "7", "-7", "10", "46341", "-46341", "65536",
+            "2147483647", "-2147483647", "-2147483648", "1073741824", "-0", "007"};
+    static const std::vector<std::string> kBadTokens{
+            "x", "1a", "+5", "--", "2147483648", "-2147483649", "99999999999999999999", "*/"};
+    std::vector<std::string> tokens;
+    const int num_operators = std::uniform_int_distribution<int>(0, 6)(rng);
+    // Prefix order: each operator is followed by its operands, so a random sequence with
+    // one more operand than operators, where every prefix has more operators than operands,
+    // is well-formed.  Emit operators and operands in a random valid order.
+    int operators_left = num_operators;
+    int operands_needed = 1;
+    while (operands_needed > 0) {
+        const bool emit_operator = (operators_left > 0) &&
+                ((operands_needed == 1) || (std::uniform_int_distribution<int>(0, 1)(rng) == 0));
+        if (emit_operator) {
+            tokens.push_back(kOperators[std::uniform_int_distribution<size_t>(0, 3)(rng)]);
+            --operators_left;
+            ++operands_needed;
+        } else {
+            tokens.push_back(kOperands[std::uniform_int_distribution<size_t>(
+                    0, kOperands.size() - 1)(rng)]);
+            --operands_needed;
+        }
+    }
+    if (std::uniform_int_distribution<int>(0, 1)(rng) == 0) {
+        std::uniform_int_distribution<size_t> position_dist(0, tokens.size());
+        switch (std::uniform_int_distribution<int>(0, 3)(rng)) {
+            case 0:
+                if (!tokens.empty()) {
+                    tokens.erase(tokens.begin() + position_dist(rng) % tokens.size());
+                }
+                break;
+            case 1:
+                tokens.insert(tokens.begin() + position_dist(rng), kBadTokens[
+                        std::uniform_int_distribution<size_t>(0, kBadTokens.size() - 1)(rng)]);
+                break;
+            case 2:
+                tokens.insert(tokens.begin() + position_dist(rng),
+                              kOperators[std::uniform_int_distribution<size_t>(0, 3)(rng)]);
+                break;
+            case 3:
+                std::swap(tokens[position_dist(rng) % tokens.size()],
+                          tokens[position_dist(rng) % tokens.size()]);
+                break;
+        }
+    }
+    return tokens;
+}
+
+// Writes random well-formed expressions (operands 1-9, no division by zero possible
+// since divisors are always literals) to a file, one per line
+bool GenerateExpressionFile(const std::string& file_path, size_t num_expressions) {
+    std::FILE* file = std::fopen(file_path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> digit_dist(1, 9);
+    std::uniform_int_distribution<int> op_dist(0, 3);
+    std::uniform_int_distribution<int> num_ops_dist(1, 8);
+    std::string line;
+    for (size_t i = 0; i < num_expressions; ++i) {
+        // Left-deep chain: op op op ... d d d ... d  (each op's right operand is a literal)
+        const int num_ops = num_ops_dist(rng);
+        line.clear();
+        for (int op = 0; op < num_ops; ++op) {
+            line += "+-*/"[op_dist(rng)];
+            line += ' ';
+        }
+        line += std::to_string(digit_dist(rng));
+        for (int op = 0; op < num_ops; ++op) {
+            line += ' ';
+            line += std::to_string(digit_dist(rng));
+        }
+        line += '\n';
+        std::fwrite(line.data(), 1, line.size(), file);
+    }
+    const bool write_failed = std::ferror(file);
+    return (std::fclose(file) == 0) && !write_failed;
+}
+
+// Deletes the file at path when it goes out of scope, so that every way out of main cleans up
+// the files it wrote
+class TemporaryFile {
+  public:
+    explicit TemporaryFile(const std::string& path) : _path(path) {}
+    TemporaryFile(const TemporaryFile&) = delete;
+    TemporaryFile& operator=(const TemporaryFile&) = delete;
+    ~TemporaryFile() {
+        std::remove(_path.c_str());
+    }
+
+  private:
+    std::string _path;
+};
+
+int main(int argc, char** argv) {
+    std::vector<int> stack;
+    int result = 0;
+    EvaluatePolishNotationLine("+ * - 3 1 5 + 44 66", stack, &result);
+    std::cout << "+ * - 3 1 5 + 44 66 = " << result << std::endl << std::endl;
+
+    // Random well-formed, malformed and overflowing lines, with random separators, written to
+    // a file and read back in tiny chunks (so most lines straddle a chunk boundary), against
+    // the reference evaluator
+    const std::string check_file_path = "/tmp/polish_notation_streaming_check.txt";
+    std::vector<std::string> check_lines{
+            "/ -2147483648 -1", "* -2147483648 -1", "- -2147483648 1", "+ 2147483647 1",
+            "* 65536 65536", "* 46341 46341", "- 0 -2147483648", "/ 5 0", "/ -2147483648 1",
+            "- -1 2147483647", "", "   ", "+", "1 2", "2147483648", "-", "+ 1", "5"};
+    std::mt19937 rng(12345);
+    const char* const kSeparators[] = {" ", "  ", "\t", " \r"};
+    for (int trial = 0; trial < 200'000; ++trial) {
+        const std::vector<std::string> tokens = RandomTestTokens(rng);
+        std::string line;
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            if (i > 0) {
+                line += kSeparators[std::uniform_int_distribution<int>(0, 3)(rng)];
+            }
+            line += tokens[i];
+        }
+        check_lines.push_back(line);
+    }
+    std::FILE* check_file = std::fopen(check_file_path.c_str(), "wb");
+    if (check_file == nullptr) {
+        std::cerr << "Could not create " << check_file_path << std::endl;
+        return 1;
+    }
+    const TemporaryFile check_file_remover(check_file_path);
+    for (const std::string& line : check_lines) {
+        std::fwrite(line.data(), 1, line.size(), check_file);
+        std::fputc('\n', check_file);
+    }
+    std::fclose(check_file);
+    ChunkedLineReader check_reader(check_file_path, /* chunk_size */ 16);
+    size_t num_valid = 0;
+    for (const std::string& expected_line : check_lines) {
+        std::string_view line;
+        if (!check_reader.NextLine(&line) || (line != expected_line)) {
+            std::cout << "MISMATCH reading back line \"" << expected_line << "\"" << std::endl;
+            return 1;
+        }
+        std::vector<std::string> tokens;
+        for (size_t token_start = 0; token_start < line.size(); /* token_start = token_end */) {
+            if (IsWhitespace(line[token_start])) {
+                ++token_start;
+                continue;
+            }
+            size_t token_end = token_start;
+            while ((token_end < line.size()) && !IsWhitespace(line[token_end])) {
+                ++token_end;
+            }
+            tokens.emplace_back(line.substr(token_start, token_end - token_start));
+            token_start = token_end;
+        }
+        const std::optional<int> expected = EvaluatePolishNotation(tokens);
+        const bool is_valid = EvaluatePolishNotationLine(line, stack, &result);
+        if ((is_valid != expected.has_value()) || (is_valid && (result != *expected))) {
+            std::cout << "MISMATCH for \"" << expected_line << "\"" << std::endl;
+            return 1;
+        }
+        num_valid += is_valid;
+    }
+    std::string_view extra_line;
+    if (check_reader.NextLine(&extra_line) || check_reader.read_error()) {
+        std::cout << "MISMATCH at the end of " << check_file_path << std::endl;
+        return 1;
+    }
+    std::cout << check_lines.size() << " random and edge-case lines (" << num_valid
+              << " valid): results and errors match the reference evaluator" << std::endl
+              << std::endl;
+
+    std::string file_path;
+    // Only a file generated here is deleted at the end, not one given on the command line
+    std::optional<TemporaryFile> generated_file_remover;
+    if (argc > 1) {
+        file_path = argv[1];
+    } else {
+        file_path = "/tmp/polish_notation_streaming_input.txt";
+        generated_file_remover.emplace(file_path);
+        const size_t kNumExpressions = 5'000'000;
+        std::cout << "Generating " << kNumExpressions << " expressions in " << file_path
+                  << std::endl;
+        if (!GenerateExpressionFile(file_path, kNumExpressions)) {
+            std::cerr << "Could not write " << file_path << std::endl;
+            return 1;
+        }
+    }
+
+    ChunkedLineReader reader(file_path);
+    if (!reader.is_open()) {
+        std::cerr << "Could not open " << file_path << std::endl;
+        return 1;
+    }
+    size_t num_expressions = 0;
+    size_t num_errors = 0;
+    long long checksum = 0;
+    const auto start_time = std::chrono::steady_clock::now();
+    std::string_view line;
+    while (reader.NextLine(&line)) {
+        if (EvaluatePolishNotationLine(line, stack, &result)) {
+            checksum += result;
+        } else {
+            ++num_errors;
+        }
+        ++num_expressions;
+    }
+    if (reader.read_error()) {
+        std::cerr << "Error reading " << file_path << " after " << num_expressions
+                  << " expressions" << std::endl;
+        return 1;
+    }
+    const auto end_time = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(end_time - start_time).count();
+
+    std::cout << "Expressions: " << num_expressions << " (" << num_errors << " errors)"
+              << std::endl;
+    std::cout << "Checksum: " << checksum << std::endl;
+    std::cout << "Time: " << seconds << " s" << std::endl;
+    std::cout << "Throughput: " << num_expressions / seconds / 1e6 << " M expressions/s, "
+              << reader.bytes_read() / seconds / (1 << 20) << " MB/s" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,422 @@
+/* Iterative, buffered version of PrintBT from max_tree.cpp, with the same output.
+ *
+ * PrintBTRecursive recurses once per level, so a degenerate tree (e.g. the max tree of sorted
+ * input, which is a path) overflows the stack.  It also copies the whole prefix into a new
+ * string at every node, and ends every line with std::endl, which flushes the stream: one
+ * write system call per node.
+ *
+ * RenderBT walks the tree in preorder with an explicit stack.  All nodes share one prefix
+ * string: a node at depth d only needs the first prefix_lengths[d] characters of it, which
+ * were written by its parent, so we truncate to that and append the node's own segment for
+ * its children.  Lines go into a large buffer that's written out when full, to an ostream
+ * or straight to a file descriptor.
+ *
+ * The output is still O(n * height) characters, which for a path of n nodes is quadratic:
+ * a path of a million nodes would print terabytes.  So there are optional limits on the depth
+ * and on the number of nodes printed.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+template <typename T>
+struct Node {
+    Node(const T& value) : value(value) {}
+
+    T value;
+    std::unique_ptr<Node<T>> left_child;
+    std::unique_ptr<Node<T>> right_child;
+    Node<T>* parent = nullptr;
+};
+
+// Copies of PrintBTRecursive, PrintBT and ConstructMaxTree from max_tree.cpp, kept here as the
+// reference for correctness checks and benchmarking
+
+// Idea from here: https://stackoverflow.com/a/51730733
+template <typename PointerT>
+void PrintBTRecursive(const std::string& prefix, const PointerT& node, bool is_left_child) {
+    if (node != nullptr) {
+        std::cout << prefix;
+        std::cout << (is_left_child ? "├──L:" : "└──R:" );
+        std::cout << node->value << std::endl;
+        // Recurse on left and right subtrees
+        const std::string subtree_prefix = prefix + (is_left_child ? "│     " : "      ");
+        PrintBTRecursive(subtree_prefix, node->left_child.get(), true);
+        PrintBTRecursive(subtree_prefix, node->right_child.get(), false);
+    }
+}
+
+template <typename PointerT>
+void PrintBT(const PointerT& root) {
+    PrintBTRecursive("", root, false);
+}
+
+template <typename T>
+std::unique_ptr<Node<T>> ConstructMaxTree(const std::vector<T>& input_vector) {
+    if (input_vector.size() == 0) {
+        return nullptr;
+    }
+    std::unique_ptr<Node<T>> root = std::make_unique<Node<T>>(input_vector[0]);
+    Node<T>* current_node = root.get();
+    for (size_t i = 1; i < input_vector.size(); ++i) {
+        const T& value_to_insert = input_vector[i];
+        // Walk up the tree until new value is not greater than parent value
+        while ((current_node != nullptr) && (value_to_insert > current_node->value)) {
+            current_node = current_node->parent;
+        }
+        // Now we need to make the new value current_node's right child
+        // and move current_node's current right child to new node's left child
+        // If current node is nullptr, then the new node will be the new root
+        // and the current root will be this new node's left child
+        if (current_node == nullptr) {
+            std::unique_ptr<Node<T>> new_root = std::make_unique<Node<T>>(value_to_insert);
+            new_root->left_child = std::move(root);
+            new_root->left_child->parent = new_root.get();
+            root = std::move(new_root);
+            current_node = root.get();
+        } else {
+            // Insert and rotate right child, if exists
+            if (current_node->right_child != nullptr) {
+                std::unique_ptr<Node<T>> new_node = std::make_unique<Node<T>>(value_to_insert);
+                new_node->left_child = std::move(current_node->right_child);
+                new_node->left_child->parent = new_node.get();
+                current_node->right_child = std::move(new_node);
+            } else {  // no right child of current_node, so just insert as right child
+                current_node->right_child = std::make_unique<Node<T>>(value_to_insert);
+            }
+            current_node->right_child->parent = current_node;
+            // Update current_node as node we just inserted
+            current_node = current_node->right_child.get();
+        }
+    }
+    return root;
+}
+
+// Collects output in a large buffer, and writes it out when the buffer is full, on flush(),
+// and on destruction.  Writes either to an ostream or to a file descriptor, which throws
+// std::system_error if writing fails.
+class OutputBuffer {
+  public:
+    static constexpr size_t kDefaultCapacity = 1 << 20;
+
+    explicit OutputBuffer(std::ostream& os, size_t capacity = kDefaultCapacity)
+            : _os_ptr(&os), _capacity(capacity) {
+        _buffer.reserve(capacity);
+    }
+
+    explicit OutputBuffer(int fd, size_t capacity = kDefaultCapacity)
+            : _fd(fd), _capacity(capacity) {
+        _buffer.reserve(capacity);
+    }
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    ~OutputBuffer() {
+        try {
+            flush();
+        } catch (const std::system_error&) {
+            // Nowhere to report it from a destructor: call flush() first to see write errors
+        }
+    }
+
+    void append(std::string_view s) {
+        if (_buffer.size() + s.size() > _capacity) {
+            flush();
+        }
+        _buffer.append(s);
+    }
+
+    void flush() {
+        if (_os_ptr != nullptr) {
+            _os_ptr->write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+            _os_ptr->flush();
+        } else {
+            for (size_t written = 0; written < _buffer.size(); /* written += result */) {
+                const ssize_t result =
+                        ::write(_fd, _buffer.data() + written, _buffer.size() - written);
+                if (result < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    _buffer.clear();
+                    throw std::system_error(errno, std::generic_category(), "OutputBuffer write");
+                }
+                written += static_cast<size_t>(result);
+            }
+        }
+        _buffer.clear();
+    }
+
+  private:
+    std::ostream* _os_ptr = nullptr;
+    int _fd = -1;
+    size_t _capacity;
+    std::string _buffer;
+};
+
+// Optional limits on what RenderBT prints.  The root has depth 0.
+struct RenderLimits {
+    size_t max_depth = std::numeric_limits<size_t>::max();
+    size_t max_nodes = std::numeric_limits<size_t>::max();
+};
+
+// Appends value to out as operator<< would with default stream settings: integers are
+// formatted directly, anything else (including characters) through a reused string stream
+template <typename T>
+void AppendValue(const T& value, OutputBuffer& out, std::ostringstream& formatter) {
+    if constexpr (std::is_same_v<T, short> || std::is_same_v<T, unsigned short> ||
+                  std::is_same_v<T, int> || std::is_same_v<T, unsigned int> ||
+                  std::is_same_v<T, long> || std::is_same_v<T, unsigned long> ||
+                  std::is_same_v<T, long long> || std::is_same_v<T, unsigned long long>) {
+        char digits[std::numeric_limits<T>::digits10 + 3];
+        const std::to_chars_result result = std::to_chars(std::begin(digits), std::end(digits),
+                                                          value);
+        out.append(std::string_view(digits, result.ptr - digits));
+    } else {
+        formatter.str("");
+        formatter << value;
+        out.append(formatter.view());
+    }
+}
+
+// Same output as PrintBT, into out.  Nodes deeper than limits.max_depth aren't printed, and
+// printing stops after limits.max_nodes nodes.  Returns whether the whole tree was printed.
+template <typename PointerT>
+bool RenderBT(const PointerT& root, OutputBuffer& out, const RenderLimits& limits = {}) {
+    using NodeT = std::remove_reference_t<decltype(*root)>;
+    struct Frame {
+        const NodeT* node_ptr;
+        size_t depth;
+        bool is_left_child;
+    };
+    std::vector<Frame> frames;
+    if (root != nullptr) {
+        frames.push_back({&*root, 0, false});
+    }
+    std::string prefix;
+    // prefix_lengths[d]: length of the prefix of nodes at depth d
+    std::vector<size_t> prefix_lengths{0};
+    std::ostringstream formatter;
+    size_t num_nodes_printed = 0;
+    bool printed_everything = true;
+    while (!frames.empty()) {
+        const Frame frame = frames.back();
+        frames.pop_back();
+        if (num_nodes_printed == limits.max_nodes) {
+            return false;
+        }
+        prefix.resize(prefix_lengths[frame.depth]);
+        out.append(prefix);
+        out.append(frame.is_left_child ? "├──L:" : "└──R:");
+        AppendValue(frame.node_ptr->value, out, formatter);
+        out.append("\n");
+        ++num_nodes_printed;
+        const NodeT* left_ptr = frame.node_ptr->left_child.get();
+        const NodeT* right_ptr = frame.node_ptr->right_child.get();
+        if ((left_ptr == nullptr) && (right_ptr == nullptr)) {
+            continue;
+        }
+        if (frame.depth == limits.max_depth) {
+            printed_everything = false;
+            continue;
+        }
+        prefix.append(frame.is_left_child ? "│     " : "      ");
+        if (prefix_lengths.size() == frame.depth + 1) {
+            prefix_lengths.push_back(0);
+        }
+        prefix_lengths[frame.depth + 1] = prefix.size();
+        if (right_ptr != nullptr) {
+            frames.push_back({right_ptr, frame.depth + 1, false});
+        }
+        if (left_ptr != nullptr) {
+            frames.push_back({left_ptr, frame.depth + 1, true});
+        }
+    }
+    return printed_everything;
+}
+
+template <typename PointerT>
+bool RenderBT(const PointerT& root, std::ostream& os, const RenderLimits& limits = {}) {
+    OutputBuffer out(os);
+    const bool printed_everything = RenderBT(root, out, limits);
+    out.flush();
+    return printed_everything;
+}
+
+template <typename PointerT>
+bool RenderBT(const PointerT& root, int fd, const RenderLimits& limits = {}) {
+    OutputBuffer out(fd);
+    const bool printed_everything = RenderBT(root, out, limits);
+    out.flush();
+    return printed_everything;
+}
+
+// Deletes a tree one node at a time, since destroying a deep tree through its unique_ptrs
+// would recurse once per level and overflow the stack
+template <typename T>
+void DestroyTree(std::unique_ptr<Node<T>> root) {
+    std::vector<std::unique_ptr<Node<T>>> pending;
+    if (root != nullptr) {
+        pending.push_back(std::move(root));
+    }
+    while (!pending.empty()) {
+        std::unique_ptr<Node<T>> node = std::move(pending.back());
+        pending.pop_back();
+        if (node->left_child != nullptr) {
+            pending.push_back(std::move(node->left_child));
+        }
+        if (node->right_child != nullptr) {
+            pending.push_back(std::move(node->right_child));
+        }
+    }
+}
+
+// Output of the original PrintBT, captured from std::cout
+template <typename PointerT>
+std::string CaptureOriginalOutput(const PointerT& root) {
+    std::ostringstream captured;
+    std::streambuf* const cout_buffer = std::cout.rdbuf(captured.rdbuf());
+    PrintBT(root);
+    std::cout.rdbuf(cout_buffer);
+    return captured.str();
+}
+
+template <typename PointerT>
+std::string RenderToString(const PointerT& root, const RenderLimits& limits = {}) {
+    std::ostringstream rendered;
+    RenderBT(root, rendered, limits);
+    return rendered.str();
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+std::vector<int> SortedValues(int size) {
+    std::vector<int> values(size);
+    for (int i = 0; i < size; ++i) {
+        values[i] = i;
+    }
+    return values;
+}
+
+int main() {
+    {
+        std::vector<int> test_vector{6, 2, 1, 4, 3, 7, 2, 5, 1, 6, 8};
+        std::unique_ptr<Node<int>> max_tree_root = ConstructMaxTree(test_vector);
+        RenderBT(max_tree_root, std::cout);
+        std::cout << "With max_depth = 2:" << std::endl;
+        RenderBT(max_tree_root, STDOUT_FILENO, {.max_depth = 2});
+        std::cout << "With max_nodes = 4:" << std::endl;
+        RenderBT(max_tree_root, std::cout, {.max_nodes = 4});
+        std::cout << std::endl;
+    }
+
+    // Byte-identical output to PrintBT, for random (with ties), sorted and reverse sorted
+    // inputs, and for a non-integer value type
+    std::mt19937 rng(12345);
+    for (int trial = 0; trial < 300; ++trial) {
+        std::vector<int> values(trial);
+        std::uniform_int_distribution<int> value_dist(-50, 50);
+        for (int& value : values) {
+            value = value_dist(rng);
+        }
+        if (trial % 3 == 1) {
+            std::sort(values.begin(), values.end());
+        } else if (trial % 3 == 2) {
+            std::sort(values.rbegin(), values.rend());
+        }
+        std::unique_ptr<Node<int>> root = ConstructMaxTree(values);
+        std::vector<double> double_values;
+        for (const int value : values) {
+            double_values.push_back(value / 7.0);
+        }
+        std::unique_ptr<Node<double>> double_root = ConstructMaxTree(double_values);
+        if ((RenderToString(root) != CaptureOriginalOutput(root)) ||
+                (RenderToString(double_root.get()) != CaptureOriginalOutput(double_root.get()))) {
+            std::cout << "MISMATCH for input of " << trial << " values" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Random and sorted inputs of up to 300 values: output is byte-identical to "
+              << "PrintBT" << std::endl << std::endl;
+
+    const int kBalancedSize = 1'000'000;
+    std::vector<int> random_values(kBalancedSize);
+    std::uniform_int_distribution<int> value_dist(0, 1'000'000'000);
+    for (int& value : random_values) {
+        value = value_dist(rng);
+    }
+    std::ofstream null_stream("/dev/null");
+    const int null_fd = ::open("/dev/null", O_WRONLY);
+    if (!null_stream || (null_fd < 0)) {
+        std::cout << "Could not open /dev/null" << std::endl;
+        return 1;
+    }
+    std::cout << "Benchmark: printing to /dev/null" << std::endl;
+    for (const int path_size : {0, 2'000, 10'000}) {
+        std::unique_ptr<Node<int>> root =
+                ConstructMaxTree((path_size == 0) ? random_values : SortedValues(path_size));
+        const std::string tree_name = (path_size == 0)
+                ? "Max tree of " + std::to_string(kBalancedSize) + " random values"
+                : "Path of " + std::to_string(path_size) + " nodes";
+        std::streambuf* const cout_buffer = std::cout.rdbuf(null_stream.rdbuf());
+        const double original_seconds = TimeSeconds([&]() {
+            PrintBT(root);
+        });
+        std::cout.rdbuf(cout_buffer);
+        const double stream_seconds = TimeSeconds([&]() {
+            RenderBT(root, null_stream);
+        });
+        const double fd_seconds = TimeSeconds([&]() {
+            RenderBT(root, null_fd);
+        });
+        std::cout << "    " << tree_name << ": PrintBT " << original_seconds << " s, RenderBT "
+                  << "to ostream " << stream_seconds << " s, to file descriptor " << fd_seconds
+                  << " s" << std::endl;
+        DestroyTree(std::move(root));
+    }
+
+    // Too deep for PrintBT's recursion, and too much output to print whole
+    const int kPathSize = 1'000'000;
+    std::unique_ptr<Node<int>> path_root = ConstructMaxTree(SortedValues(kPathSize));
+    bool printed_everything = true;
+    const double depth_limited_seconds = TimeSeconds([&]() {
+        printed_everything = RenderBT(path_root, null_fd, {.max_depth = 5'000});
+    });
+    std::cout << "    Path of " << kPathSize << " nodes, max_depth = 5000: "
+              << depth_limited_seconds << " s" << (printed_everything ? "" : " (truncated)")
+              << std::endl;
+    const double node_limited_seconds = TimeSeconds([&]() {
+        printed_everything = RenderBT(path_root, null_fd, {.max_nodes = 5'000});
+    });
+    std::cout << "    Path of " << kPathSize << " nodes, max_nodes = 5000: "
+              << node_limited_seconds << " s" << (printed_everything ? "" : " (truncated)")
+              << std::endl;
+    DestroyTree(std::move(path_root));
+    ::close(null_fd);
+
+    return 0;
+}
@@ -0,0 +1,595 @@
+/* Traversal iterators for the BinaryTree of iterative_binary_tree_traversals.cpp.
+ *
+ * PreorderTraversal, InorderTraversal and PostorderTraversal copy the whole tree into a new
+ * vector, and their stacks are vectors that grow as they go, so every traversal allocates
+ * several times.  Usually we just want to visit the nodes.
+ *
+ * The iterators here visit the nodes in the same orders without copying anything.  They
+ * yield references to the values, and can be used with range-for and standard algorithms:
+ *     for (const int& value : tree.Inorder()) { ... }
+ *     std::find(tree.Preorder().begin(), tree.Preorder().end(), 42);
+ * Each iterator keeps its own stack of the nodes it will come back to, and that stack never
+ * holds more than one node per level of the tree.  BinaryTree::insert always builds a complete
+ * tree, whose height is less than 64 for any size that fits in memory, so the first 64 entries
+ * of the stack are a fixed-size array inside the iterator: iterating such a tree never
+ * allocates.  Deeper (unbalanced) trees still work, with the rest of the stack spilling into a
+ * vector.  Copying an iterator gives an independent iterator at the same position (so they
+ * are forward iterators).
+ *   - Preorder: the stack holds the right children still to be visited.
+ *   - Inorder: the stack holds the ancestors whose left subtree we are in (plus the current
+ *     node, on top), which are exactly the nodes still to be visited on the way back up.
+ *   - Postorder: the stack holds the path from the root to the current node.  After a left
+ *     child, its parent's right subtree comes next (starting from its first node in
+ *     postorder); after a right child (or an only child), the parent itself.
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Counts heap allocations, to show which traversals allocate
+size_t g_num_allocations = 0;
+
+void* operator new(size_t size) {
+    ++g_num_allocations;
+    if (void* ptr = std::malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /* size */) noexcept {
+    std::free(ptr);
+}
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const std::vector<T>& v) {
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i];
+        if (i + 1 < v.size()) os << ", ";
+    }
+    os << "]";
+    return os;
+}
+
+template <typename T>
+struct Node {
+    std::unique_ptr<Node<T>> left_child_ptr;
+    std::unique_ptr<Node<T>> right_child_ptr;
+    Node<T>* parent_ptr_raw;
+    T value;
+};
+
+// Stack of node pointers with room for one node per level of a complete tree inside the
+// object; anything deeper than kInlineCapacity levels goes into a vector
+template <typename T>
+class NodeStack {
+  public:
+    static constexpr size_t kInlineCapacity = 64;
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    void push(const Node<T>* node_ptr) {
+        if (_size < kInlineCapacity) {
+            _node_ptrs[_size] = node_ptr;
+        } else {
+            _overflow_node_ptrs.push_back(node_ptr);
+        }
+        ++_size;
+    }
+
+    const Node<T>* pop() {
+        const Node<T>* node_ptr = top();
+        if (_size > kInlineCapacity) {
+            _overflow_node_ptrs.pop_back();
+        }
+        --_size;
+        return node_ptr;
+    }
+
+    const Node<T>* top() const {
+        if (_size == 0) {
+            throw std::out_of_range("NodeStack is empty");
+        }
+        return (_size <= kInlineCapacity) ? _node_ptrs[_size - 1] : _overflow_node_ptrs.back();
+    }
+
+  private:
+    std::array<const Node<T>*, kInlineCapacity> _node_ptrs;
+    std::vector<const Node<T>*> _overflow_node_ptrs;
+    size_t _size = 0;
+};
+
+// Shared by the three iterators: Derived provides Advance(), and the current node is
+// _node_ptr (nullptr at the end).  Iterating doesn't allocate as long as the tree is at most
+// NodeStack<T>::kInlineCapacity (64) levels deep; past that, the stack allocates as it grows
+template <typename T, typename Derived>
+class TraversalIteratorBase {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    reference operator*() const {
+        return _node_ptr->value;
+    }
+
+    pointer operator->() const {
+        return &_node_ptr->value;
+    }
+
+    Derived& operator++() {
+        static_cast<Derived*>(this)->Advance();
+        return *static_cast<Derived*>(this);
+    }
+
+    Derived operator++(int) {
+        Derived previous = *static_cast<Derived*>(this);
+        ++*this;
+        return previous;
+    }
+
+    // Two iterators over the same tree are at the same position iff they're at the same node
+    friend bool operator==(const Derived& a, const Derived& b) {
+        return a._node_ptr == b._node_ptr;
+    }
+
+  protected:
+    const Node<T>* _node_ptr = nullptr;
+    NodeStack<T> _stack;
+};
+
+template <typename T>
+class PreorderIterator : public TraversalIteratorBase<T, PreorderIterator<T>> {
+  public:
+    PreorderIterator() {}
+
+    explicit PreorderIterator(const Node<T>* root_ptr) {
+        this->_node_ptr = root_ptr;
+    }
+
+    void Advance() {
+        const Node<T>* node_ptr = this->_node_ptr;
+        if (node_ptr->left_child_ptr != nullptr) {
+            if (node_ptr->right_child_ptr != nullptr) {
+                this->_stack.push(node_ptr->right_child_ptr.get());
+            }
+            this->_node_ptr = node_ptr->left_child_ptr.get();
+        } else if (node_ptr->right_child_ptr != nullptr) {
+            this->_node_ptr = node_ptr->right_child_ptr.get();
+        } else {
+            this->_node_ptr = this->_stack.empty() ? nullptr : this->_stack.pop();
+        }
+    }
+};
+
+template <typename T>
+class InorderIterator : public TraversalIteratorBase<T, InorderIterator<T>> {
+  public:
+    InorderIterator() {}
+
+    explicit InorderIterator(const Node<T>* root_ptr) {
+        PushLeftPath(root_ptr);
+    }
+
+    void Advance() {
+        const Node<T>* node_ptr = this->_stack.pop();
+        PushLeftPath(node_ptr->right_child_ptr.get());
+    }
+
+  private:
+    // Pushes node_ptr and its chain of left children, then moves to the top of the stack
+    void PushLeftPath(const Node<T>* node_ptr) {
+        for (; node_ptr != nullptr; node_ptr = node_ptr->left_child_ptr.get()) {
+            this->_stack.push(node_ptr);
+        }
+        this->_node_ptr = this->_stack.empty() ? nullptr : this->_stack.top();
+    }
+};
+
+template <typename T>
+class PostorderIterator : public TraversalIteratorBase<T, PostorderIterator<T>> {
+  public:
+    PostorderIterator() {}
+
+    explicit PostorderIterator(const Node<T>* root_ptr) {
+        if (root_ptr != nullptr) {
+            PushFirstPath(root_ptr);
+        }
+    }
+
+    void Advance() {
+        const Node<T>* child_ptr = this->_stack.pop();
+        if (this->_stack.empty()) {
+            this->_node_ptr = nullptr;
+            return;
+        }
+        const Node<T>* parent_ptr = this->_stack.top();
+        if ((child_ptr == parent_ptr->left_child_ptr.get()) &&
+                (parent_ptr->right_child_ptr != nullptr)) {
+            PushFirstPath(parent_ptr->right_child_ptr.get());
+        } else {
+            this->_node_ptr = parent_ptr;
+        }
+    }
+
+  private:
+    // Pushes the path from node_ptr down to the first node of its subtree in postorder
+    // (going left when possible, otherwise right), and moves to that node
+    void PushFirstPath(const Node<T>* node_ptr) {
+        while (true) {
+            this->_stack.push(node_ptr);
+            if (node_ptr->left_child_ptr != nullptr) {
+                node_ptr = node_ptr->left_child_ptr.get();
+            } else if (node_ptr->right_child_ptr != nullptr) {
+                node_ptr = node_ptr->right_child_ptr.get();
+            } else {
+                break;
+            }
+        }
+        this->_node_ptr = node_ptr;
+    }
+};
+
+static_assert(std::forward_iterator<PreorderIterator<int>>);
+static_assert(std::forward_iterator<InorderIterator<int>>);
+static_assert(std::forward_iterator<PostorderIterator<int>>);
+
+// begin() and end() for range-for, over a tree of any shape (allocation-free up to 64 levels
+// deep, see NodeStack)
+template <typename Iterator>
+class TraversalRange {
+  public:
+    template <typename T>
+    explicit TraversalRange(const Node<T>* root_ptr) : _begin(root_ptr) {}
+
+    Iterator begin() const {
+        return _begin;
+    }
+
+    Iterator end() const {
+        return Iterator();
+    }
+
+  private:
+    Iterator _begin;
+};
+
+// Copy of BinaryTree from iterative_binary_tree_traversals.cpp (the traversal functions are
+// kept as the reference for correctness checks and benchmarking), with Preorder(), Inorder()
+// and Postorder() added
+template <typename T>
+class BinaryTree {
+  public:
+    BinaryTree() {}
+
+    // Simple insert: inserts value at next available node to make complete tree
+    void insert(const T& value) {
+        std::vector<Node<T>*> path_to_inserted_node = FindNthNodePath(_size + 1);
+        path_to_inserted_node.back()->value = value;
+    }
+
+    size_t size() {
+        return _size;
+    }
+
+    // Iterable views of the traversals, which don't copy or allocate anything
+    TraversalRange<PreorderIterator<T>> Preorder() const {
+        return TraversalRange<PreorderIterator<T>>(_root.get());
+    }
+
+    TraversalRange<InorderIterator<T>> Inorder() const {
+        return TraversalRange<InorderIterator<T>>(_root.get());
+    }
+
+    TraversalRange<PostorderIterator<T>> Postorder() const {
+        return TraversalRange<PostorderIterator<T>>(_root.get());
+    }
+
+    std::vector<T> PreorderTraversal() {
+        if (_root == nullptr) {
+            return {};
+        }
+        std::vector<T> traversal_vector;
+        std::vector<Node<T>*> frontier{_root.get()};
+        while (frontier.size() > 0) {
+            Node<T>* current_node_ptr = frontier.back();
+            frontier.pop_back();
+            traversal_vector.emplace_back(current_node_ptr->value);
+            if (current_node_ptr->right_child_ptr != nullptr) {
+                frontier.push_back(current_node_ptr->right_child_ptr.get());
+            }
+            if (current_node_ptr->left_child_ptr != nullptr) {
+                frontier.push_back(current_node_ptr->left_child_ptr.get());
+            }
+        }
+        return traversal_vector;
+    }
+
+    std::vector<T> PostorderTraversal() {
+        if (_root == nullptr) {
+            return {};
+        }
+        enum class NextAction { kTraverse, kVisit };
+        using NodeActionPair = std::pair<Node<T>*, NextAction>;
+        std::vector<T> traversal_vector;
+        std::vector<NodeActionPair> node_action_stack{
+                std::make_pair(_root.get(), NextAction::kTraverse)};
+        while (node_action_stack.size() > 0) {
+            auto [current_node_ptr, next_action] = node_action_stack.back();
+            node_action_stack.pop_back();
+            if (next_action == NextAction::kVisit) {
+                traversal_vector.emplace_back(current_node_ptr->value);
+            } else {  // next_action == NextAction::kTraverse
+                node_action_stack.emplace_back(current_node_ptr, NextAction::kVisit);
+                if (current_node_ptr->right_child_ptr != nullptr) {
+                    node_action_stack.emplace_back(
+                            current_node_ptr->right_child_ptr.get(),
+                            NextAction::kTraverse);
+                }
+                if (current_node_ptr->left_child_ptr != nullptr) {
+                    node_action_stack.emplace_back(
+                            current_node_ptr->left_child_ptr.get(),
+                            NextAction::kTraverse);
+                }
+            }
+        }
+        return traversal_vector;
+    }
+
+    std::vector<T> InorderTraversal() {
+        if (_root == nullptr) {
+            return {};
+        }
+        enum class Action { kEnter, kVisit };
+        using NodeActionPair = std::pair<Node<T>*, Action>;
+        std::vector<T> traversal_vector;
+        std::vector<NodeActionPair> node_action_stack{
+                std::make_pair(_root.get(), Action::kEnter)};
+        while (node_action_stack.size() > 0) {
+            auto [current_node_ptr, action] = node_action_stack.back();
+            node_action_stack.pop_back();
+            if (action == Action::kVisit) {
+                traversal_vector.emplace_back(current_node_ptr->value);
+            } else {  // action == Action::kEnter
+                if (current_node_ptr->right_child_ptr != nullptr) {
+                    node_action_stack.emplace_back(
+                            current_node_ptr->right_child_ptr.get(),
+                            Action::kEnter);
+                }
+                node_action_stack.emplace_back(current_node_ptr, Action::kVisit);
+                if (current_node_ptr->left_child_ptr != nullptr) {
+                    node_action_stack.emplace_back(
+                            current_node_ptr->left_child_ptr.get(),
+                            Action::kEnter);
+                }
+            }
+        }
+        return traversal_vector;
+    }
+
+  private:
+    // Retrieve the nth node in the tree assuming the tree is complete,
+    // inserting a new node if it does not exist (and any nodes along the path).
+    // Return a vector of the nodes along the path from route to the nth node.
+    // Note: n is 1-indexed here, as it makes the math easier!
+    std::vector<Node<T>*> FindNthNodePath(size_t n) {
+        size_t modulus = 1;
+        while (n / modulus > 1) {
+            modulus *= 2;
+        }
+        std::vector<Node<T>*> path_vector;
+        Node<T>* current_node_ptr = _root.get();
+        if (_root == nullptr) {
+            _root = std::make_unique<Node<T>>();
+            ++_size;
+            current_node_ptr = _root.get();
+        }
+        path_vector.push_back(current_node_ptr);
+        for (/* modulus */; modulus > 1; modulus /= 2) {
+            if ((n % modulus) < (modulus / 2)) {  // left
+                if (current_node_ptr->left_child_ptr == nullptr) {
+                    current_node_ptr->left_child_ptr = std::make_unique<Node<T>>();
+                    ++_size;
+                }
+                current_node_ptr = current_node_ptr->left_child_ptr.get();
+            } else {  // right
+                if (current_node_ptr->right_child_ptr == nullptr) {
+                    current_node_ptr->right_child_ptr = std::make_unique<Node<T>>();
+                    ++_size;
+                }
+                current_node_ptr = current_node_ptr->right_child_ptr.get();
+            }
+            path_vector.push_back(current_node_ptr);
+        }
+        return path_vector;
+    }
+
+    std::unique_ptr<Node<T>> _root;
+    size_t _size = 0;
+};
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+// Sums the values of a traversal, both by the vector-returning function and by iterating, and
+// prints the time and number of allocations of each
+template <typename VectorFunc, typename Range>
+bool CompareTraversals(const std::string& name, VectorFunc&& vector_func, const Range& range) {
+    long long vector_sum = 0;
+    size_t vector_allocations = g_num_allocations;
+    const double vector_seconds = TimeSeconds([&]() {
+        const std::vector<int> traversal = vector_func();
+        vector_sum = std::accumulate(traversal.begin(), traversal.end(), 0LL);
+    });
+    vector_allocations = g_num_allocations - vector_allocations;
+    long long iterator_sum = 0;
+    size_t iterator_allocations = g_num_allocations;
+    const double iterator_seconds = TimeSeconds([&]() {
+        iterator_sum = std::accumulate(range.begin(), range.end(), 0LL);
+    });
+    iterator_allocations = g_num_allocations - iterator_allocations;
+    std::cout << "    " << name << ": vector " << vector_seconds << " s, "
+              << vector_allocations << " allocations; iterator " << iterator_seconds << " s, "
+              << iterator_allocations << " allocations; speedup "
+              << vector_seconds / iterator_seconds << "x, "
+              << (vector_sum == iterator_sum ? "sums match" : "MISMATCH") << std::endl;
+    return vector_sum == iterator_sum;
+}
+
+// Recursive traversal, as a reference for trees that BinaryTree can't build
+enum class Order { kPreorder, kInorder, kPostorder };
+
+template <typename T>
+void TraverseRecursive(const Node<T>* node_ptr, Order order, std::vector<T>& traversal) {
+    if (node_ptr == nullptr) {
+        return;
+    }
+    if (order == Order::kPreorder) traversal.push_back(node_ptr->value);
+    TraverseRecursive(node_ptr->left_child_ptr.get(), order, traversal);
+    if (order == Order::kInorder) traversal.push_back(node_ptr->value);
+    TraverseRecursive(node_ptr->right_child_ptr.get(), order, traversal);
+    if (order == Order::kPostorder) traversal.push_back(node_ptr->value);
+}
+
+// A spine of depth nodes going left (or right), each with a leaf hanging off its other side,
+// so the stacks of all three iterators grow to about depth entries
+std::unique_ptr<Node<int>> MakeSpineTree(int depth, bool left_spine) {
+    std::unique_ptr<Node<int>> root;
+    for (int level = depth - 1; level >= 0; --level) {
+        auto spine_node = std::make_unique<Node<int>>();
+        spine_node->value = 2 * level;
+        auto leaf = std::make_unique<Node<int>>();
+        leaf->value = 2 * level + 1;
+        if (left_spine) {
+            spine_node->left_child_ptr = std::move(root);
+            spine_node->right_child_ptr = std::move(leaf);
+        } else {
+            spine_node->left_child_ptr = std::move(leaf);
+            spine_node->right_child_ptr = std::move(root);
+        }
+        root = std::move(spine_node);
+    }
+    return root;
+}
+
+int main() {
+    std::vector<int> test_values{
+            1,
+            9, 3,
+            12, 50, 100, 5,
+            13, 16, 51, 200, 101, 102, 6, 999};
+
+    BinaryTree<int> test_tree;
+    for (const int value : test_values) {
+        test_tree.insert(value);
+    }
+    std::cout << "Preorder: ";
+    for (const int& value : test_tree.Preorder()) {
+        std::cout << value << " ";
+    }
+    std::cout << std::endl << "Inorder: ";
+    for (const int& value : test_tree.Inorder()) {
+        std::cout << value << " ";
+    }
+    std::cout << std::endl << "Postorder: ";
+    for (const int& value : test_tree.Postorder()) {
+        std::cout << value << " ";
+    }
+    std::cout << std::endl;
+    const auto postorder = test_tree.Postorder();
+    const auto found = std::find(postorder.begin(), postorder.end(), 100);
+    std::cout << "In postorder, 100 is followed by " << *std::next(found) << ", and "
+              << std::count_if(postorder.begin(), postorder.end(),
+                               [](int value) { return value > 50; })
+              << " values are greater than 50" << std::endl << std::endl;
+
+    // Every size of tree up to 300 nodes must iterate exactly like the traversal functions,
+    // and copies of iterators must continue independently
+    BinaryTree<int> tree;
+    for (int size = 0; size <= 300; ++size) {
+        const std::vector<int> preorder(tree.Preorder().begin(), tree.Preorder().end());
+        const std::vector<int> inorder(tree.Inorder().begin(), tree.Inorder().end());
+        const std::vector<int> postorder(tree.Postorder().begin(), tree.Postorder().end());
+        if ((preorder != tree.PreorderTraversal()) || (inorder != tree.InorderTraversal()) ||
+                (postorder != tree.PostorderTraversal())) {
+            std::cout << "MISMATCH for tree of " << size << " nodes" << std::endl;
+            return 1;
+        }
+        auto it = tree.Inorder().begin();
+        std::advance(it, size / 2);
+        const auto copy = it;
+        std::advance(it, (size + 1) / 2);
+        if ((it != tree.Inorder().end()) ||
+                (std::vector<int>(copy, it) != std::vector<int>(inorder.begin() + size / 2,
+                                                                inorder.end()))) {
+            std::cout << "ITERATOR COPY MISMATCH for tree of " << size << " nodes" << std::endl;
+            return 1;
+        }
+        tree.insert(1000 + size);
+    }
+    std::cout << "Trees of 0 to 300 nodes: iterators match the traversal functions"
+              << std::endl;
+
+    // Trees deeper than the stack's inline capacity must spill over instead of overflowing
+    for (const bool left_spine : {true, false}) {
+        const int depth = 3 * static_cast<int>(NodeStack<int>::kInlineCapacity);
+        const std::unique_ptr<Node<int>> spine_root = MakeSpineTree(depth, left_spine);
+        std::vector<int> expected[3];
+        for (const Order order : {Order::kPreorder, Order::kInorder, Order::kPostorder}) {
+            TraverseRecursive(spine_root.get(), order, expected[static_cast<int>(order)]);
+        }
+        const TraversalRange<PreorderIterator<int>> preorder(spine_root.get());
+        const TraversalRange<InorderIterator<int>> inorder(spine_root.get());
+        const TraversalRange<PostorderIterator<int>> postorder(spine_root.get());
+        if ((std::vector<int>(preorder.begin(), preorder.end()) != expected[0]) ||
+                (std::vector<int>(inorder.begin(), inorder.end()) != expected[1]) ||
+                (std::vector<int>(postorder.begin(), postorder.end()) != expected[2])) {
+            std::cout << "MISMATCH for " << (left_spine ? "left" : "right") << " spine of depth "
+                      << depth << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Spines " << 3 * NodeStack<int>::kInlineCapacity
+              << " levels deep: iterators match the recursive traversals" << std::endl
+              << std::endl;
+
+    const size_t kSize = 10'000'000;
+    BinaryTree<int> big_tree;
+    for (size_t i = 0; i < kSize; ++i) {
+        big_tree.insert(static_cast<int>(i));
+    }
+    std::cout << "Benchmark: sum of " << kSize << " node values" << std::endl;
+    const bool results_match =
+            CompareTraversals("Preorder ", [&]() { return big_tree.PreorderTraversal(); },
+                              big_tree.Preorder()) &&
+            CompareTraversals("Inorder  ", [&]() { return big_tree.InorderTraversal(); },
+                              big_tree.Inorder()) &&
+            CompareTraversals("Postorder", [&]() { return big_tree.PostorderTraversal(); },
+                              big_tree.Postorder());
+    return results_match ? 0 : 1;
+}
@@ -0,0 +1,562 @@
+/* Traversals with O(1) extra space (besides the output): with parent pointers, and without
+ * them (Morris traversals).
+ *
+ * With parent pointers: we can always get back up, so we never need a stack.  We only need
+ * to know which way we arrived at the current node, which comparing the previous node with
+ * the current node's parent and left child tells us:
+ *   - from the parent: we're entering the node.  Go to its left child, or if it has none, its
+ *     right child, or if it has none either, back up to its parent.
+ *   - from the left child: the left subtree is done.  Go to the right child if there is one,
+ *     otherwise back up.
+ *   - from the right child: both subtrees are done.  Go back up.
+ * This is the same walk for all three orders.  Only the point where we visit the node
+ * differs: preorder on entering it, inorder once its left subtree is done, and postorder once
+ * both subtrees are done.  (Missing children count as done immediately.)
+ *
+ * Without parent pointers (Morris): before descending into a node's left subtree, we make
+ * the rightmost node of that subtree (the node's inorder predecessor, whose right child is
+ * always null) point back to the node.  That "thread" is how we get back up once the left
+ * subtree is done, and when we follow it we find the predecessor's right child pointing at
+ * the node, which tells us the left subtree is done; then we remove the thread.  Each edge is
+ * walked a constant number of times, so it's still O(n).  The tree is modified during the
+ * traversal, and restored by the end of it.
+ *
+ * Child pointers are unique_ptrs here, so a thread is an owning pointer to an ancestor,
+ * created with reset() and always removed with release() before the traversal returns.  If
+ * the visitor throws, the threads that are still in place are released on the way out, so the
+ * tree never ends up with two owners of a node.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const std::vector<T>& v) {
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i];
+        if (i + 1 < v.size()) os << ", ";
+    }
+    os << "]";
+    return os;
+}
+
+template <typename T>
+struct Node {
+    std::unique_ptr<Node<T>> left_child_ptr;
+    std::unique_ptr<Node<T>> right_child_ptr;
+    Node<T>* parent_ptr_raw;
+    T value;
+};
+
+enum class TraversalOrder { kPreorder, kInorder, kPostorder };
+
+// Stackless traversal using parent pointers (which must be set for every node, with nullptr
+// for the root).  Calls visit(value) for each node in the given order.
+template <TraversalOrder kOrder, typename T, typename Visitor>
+void VisitWithParentPointers(const Node<T>* root_ptr, Visitor&& visit) {
+    const Node<T>* previous_ptr = nullptr;
+    const Node<T>* current_ptr = root_ptr;
+    while (current_ptr != nullptr) {
+        const Node<T>* left_ptr = current_ptr->left_child_ptr.get();
+        const Node<T>* right_ptr = current_ptr->right_child_ptr.get();
+        const Node<T>* parent_ptr = current_ptr->parent_ptr_raw;
+        // Where we go once the left subtree is done
+        const auto after_left = [&]() {
+            if (kOrder == TraversalOrder::kInorder) {
+                visit(current_ptr->value);
+            }
+            if (right_ptr != nullptr) {
+                return right_ptr;
+            }
+            if (kOrder == TraversalOrder::kPostorder) {
+                visit(current_ptr->value);
+            }
+            return parent_ptr;
+        };
+        const Node<T>* next_ptr;
+        // Entering: previous_ptr starts out null, which is also the root's parent
+        if (previous_ptr == parent_ptr) {
+            if (kOrder == TraversalOrder::kPreorder) {
+                visit(current_ptr->value);
+            }
+            next_ptr = (left_ptr != nullptr) ? left_ptr : after_left();
+        } else if (previous_ptr == left_ptr) {  // back up from the left subtree
+            next_ptr = after_left();
+        } else {  // back up from the right subtree
+            if (kOrder == TraversalOrder::kPostorder) {
+                visit(current_ptr->value);
+            }
+            next_ptr = parent_ptr;
+        }
+        previous_ptr = current_ptr;
+        current_ptr = next_ptr;
+    }
+}
+
+// Inorder predecessor of a node with a left child: rightmost node of the left subtree,
+// stopping at a Morris thread back to the node
+template <typename T>
+Node<T>* MorrisPredecessor(Node<T>* node_ptr) {
+    Node<T>* predecessor_ptr = node_ptr->left_child_ptr.get();
+    while ((predecessor_ptr->right_child_ptr != nullptr) &&
+            (predecessor_ptr->right_child_ptr.get() != node_ptr)) {
+        predecessor_ptr = predecessor_ptr->right_child_ptr.get();
+    }
+    return predecessor_ptr;
+}
+
+// Releases the Morris threads still in place when a traversal stops at current_ptr.  Those
+// belong to the ancestors of current_ptr whose left subtree it's in, so we walk down to it
+// from the root: into the left subtree where there's a thread (releasing it), and into the
+// right subtree otherwise.
+template <typename T>
+void RemoveMorrisThreads(Node<T>* root_ptr, const Node<T>* current_ptr) {
+    Node<T>* node_ptr = root_ptr;
+    while ((node_ptr != nullptr) && (node_ptr != current_ptr)) {
+        if (node_ptr->left_child_ptr != nullptr) {
+            Node<T>* predecessor_ptr = MorrisPredecessor(node_ptr);
+            if (predecessor_ptr->right_child_ptr != nullptr) {
+                predecessor_ptr->right_child_ptr.release();
+                node_ptr = node_ptr->left_child_ptr.get();
+                continue;
+            }
+        }
+        node_ptr = node_ptr->right_child_ptr.get();
+    }
+}
+
+// Morris traversal without parent pointers, in preorder or inorder.  Temporarily modifies the
+// tree (see the top of the file).  Calls visit(value) for each node.
+template <TraversalOrder kOrder, typename T, typename Visitor>
+void VisitMorris(Node<T>* root_ptr, Visitor&& visit) {
+    static_assert(kOrder != TraversalOrder::kPostorder,
+                  "Morris postorder needs to reverse paths, which unique_ptr links don't allow");
+    Node<T>* current_ptr = root_ptr;
+    try {
+        while (current_ptr != nullptr) {
+            if (current_ptr->left_child_ptr == nullptr) {
+                visit(current_ptr->value);
+                current_ptr = current_ptr->right_child_ptr.get();
+                continue;
+            }
+            Node<T>* predecessor_ptr = MorrisPredecessor(current_ptr);
+            if (predecessor_ptr->right_child_ptr == nullptr) {
+                // First time here: thread the predecessor back to us, then do the left subtree
+                if (kOrder == TraversalOrder::kPreorder) {
+                    visit(current_ptr->value);
+                }
+                predecessor_ptr->right_child_ptr.reset(current_ptr);
+                current_ptr = current_ptr->left_child_ptr.get();
+            } else {
+                // Back up the thread: the left subtree is done
+                predecessor_ptr->right_child_ptr.release();
+                if (kOrder == TraversalOrder::kInorder) {
+                    visit(current_ptr->value);
+                }
+                current_ptr = current_ptr->right_child_ptr.get();
+            }
+        }
+    } catch (...) {
+        // visit threw at current_ptr: don't leave the threads (second owners) in the tree
+        RemoveMorrisThreads(root_ptr, current_ptr);
+        throw;
+    }
+}
+
+// Copies of the stack-based traversals from iterative_binary_tree_traversals.cpp, calling
+// visit(value) instead of appending to a vector, kept here as the reference for correctness
+// checks and benchmarking
+template <TraversalOrder kOrder, typename T, typename Visitor>
+void VisitWithStack(const Node<T>* root_ptr, Visitor&& visit) {
+    if (root_ptr == nullptr) {
+        return;
+    }
+    if (kOrder == TraversalOrder::kPreorder) {
+        std::vector<const Node<T>*> frontier{root_ptr};
+        while (frontier.size() > 0) {
+            const Node<T>* current_node_ptr = frontier.back();
+            frontier.pop_back();
+            visit(current_node_ptr->value);
+            if (current_node_ptr->right_child_ptr != nullptr) {
+                frontier.push_back(current_node_ptr->right_child_ptr.get());
+            }
+            if (current_node_ptr->left_child_ptr != nullptr) {
+                frontier.push_back(current_node_ptr->left_child_ptr.get());
+            }
+        }
+        return;
+    }
+    enum class Action { kEnter, kVisit };
+    using NodeActionPair = std::pair<const Node<T>*, Action>;
+    std::vector<NodeActionPair> node_action_stack{std::make_pair(root_ptr, Action::kEnter)};
+    while (node_action_stack.size() > 0) {
+        auto [current_node_ptr, action] = node_action_stack.back();
+        node_action_stack.pop_back();
+        if (action == Action::kVisit) {
+            visit(current_node_ptr->value);
+        } else {  // action == Action::kEnter
+            if (kOrder == TraversalOrder::kPostorder) {
+                node_action_stack.emplace_back(current_node_ptr, Action::kVisit);
+            }
+            if (current_node_ptr->right_child_ptr != nullptr) {
+                node_action_stack.emplace_back(current_node_ptr->right_child_ptr.get(),
+                                               Action::kEnter);
+            }
+            if (kOrder == TraversalOrder::kInorder) {
+                node_action_stack.emplace_back(current_node_ptr, Action::kVisit);
+            }
+            if (current_node_ptr->left_child_ptr != nullptr) {
+                node_action_stack.emplace_back(current_node_ptr->left_child_ptr.get(),
+                                               Action::kEnter);
+            }
+        }
+    }
+}
+
+// Deletes a tree one node at a time, since destroying a deep tree through its unique_ptrs
+// would recurse once per level and overflow the stack
+template <typename T>
+void DestroyTree(std::unique_ptr<Node<T>> root_ptr) {
+    std::vector<std::unique_ptr<Node<T>>> pending;
+    if (root_ptr != nullptr) {
+        pending.push_back(std::move(root_ptr));
+    }
+    while (!pending.empty()) {
+        std::unique_ptr<Node<T>> node_ptr = std::move(pending.back());
+        pending.pop_back();
+        if (node_ptr->left_child_ptr != nullptr) {
+            pending.push_back(std::move(node_ptr->left_child_ptr));
+        }
+        if (node_ptr->right_child_ptr != nullptr) {
+            pending.push_back(std::move(node_ptr->right_child_ptr));
+        }
+    }
+}
+
+// BinaryTree from iterative_binary_tree_traversals.cpp, with parent pointers set on insert,
+// and the traversals above.  The traversals return vectors, like the original ones.
+template <typename T>
+class BinaryTree {
+  public:
+    BinaryTree() {}
+
+    ~BinaryTree() {
+        DestroyTree(std::move(_root));
+    }
+
+    // Simple insert: inserts value at next available node to make complete tree
+    void insert(const T& value) {
+        std::vector<Node<T>*> path_to_inserted_node = FindNthNodePath(_size + 1);
+        path_to_inserted_node.back()->value = value;
+    }
+
+    size_t size() {
+        return _size;
+    }
+
+    // Stack-based, as in iterative_binary_tree_traversals.cpp
+    template <TraversalOrder kOrder>
+    std::vector<T> TraversalWithStack() const {
+        std::vector<T> traversal_vector;
+        VisitWithStack<kOrder>(_root.get(),
+                               [&](const T& value) { traversal_vector.push_back(value); });
+        return traversal_vector;
+    }
+
+    template <TraversalOrder kOrder>
+    std::vector<T> TraversalWithParentPointers() const {
+        std::vector<T> traversal_vector;
+        VisitWithParentPointers<kOrder>(
+                _root.get(), [&](const T& value) { traversal_vector.push_back(value); });
+        return traversal_vector;
+    }
+
+    // Preorder or inorder only
+    template <TraversalOrder kOrder>
+    std::vector<T> MorrisTraversal() {
+        std::vector<T> traversal_vector;
+        VisitMorris<kOrder>(_root.get(),
+                            [&](const T& value) { traversal_vector.push_back(value); });
+        return traversal_vector;
+    }
+
+  private:
+    // Retrieve the nth node in the tree assuming the tree is complete,
+    // inserting a new node if it does not exist (and any nodes along the path).
+    // Return a vector of the nodes along the path from route to the nth node.
+    // Note: n is 1-indexed here, as it makes the math easier!
+    std::vector<Node<T>*> FindNthNodePath(size_t n) {
+        size_t modulus = 1;
+        while (n / modulus > 1) {
+            modulus *= 2;
+        }
+        std::vector<Node<T>*> path_vector;
+        Node<T>* current_node_ptr = _root.get();
+        if (_root == nullptr) {
+            _root = std::make_unique<Node<T>>();
+            _root->parent_ptr_raw = nullptr;
+            ++_size;
+            current_node_ptr = _root.get();
+        }
+        path_vector.push_back(current_node_ptr);
+        for (/* modulus */; modulus > 1; modulus /= 2) {
+            if ((n % modulus) < (modulus / 2)) {  // left
+                if (current_node_ptr->left_child_ptr == nullptr) {
+                    current_node_ptr->left_child_ptr = std::make_unique<Node<T>>();
+                    current_node_ptr->left_child_ptr->parent_ptr_raw = current_node_ptr;
+                    ++_size;
+                }
+                current_node_ptr = current_node_ptr->left_child_ptr.get();
+            } else {  // right
+                if (current_node_ptr->right_child_ptr == nullptr) {
+                    current_node_ptr->right_child_ptr = std::make_unique<Node<T>>();
+                    current_node_ptr->right_child_ptr->parent_ptr_raw = current_node_ptr;
+                    ++_size;
+                }
+                current_node_ptr = current_node_ptr->right_child_ptr.get();
+            }
+            path_vector.push_back(current_node_ptr);
+        }
+        return path_vector;
+    }
+
+    std::unique_ptr<Node<T>> _root;
+    size_t _size = 0;
+};
+
+// Root of the BST built by inserting values in order, with parent pointers
+std::unique_ptr<Node<int>> MakeBst(const std::vector<int>& values) {
+    std::unique_ptr<Node<int>> root_ptr;
+    for (const int value : values) {
+        std::unique_ptr<Node<int>>* link_ptr = &root_ptr;
+        Node<int>* parent_ptr = nullptr;
+        while (*link_ptr != nullptr) {
+            parent_ptr = link_ptr->get();
+            link_ptr = (value < parent_ptr->value) ? &parent_ptr->left_child_ptr
+                                                   : &parent_ptr->right_child_ptr;
+        }
+        *link_ptr = std::make_unique<Node<int>>();
+        (*link_ptr)->parent_ptr_raw = parent_ptr;
+        (*link_ptr)->value = value;
+    }
+    return root_ptr;
+}
+
+// Chain of n nodes (values 0..n-1 from the top), with parent pointers: each node is the left
+// child of the one above it if go_left(depth) is true, otherwise the right child
+template <typename GoLeft>
+std::unique_ptr<Node<int>> MakeChain(int n, GoLeft&& go_left) {
+    std::unique_ptr<Node<int>> root_ptr;
+    std::unique_ptr<Node<int>>* link_ptr = &root_ptr;
+    Node<int>* parent_ptr = nullptr;
+    for (int depth = 0; depth < n; ++depth) {
+        *link_ptr = std::make_unique<Node<int>>();
+        (*link_ptr)->parent_ptr_raw = parent_ptr;
+        (*link_ptr)->value = depth;
+        parent_ptr = link_ptr->get();
+        link_ptr = go_left(depth) ? &parent_ptr->left_child_ptr : &parent_ptr->right_child_ptr;
+    }
+    return root_ptr;
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+// Checksums of all the traversals of a tree must match the stack-based ones.  Returns false
+// on a mismatch.
+template <TraversalOrder kOrder>
+bool CheckTraversals(Node<int>* root_ptr) {
+    std::vector<int> with_stack;
+    VisitWithStack<kOrder>(root_ptr, [&](int value) { with_stack.push_back(value); });
+    std::vector<int> with_parents;
+    VisitWithParentPointers<kOrder>(root_ptr, [&](int value) { with_parents.push_back(value); });
+    if (with_parents != with_stack) {
+        return false;
+    }
+    if constexpr (kOrder != TraversalOrder::kPostorder) {
+        std::vector<int> morris;
+        VisitMorris<kOrder>(root_ptr, [&](int value) { morris.push_back(value); });
+        std::vector<int> after_morris;
+        VisitWithStack<kOrder>(root_ptr, [&](int value) { after_morris.push_back(value); });
+        if ((morris != with_stack) || (after_morris != with_stack)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Whether every child link in the tree points to a node whose parent pointer points back, so
+// there are no Morris threads left (a thread would point to an ancestor)
+bool LinksMatchParents(const Node<int>* root_ptr) {
+    std::vector<const Node<int>*> frontier;
+    if (root_ptr != nullptr) {
+        frontier.push_back(root_ptr);
+    }
+    while (!frontier.empty()) {
+        const Node<int>* node_ptr = frontier.back();
+        frontier.pop_back();
+        for (const Node<int>* child_ptr :
+                {node_ptr->left_child_ptr.get(), node_ptr->right_child_ptr.get()}) {
+            if (child_ptr != nullptr) {
+                if (child_ptr->parent_ptr_raw != node_ptr) {
+                    return false;
+                }
+                frontier.push_back(child_ptr);
+            }
+        }
+    }
+    return true;
+}
+
+// A Morris traversal whose visitor throws on its num_visits-th visit must leave the tree as it
+// was.  Returns false otherwise.
+template <TraversalOrder kOrder>
+bool CheckMorrisThrowing(Node<int>* root_ptr, size_t num_visits) {
+    size_t visit_count = 0;
+    try {
+        VisitMorris<kOrder>(root_ptr, [&](int) {
+            if (++visit_count == num_visits) {
+                throw std::runtime_error("visitor failed");
+            }
+        });
+    } catch (const std::runtime_error&) {
+    }
+    return LinksMatchParents(root_ptr) && CheckTraversals<kOrder>(root_ptr);
+}
+
+// Times one traversal order on one tree, with each method
+template <TraversalOrder kOrder>
+void RunBenchmark(const std::string& order_name, Node<int>* root_ptr) {
+    unsigned long long stack_checksum = 0;
+    const double stack_seconds = TimeSeconds([&]() {
+        VisitWithStack<kOrder>(root_ptr, [&](int value) {
+            stack_checksum = stack_checksum * 31 + value;
+        });
+    });
+    unsigned long long parents_checksum = 0;
+    const double parents_seconds = TimeSeconds([&]() {
+        VisitWithParentPointers<kOrder>(root_ptr, [&](int value) {
+            parents_checksum = parents_checksum * 31 + value;
+        });
+    });
+    std::cout << "        " << order_name << ": stack " << stack_seconds << " s, parent pointers "
+              << parents_seconds << " s";
+    bool results_match = (parents_checksum == stack_checksum);
+    if constexpr (kOrder != TraversalOrder::kPostorder) {
+        unsigned long long morris_checksum = 0;
+        const double morris_seconds = TimeSeconds([&]() {
+            VisitMorris<kOrder>(root_ptr, [&](int value) {
+                morris_checksum = morris_checksum * 31 + value;
+            });
+        });
+        std::cout << ", Morris " << morris_seconds << " s";
+        results_match = results_match && (morris_checksum == stack_checksum);
+    }
+    std::cout << (results_match ? ", results match" : ", MISMATCH") << std::endl;
+}
+
+int main() {
+    std::vector<int> test_values{
+            1,
+            9, 3,
+            12, 50, 100, 5,
+            13, 16, 51, 200, 101, 102, 6, 999};
+
+    BinaryTree<int> test_tree;
+    for (const int value : test_values) {
+        test_tree.insert(value);
+    }
+    std::cout << "Preorder with parent pointers:  "
+              << test_tree.TraversalWithParentPointers<TraversalOrder::kPreorder>() << std::endl;
+    std::cout << "Inorder with parent pointers:   "
+              << test_tree.TraversalWithParentPointers<TraversalOrder::kInorder>() << std::endl;
+    std::cout << "Postorder with parent pointers: "
+              << test_tree.TraversalWithParentPointers<TraversalOrder::kPostorder>() << std::endl;
+    std::cout << "Morris preorder:                "
+              << test_tree.MorrisTraversal<TraversalOrder::kPreorder>() << std::endl;
+    std::cout << "Morris inorder:                 "
+              << test_tree.MorrisTraversal<TraversalOrder::kInorder>() << std::endl;
+    std::cout << std::endl;
+
+    // Complete trees of every size up to 200, and random BSTs (which have nodes with one child
+    // on either side) must traverse exactly like the stack-based traversals
+    BinaryTree<int> complete_tree;
+    for (int size = 0; size <= 200; ++size) {
+        if ((complete_tree.TraversalWithParentPointers<TraversalOrder::kPreorder>() !=
+             complete_tree.TraversalWithStack<TraversalOrder::kPreorder>()) ||
+                (complete_tree.TraversalWithParentPointers<TraversalOrder::kInorder>() !=
+                 complete_tree.TraversalWithStack<TraversalOrder::kInorder>()) ||
+                (complete_tree.TraversalWithParentPointers<TraversalOrder::kPostorder>() !=
+                 complete_tree.TraversalWithStack<TraversalOrder::kPostorder>()) ||
+                (complete_tree.MorrisTraversal<TraversalOrder::kPreorder>() !=
+                 complete_tree.TraversalWithStack<TraversalOrder::kPreorder>()) ||
+                (complete_tree.MorrisTraversal<TraversalOrder::kInorder>() !=
+                 complete_tree.TraversalWithStack<TraversalOrder::kInorder>())) {
+            std::cout << "MISMATCH for complete tree of " << size << " nodes" << std::endl;
+            return 1;
+        }
+        complete_tree.insert(1000 + size);
+    }
+    std::mt19937 rng(12345);
+    for (int trial = 0; trial < 1000; ++trial) {
+        std::vector<int> values(trial % 60);
+        std::uniform_int_distribution<int> value_dist(0, 1 + trial % 100);
+        for (int& value : values) {
+            value = value_dist(rng);
+        }
+        std::unique_ptr<Node<int>> root_ptr = MakeBst(values);
+        if (!CheckTraversals<TraversalOrder::kPreorder>(root_ptr.get()) ||
+                !CheckTraversals<TraversalOrder::kInorder>(root_ptr.get()) ||
+                !CheckTraversals<TraversalOrder::kPostorder>(root_ptr.get())) {
+            std::cout << "MISMATCH for BST built from " << values << std::endl;
+            return 1;
+        }
+        for (size_t num_visits = 1; num_visits <= values.size(); ++num_visits) {
+            if (!CheckMorrisThrowing<TraversalOrder::kPreorder>(root_ptr.get(), num_visits) ||
+                    !CheckMorrisThrowing<TraversalOrder::kInorder>(root_ptr.get(), num_visits)) {
+                std::cout << "Tree not restored after a visitor threw on visit " << num_visits
+                          << ", for BST built from " << values << std::endl;
+                return 1;
+            }
+        }
+    }
+    std::cout << "Complete trees and random BSTs: all traversals match the stack-based ones, "
+              << "and Morris traversals restore the tree when the visitor throws" << std::endl
+              << std::endl;
+
+    const int kSize = 2'000'000;
+    std::vector<int> shuffled_values(kSize);
+    for (int i = 0; i < kSize; ++i) {
+        shuffled_values[i] = i;
+    }
+    std::shuffle(shuffled_values.begin(), shuffled_values.end(), rng);
+    std::vector<std::pair<std::string, std::unique_ptr<Node<int>>>> trees;
+    trees.emplace_back("Random BST", MakeBst(shuffled_values));
+    trees.emplace_back("Right chain (height n)", MakeChain(kSize, [](int) { return false; }));
+    trees.emplace_back("Left chain (height n)", MakeChain(kSize, [](int) { return true; }));
+    trees.emplace_back("Zigzag chain (height n)",
+                       MakeChain(kSize, [](int depth) { return depth % 2 == 0; }));
+    std::cout << "Benchmark: trees of " << kSize << " nodes" << std::endl;
+    for (auto& [name, root_ptr] : trees) {
+        std::cout << "    " << name << ":" << std::endl;
+        RunBenchmark<TraversalOrder::kPreorder>("Preorder ", root_ptr.get());
+        RunBenchmark<TraversalOrder::kInorder>("Inorder  ", root_ptr.get());
+        RunBenchmark<TraversalOrder::kPostorder>("Postorder", root_ptr.get());
+        DestroyTree(std::move(root_ptr));
+    }
+
+    return 0;
+}
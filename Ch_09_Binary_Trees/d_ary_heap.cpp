@@ -0,0 +1,406 @@
+/* An array-backed version of the min-heap that BinaryTree in
+ * iterative_binary_tree_traversals.cpp implements with linked nodes (push/top/pop).
+ *
+ * As in implicit_binary_tree.cpp, the tree is complete, so it is stored in level order in one
+ * array.  Here every node can have kArity children instead of 2: the children of index i are
+ * at kArity * i + 1 through kArity * i + kArity, and its parent is at (i - 1) / kArity.
+ *   - push appends the value and sifts it up: O(log_d n) comparisons.
+ *   - pop takes out the top, leaving a hole, and fills it with the last value.  Sifting the
+ *     last value down from the top would compare it against every level's smallest child,
+ *     but it came from the bottom, so it almost always belongs near the bottom.  So the hole
+ *     is moved all the way down to a leaf first (choosing the smallest of the kArity children
+ *     at each level), and the last value is sifted up from there, usually by a step or two.
+ *     This is what std::pop_heap does too.  O(d log_d n) comparisons.
+ *   - heapify sifts down every internal node from the last one up, so each sift only has to
+ *     fix a subtree whose children are already heaps: O(n) in total.
+ * A bigger arity makes the tree shallower, and a node's children sit next to each other in
+ * memory (4 or 8 ints are only 16 or 32 bytes), so the extra comparisons in pop are cheap next
+ * to the cache misses saved by having fewer levels.
+ *
+ * Sifting moves a "hole" instead of swapping: the value being sifted is held aside while the
+ * values it passes move one step, and it is written once at the end.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Min-heap: top() is the smallest value according to Compare
+template <typename T, size_t kArity = 2, typename Compare = std::less<T>>
+class DAryHeap {
+    static_assert(kArity >= 2, "Heap arity must be at least 2");
+
+  public:
+    DAryHeap() {}
+
+    // Builds a heap of the given values in O(n)
+    explicit DAryHeap(std::vector<T> values) {
+        heapify(std::move(values));
+    }
+
+    // Replaces the contents of the heap with the given values, in O(n)
+    void heapify(std::vector<T> values) {
+        _values = std::move(values);
+        if (_values.size() < 2) {
+            return;
+        }
+        for (size_t i = Parent(_values.size() - 1) + 1; i-- > 0;) {
+            SiftDown(i);
+        }
+    }
+
+    void push(const T& value) {
+        _values.push_back(value);
+        SiftUp(_values.size() - 1);
+    }
+
+    // Return by value, because if it's empty we still need to return something
+    T top() const {
+        if (_values.empty()) {
+            return T{};
+        }
+        return _values[0];
+    }
+
+    // Removes and returns the top value (T{} if the heap is empty, as for top)
+    T pop() {
+        if (_values.empty()) {
+            return T{};
+        }
+        T top_value = std::move(_values[0]);
+        T last_value = std::move(_values.back());
+        _values.pop_back();
+        if (!_values.empty()) {
+            // The last value came from the bottom, so it almost always belongs near the
+            // bottom again: move the hole all the way down without comparing against it, then
+            // sift it up from there
+            const size_t hole = MoveHoleToLeaf(0);
+            _values[hole] = std::move(last_value);
+            SiftUp(hole);
+        }
+        return top_value;
+    }
+
+    bool is_empty() const {
+        return _values.empty();
+    }
+
+    size_t size() const {
+        return _values.size();
+    }
+
+    void reserve(size_t capacity) {
+        _values.reserve(capacity);
+    }
+
+    // Whether every node is no smaller than its parent (for testing)
+    bool IsHeap() const {
+        for (size_t i = 1; i < _values.size(); ++i) {
+            if (_compare(_values[i], _values[Parent(i)])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+  private:
+    static size_t Parent(size_t i) {
+        return (i - 1) / kArity;
+    }
+
+    static size_t FirstChild(size_t i) {
+        return kArity * i + 1;
+    }
+
+    void SiftUp(size_t i) {
+        T value = std::move(_values[i]);
+        while (i > 0) {
+            const size_t parent = Parent(i);
+            if (!_compare(value, _values[parent])) {
+                break;
+            }
+            _values[i] = std::move(_values[parent]);
+            i = parent;
+        }
+        _values[i] = std::move(value);
+    }
+
+    // Index of the smallest child of i, which must have at least one child
+    size_t SmallestChild(size_t i) const {
+        const size_t first_child = FirstChild(i);
+        const size_t end_child = std::min(first_child + kArity, _values.size());
+        if (end_child == first_child + kArity) {
+            // All children present: a fixed-length loop the compiler can unroll
+            return SmallestInRange(first_child, first_child + kArity);
+        }
+        return SmallestInRange(first_child, end_child);
+    }
+
+    // Index of the smallest value in _values[begin, end).  For trivially copyable values,
+    // keeping the smallest value so far in a local (rather than re-reading it through its
+    // index) lets the compiler use conditional moves instead of hard-to-predict branches.
+    // Other values (e.g. strings) would be copied on every comparison, so they're compared
+    // through the index.
+    size_t SmallestInRange(size_t begin, size_t end) const {
+        size_t smallest_index = begin;
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            T smallest_value = _values[begin];
+            for (size_t index = begin + 1; index < end; ++index) {
+                const bool is_smaller = _compare(_values[index], smallest_value);
+                smallest_index = is_smaller ? index : smallest_index;
+                smallest_value = is_smaller ? _values[index] : smallest_value;
+            }
+        } else {
+            for (size_t index = begin + 1; index < end; ++index) {
+                if (_compare(_values[index], _values[smallest_index])) {
+                    smallest_index = index;
+                }
+            }
+        }
+        return smallest_index;
+    }
+
+    void SiftDown(size_t i) {
+        const size_t n = _values.size();
+        T value = std::move(_values[i]);
+        while (FirstChild(i) < n) {
+            const size_t smallest_child = SmallestChild(i);
+            if (!_compare(_values[smallest_child], value)) {
+                break;
+            }
+            _values[i] = std::move(_values[smallest_child]);
+            i = smallest_child;
+        }
+        _values[i] = std::move(value);
+    }
+
+    // Moves the hole at i down to a leaf, always filling it from the smallest child, and
+    // returns where the hole ends up
+    size_t MoveHoleToLeaf(size_t i) {
+        const size_t n = _values.size();
+        while (FirstChild(i) < n) {
+            const size_t smallest_child = SmallestChild(i);
+            _values[i] = std::move(_values[smallest_child]);
+            i = smallest_child;
+        }
+        return i;
+    }
+
+    std::vector<T> _values;
+    Compare _compare;
+};
+
+// std::priority_queue with the same interface as DAryHeap, for comparison
+template <typename T>
+class StdPriorityQueue {
+  public:
+    StdPriorityQueue() {}
+
+    void heapify(std::vector<T> values) {
+        _queue = Queue(std::greater<T>(), std::move(values));
+    }
+
+    void push(const T& value) {
+        _queue.push(value);
+    }
+
+    T top() const {
+        return _queue.empty() ? T{} : _queue.top();
+    }
+
+    T pop() {
+        if (_queue.empty()) {
+            return T{};
+        }
+        T top_value = _queue.top();
+        _queue.pop();
+        return top_value;
+    }
+
+    bool is_empty() const {
+        return _queue.empty();
+    }
+
+    size_t size() const {
+        return _queue.size();
+    }
+
+  private:
+    using Queue = std::priority_queue<T, std::vector<T>, std::greater<T>>;
+    Queue _queue;
+};
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+// Times three workloads on one heap type, and returns a checksum of everything popped:
+//   - push all the values one by one, then pop them all
+//   - heapify all the values at once, then pop them all
+//   - "hold" (as in event simulation or Dijkstra's algorithm): starting from a heap of
+//     hold_size values, repeatedly pop the smallest value and push it back plus a random
+//     increment
+template <typename Heap>
+uint64_t RunBenchmark(const std::string& name, const std::vector<int>& values,
+                      size_t hold_size, const std::vector<int>& increments) {
+    uint64_t checksum = 0;
+    Heap push_pop_heap;
+    const double push_seconds = TimeSeconds([&]() {
+        for (const int value : values) {
+            push_pop_heap.push(value);
+        }
+    });
+    const double push_pop_seconds = push_seconds + TimeSeconds([&]() {
+        while (!push_pop_heap.is_empty()) {
+            checksum = checksum * 31 + push_pop_heap.pop();
+        }
+    });
+    Heap heapify_heap;
+    const double heapify_seconds = TimeSeconds([&]() {
+        heapify_heap.heapify(values);
+    });
+    const double heapify_pop_seconds = heapify_seconds + TimeSeconds([&]() {
+        while (!heapify_heap.is_empty()) {
+            checksum = checksum * 31 + heapify_heap.pop();
+        }
+    });
+    Heap hold_heap;
+    hold_heap.heapify(std::vector<int>(values.begin(), values.begin() + hold_size));
+    const double hold_seconds = TimeSeconds([&]() {
+        for (const int increment : increments) {
+            const int value = hold_heap.pop();
+            checksum = checksum * 31 + value;
+            hold_heap.push(value + increment);
+        }
+    });
+    std::cout << "    " << name << ": push " << push_seconds << " s, push + pop all "
+              << push_pop_seconds << " s, heapify " << heapify_seconds
+              << " s, heapify + pop all " << heapify_pop_seconds << " s, hold "
+              << hold_seconds << " s" << std::endl;
+    return checksum;
+}
+
+// Test values of type T: ints, or their decimal strings (which order differently)
+template <typename T>
+T TestValue(int value) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return std::to_string(value);
+    } else {
+        return value;
+    }
+}
+
+// Random pushes and pops on one heap type must pop the same values as std::priority_queue
+template <typename Heap, typename T = int>
+bool MatchesPriorityQueue(std::mt19937& rng) {
+    for (int trial = 0; trial < 200; ++trial) {
+        std::uniform_int_distribution<int> value_dist(0, 1 + trial);
+        std::vector<T> initial_values(trial % 50);
+        for (T& value : initial_values) {
+            value = TestValue<T>(value_dist(rng));
+        }
+        Heap heap(initial_values);
+        StdPriorityQueue<T> reference;
+        reference.heapify(initial_values);
+        if (!heap.IsHeap()) {
+            return false;
+        }
+        for (int step = 0; step < 500; ++step) {
+            if (rng() % 3 == 0) {
+                if ((heap.pop() != reference.pop()) || (heap.size() != reference.size())) {
+                    return false;
+                }
+            } else {
+                const T value = TestValue<T>(value_dist(rng));
+                heap.push(value);
+                reference.push(value);
+            }
+            if (heap.top() != reference.top()) {
+                return false;
+            }
+        }
+        if (!heap.IsHeap()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    std::vector<int> test_values{50, 13, 999, 9, 100, 1, 16, 5, 51, 200, 12, 101, 3, 102, 6};
+    DAryHeap<int> test_heap;
+    for (const int value : test_values) {
+        test_heap.push(value);
+    }
+    std::cout << "Binary heap pops:";
+    while (!test_heap.is_empty()) {
+        std::cout << " " << test_heap.pop();
+    }
+    std::cout << std::endl;
+    DAryHeap<int, 4> test_heap_4(test_values);
+    std::cout << "4-ary heapified heap pops:";
+    while (!test_heap_4.is_empty()) {
+        std::cout << " " << test_heap_4.pop();
+    }
+    std::cout << std::endl << std::endl;
+
+    std::mt19937 rng(12345);
+    if (!MatchesPriorityQueue<DAryHeap<int, 2>>(rng) ||
+            !MatchesPriorityQueue<DAryHeap<int, 3>>(rng) ||
+            !MatchesPriorityQueue<DAryHeap<int, 4>>(rng) ||
+            !MatchesPriorityQueue<DAryHeap<int, 8>>(rng) ||
+            !MatchesPriorityQueue<DAryHeap<std::string, 2>, std::string>(rng) ||
+            !MatchesPriorityQueue<DAryHeap<std::string, 4>, std::string>(rng)) {
+        std::cout << "MISMATCH against std::priority_queue" << std::endl;
+        return 1;
+    }
+    std::cout << "Random pushes and pops: arities 2, 3, 4 and 8 (and 2 and 4 for strings) "
+              << "match std::priority_queue" << std::endl << std::endl;
+
+    // Once the heap no longer fits in cache, every level of a pop is a cache miss, so the
+    // shallower trees help less than the number of levels suggests
+    for (const size_t size : {1'000'000, 10'000'000}) {
+        const size_t hold_size = size / 10;
+        std::vector<int> values(size);
+        std::uniform_int_distribution<int> value_dist(0, 1'000'000'000);
+        for (int& value : values) {
+            value = value_dist(rng);
+        }
+        std::vector<int> increments(size);
+        std::uniform_int_distribution<int> increment_dist(0, 1'000'000);
+        for (int& increment : increments) {
+            increment = increment_dist(rng);
+        }
+        std::cout << "Benchmark: " << size << " random ints, hold with " << hold_size
+                  << " values and " << size << " pop + push steps" << std::endl;
+        const uint64_t reference_checksum = RunBenchmark<StdPriorityQueue<int>>(
+                "std::priority_queue", values, hold_size, increments);
+        const uint64_t checksum_2 = RunBenchmark<DAryHeap<int, 2>>(
+                "Arity 2            ", values, hold_size, increments);
+        const uint64_t checksum_4 = RunBenchmark<DAryHeap<int, 4>>(
+                "Arity 4            ", values, hold_size, increments);
+        const uint64_t checksum_8 = RunBenchmark<DAryHeap<int, 8>>(
+                "Arity 8            ", values, hold_size, increments);
+        const bool results_match = (checksum_2 == reference_checksum) &&
+                                   (checksum_4 == reference_checksum) &&
+                                   (checksum_8 == reference_checksum);
+        std::cout << "    " << (results_match ? "Results match" : "MISMATCH") << std::endl
+                  << std::endl;
+        if (!results_match) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,533 @@
+/* A reusable version of the recursive-to-iterative translation in
+ * recursive_iterative_translation.cpp.
+ *
+ * foo_iterative turns each call into a frame on an explicit stack, and each point where the
+ * function continues after a call into a resume point (the NextLine enum).  The
+ * PostorderTraversal and InorderTraversal action stacks in iterative_binary_tree_traversals.cpp
+ * do the same thing by hand, and so would any other recursive function we translated.
+ *
+ * ExplicitStack does the bookkeeping once.  We describe the function with:
+ *   - a frame type: its arguments, the locals it needs after a call, and its resume point
+ *   - a step function, which runs a frame from its resume point to its next call or return
+ * and ExplicitStack runs the frames on one contiguous vector, instead of the native call
+ * stack.  The vector is kept between runs, so once it has grown to the deepest recursion,
+ * calls never allocate, and the depth is only limited by memory.
+ *
+ * Unlike foo_iterative, the caller's frame stays on the stack under its callee, instead of
+ * being popped and pushed back with its next line, and return values are handed straight to
+ * the caller instead of going through a separate stack.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Counts heap allocations, to show which versions allocate
+size_t g_num_allocations = 0;
+
+void* operator new(size_t size) {
+    ++g_num_allocations;
+    if (void* ptr = std::malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /* size */) noexcept {
+    std::free(ptr);
+}
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const std::vector<T>& v) {
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i];
+        if (i + 1 < v.size()) os << ", ";
+    }
+    os << "]";
+    return os;
+}
+
+// Runs a recursive function, described by a frame type and a step function, on an explicit
+// stack.  Run calls step(frame, stack) on the top frame until the stack is empty.  Each step
+// must end with exactly one of:
+//   - stack.Call(callee_frame): runs the callee, then calls step on this frame again, where
+//     stack.returned() is the callee's result (so set this frame's resume point first)
+//   - stack.TailCall(next_frame): replaces this frame, whose result is next_frame's result
+//   - stack.Return(result), or stack.Return() if Result is void: this frame is finished
+// These may move the frames, so step must not use its frame reference after them.
+template <typename Frame, typename Result = void>
+class ExplicitStack {
+  public:
+    explicit ExplicitStack(size_t initial_capacity = 1024) {
+        _frames.reserve(initial_capacity);
+    }
+
+    template <typename Step>
+    Result Run(const Frame& root_frame, Step&& step) {
+        _frames.clear();
+        _frames.push_back(root_frame);
+        while (!_frames.empty()) {
+            step(_frames.back(), *this);
+        }
+        if constexpr (!std::is_void_v<Result>) {
+            return std::move(_returned);
+        }
+    }
+
+    void Call(const Frame& callee_frame) {
+        _frames.push_back(callee_frame);
+    }
+
+    void TailCall(const Frame& next_frame) {
+        _frames.back() = next_frame;
+    }
+
+    void Return() requires std::is_void_v<Result> {
+        _frames.pop_back();
+    }
+
+    template <typename R = Result>
+    void Return(R&& result) requires (!std::is_void_v<Result>) {
+        _returned = std::forward<R>(result);
+        _frames.pop_back();
+    }
+
+    // Result of the last call that finished
+    const auto& returned() const requires (!std::is_void_v<Result>) {
+        return _returned;
+    }
+
+    // Deepest recursion the stack can hold without allocating
+    size_t capacity() const {
+        return _frames.capacity();
+    }
+
+  private:
+    std::vector<Frame> _frames;
+    std::conditional_t<std::is_void_v<Result>, std::monostate, Result> _returned{};
+};
+
+// foo_recursive from recursive_iterative_translation.cpp without the tracing output, kept
+// here as the reference for correctness checks and benchmarking
+int foo_recursive(int value) {
+    if (value < 10) {
+        return value;
+    }
+    const int a = foo_recursive(value / 2);
+    const int b = foo_recursive(value - 3);
+    return a + b;
+}
+
+// foo_iterative from recursive_iterative_translation.cpp without the tracing output (and
+// taking the popped frame by value, since a reference to it would dangle), kept here as the
+// reference for correctness checks and benchmarking
+int foo_iterative(int input_value) {
+    enum class NextLine { Start, A, B, C };
+    std::vector<std::pair<int, NextLine>> call_stack;
+    call_stack.emplace_back(input_value, NextLine::Start);
+    std::vector<int> return_value_stack;
+    while (!call_stack.empty()) {
+        const auto [value, next_line] = call_stack.back();
+        call_stack.pop_back();
+        if (next_line == NextLine::Start) {
+            if (value < 10) {
+                return_value_stack.push_back(value);
+            } else {
+                call_stack.emplace_back(value, NextLine::A);
+            }
+        } else if (next_line == NextLine::A) {
+            call_stack.emplace_back(value, NextLine::B);
+            call_stack.emplace_back(value / 2, NextLine::Start);
+        } else if (next_line == NextLine::B) {
+            call_stack.emplace_back(value, NextLine::C);
+            call_stack.emplace_back(value - 3, NextLine::Start);
+        } else if (next_line == NextLine::C) {
+            const int b = return_value_stack.back();
+            return_value_stack.pop_back();
+            const int a = return_value_stack.back();
+            return_value_stack.pop_back();
+            return_value_stack.push_back(a + b);
+        }
+    }
+    return return_value_stack.back();
+}
+
+// foo on ExplicitStack.  Line A follows Start directly, so it doesn't need a resume point.
+struct FooFrame {
+    enum class NextLine { Start, B, C };
+
+    int value;
+    NextLine next_line;
+    int a;  // result of the first call, needed after the second one
+};
+
+int foo_engine(int input_value, ExplicitStack<FooFrame, int>& stack) {
+    using NextLine = FooFrame::NextLine;
+    return stack.Run({input_value, NextLine::Start, 0}, [](FooFrame& frame, auto& stack) {
+        switch (frame.next_line) {
+            case NextLine::Start:
+                if (frame.value < 10) {
+                    stack.Return(frame.value);
+                    return;
+                }
+                frame.next_line = NextLine::B;
+                stack.Call({frame.value / 2, NextLine::Start, 0});
+                return;
+            case NextLine::B:
+                frame.a = stack.returned();
+                frame.next_line = NextLine::C;
+                stack.Call({frame.value - 3, NextLine::Start, 0});
+                return;
+            case NextLine::C:
+                stack.Return(frame.a + stack.returned());
+                return;
+        }
+    });
+}
+
+template <typename T>
+struct Node {
+    std::unique_ptr<Node<T>> left_child_ptr;
+    std::unique_ptr<Node<T>> right_child_ptr;
+    Node<T>* parent_ptr_raw;
+    T value;
+};
+
+// Copies of PostorderTraversalR, PostorderTraversal and InorderTraversal from
+// iterative_binary_tree_traversals.cpp, taking the root, kept here as the reference for
+// correctness checks and benchmarking
+
+template <typename T>
+void PostorderTraversalR(const Node<T>* current_node_ptr, std::vector<T>& traversal) {
+    if (current_node_ptr->left_child_ptr != nullptr) {
+        PostorderTraversalR(current_node_ptr->left_child_ptr.get(), traversal);
+    }
+    if (current_node_ptr->right_child_ptr != nullptr) {
+        PostorderTraversalR(current_node_ptr->right_child_ptr.get(), traversal);
+    }
+    traversal.push_back(current_node_ptr->value);
+}
+
+template <typename T>
+std::vector<T> PostorderTraversal(const Node<T>* root_ptr) {
+    if (root_ptr == nullptr) {
+        return {};
+    }
+    enum class NextAction { kTraverse, kVisit };
+    using NodeActionPair = std::pair<const Node<T>*, NextAction>;
+    std::vector<T> traversal_vector;
+    std::vector<NodeActionPair> node_action_stack{
+            std::make_pair(root_ptr, NextAction::kTraverse)};
+    while (node_action_stack.size() > 0) {
+        auto [current_node_ptr, next_action] = node_action_stack.back();
+        node_action_stack.pop_back();
+        if (next_action == NextAction::kVisit) {
+            traversal_vector.emplace_back(current_node_ptr->value);
+        } else {  // next_action == NextAction::kTraverse
+            node_action_stack.emplace_back(current_node_ptr, NextAction::kVisit);
+            if (current_node_ptr->right_child_ptr != nullptr) {
+                node_action_stack.emplace_back(
+                        current_node_ptr->right_child_ptr.get(),
+                        NextAction::kTraverse);
+            }
+            if (current_node_ptr->left_child_ptr != nullptr) {
+                node_action_stack.emplace_back(
+                        current_node_ptr->left_child_ptr.get(),
+                        NextAction::kTraverse);
+            }
+        }
+    }
+    return traversal_vector;
+}
+
+template <typename T>
+std::vector<T> InorderTraversal(const Node<T>* root_ptr) {
+    if (root_ptr == nullptr) {
+        return {};
+    }
+    enum class Action { kEnter, kVisit };
+    using NodeActionPair = std::pair<const Node<T>*, Action>;
+    std::vector<T> traversal_vector;
+    std::vector<NodeActionPair> node_action_stack{
+            std::make_pair(root_ptr, Action::kEnter)};
+    while (node_action_stack.size() > 0) {
+        auto [current_node_ptr, action] = node_action_stack.back();
+        node_action_stack.pop_back();
+        if (action == Action::kVisit) {
+            traversal_vector.emplace_back(current_node_ptr->value);
+        } else {  // action == Action::kEnter
+            if (current_node_ptr->right_child_ptr != nullptr) {
+                node_action_stack.emplace_back(
+                        current_node_ptr->right_child_ptr.get(),
+                        Action::kEnter);
+            }
+            node_action_stack.emplace_back(current_node_ptr, Action::kVisit);
+            if (current_node_ptr->left_child_ptr != nullptr) {
+                node_action_stack.emplace_back(
+                        current_node_ptr->left_child_ptr.get(),
+                        Action::kEnter);
+            }
+        }
+    }
+    return traversal_vector;
+}
+
+// Traversals on ExplicitStack: the frame is a node and where we are in it.  Null children
+// are skipped instead of called, like in the hand-written versions.
+template <typename T>
+struct TraversalFrame {
+    enum class NextLine { Start, AfterLeft, AfterRight };
+
+    const Node<T>* node_ptr;
+    NextLine next_line;
+};
+
+// Appends the values in postorder to traversal
+template <typename T>
+void PostorderTraversalEngine(const Node<T>* root_ptr, ExplicitStack<TraversalFrame<T>>& stack,
+                              std::vector<T>& traversal) {
+    using NextLine = typename TraversalFrame<T>::NextLine;
+    if (root_ptr == nullptr) {
+        return;
+    }
+    stack.Run({root_ptr, NextLine::Start}, [&](TraversalFrame<T>& frame, auto& stack) {
+        const Node<T>* node_ptr = frame.node_ptr;
+        switch (frame.next_line) {
+            case NextLine::Start:
+                if (node_ptr->left_child_ptr != nullptr) {
+                    frame.next_line = NextLine::AfterLeft;
+                    stack.Call({node_ptr->left_child_ptr.get(), NextLine::Start});
+                    return;
+                }
+                [[fallthrough]];
+            case NextLine::AfterLeft:
+                if (node_ptr->right_child_ptr != nullptr) {
+                    frame.next_line = NextLine::AfterRight;
+                    stack.Call({node_ptr->right_child_ptr.get(), NextLine::Start});
+                    return;
+                }
+                [[fallthrough]];
+            case NextLine::AfterRight:
+                traversal.push_back(node_ptr->value);
+                stack.Return();
+                return;
+        }
+    });
+}
+
+// Appends the values in inorder to traversal.  The right subtree is a tail call, so a chain
+// of right children only ever takes one frame.
+template <typename T>
+void InorderTraversalEngine(const Node<T>* root_ptr, ExplicitStack<TraversalFrame<T>>& stack,
+                            std::vector<T>& traversal) {
+    using NextLine = typename TraversalFrame<T>::NextLine;
+    if (root_ptr == nullptr) {
+        return;
+    }
+    stack.Run({root_ptr, NextLine::Start}, [&](TraversalFrame<T>& frame, auto& stack) {
+        const Node<T>* node_ptr = frame.node_ptr;
+        if ((frame.next_line == NextLine::Start) && (node_ptr->left_child_ptr != nullptr)) {
+            frame.next_line = NextLine::AfterLeft;
+            stack.Call({node_ptr->left_child_ptr.get(), NextLine::Start});
+            return;
+        }
+        traversal.push_back(node_ptr->value);
+        if (node_ptr->right_child_ptr != nullptr) {
+            stack.TailCall({node_ptr->right_child_ptr.get(), NextLine::Start});
+        } else {
+            stack.Return();
+        }
+    });
+}
+
+// Complete tree of values 0..size-1 in level order, built the same way as BinaryTree::insert
+std::unique_ptr<Node<int>> MakeCompleteTree(int size) {
+    std::vector<Node<int>*> nodes;
+    std::unique_ptr<Node<int>> root_ptr;
+    for (int i = 0; i < size; ++i) {
+        std::unique_ptr<Node<int>> node_ptr = std::make_unique<Node<int>>();
+        node_ptr->value = i;
+        nodes.push_back(node_ptr.get());
+        if (i == 0) {
+            root_ptr = std::move(node_ptr);
+        } else {
+            Node<int>* parent_ptr = nodes[(i - 1) / 2];
+            node_ptr->parent_ptr_raw = parent_ptr;
+            ((i % 2 == 1) ? parent_ptr->left_child_ptr : parent_ptr->right_child_ptr) =
+                    std::move(node_ptr);
+        }
+    }
+    return root_ptr;
+}
+
+// Chain of n nodes (values 0..n-1 from the top): each node is the left child of the one
+// above it if go_left(depth) is true, otherwise the right child
+template <typename GoLeft>
+std::unique_ptr<Node<int>> MakeChain(int n, GoLeft&& go_left) {
+    std::unique_ptr<Node<int>> root_ptr;
+    std::unique_ptr<Node<int>>* link_ptr = &root_ptr;
+    Node<int>* parent_ptr = nullptr;
+    for (int depth = 0; depth < n; ++depth) {
+        *link_ptr = std::make_unique<Node<int>>();
+        (*link_ptr)->parent_ptr_raw = parent_ptr;
+        (*link_ptr)->value = depth;
+        parent_ptr = link_ptr->get();
+        link_ptr = go_left(depth) ? &parent_ptr->left_child_ptr : &parent_ptr->right_child_ptr;
+    }
+    return root_ptr;
+}
+
+// Deletes a tree one node at a time, since destroying a deep tree through its unique_ptrs
+// would recurse once per level and overflow the stack
+template <typename T>
+void DestroyTree(std::unique_ptr<Node<T>> root_ptr) {
+    std::vector<std::unique_ptr<Node<T>>> pending;
+    if (root_ptr != nullptr) {
+        pending.push_back(std::move(root_ptr));
+    }
+    while (!pending.empty()) {
+        std::unique_ptr<Node<T>> node_ptr = std::move(pending.back());
+        pending.pop_back();
+        if (node_ptr->left_child_ptr != nullptr) {
+            pending.push_back(std::move(node_ptr->left_child_ptr));
+        }
+        if (node_ptr->right_child_ptr != nullptr) {
+            pending.push_back(std::move(node_ptr->right_child_ptr));
+        }
+    }
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+// Times func and counts its allocations, and prints both
+template <typename Func>
+void TimeAndCount(const std::string& name, Func&& func) {
+    const size_t allocations_before = g_num_allocations;
+    const double seconds = TimeSeconds(func);
+    std::cout << name << " " << seconds << " s (" << g_num_allocations - allocations_before
+              << " allocations)";
+}
+
+// Benchmarks the traversals of one tree: hand-written, on ExplicitStack (with the stack and
+// output already allocated by a previous run) and, if the tree isn't too deep, recursive
+void BenchmarkTraversals(const std::string& tree_name, const Node<int>* root_ptr, int size,
+                         bool run_recursive) {
+    ExplicitStack<TraversalFrame<int>> stack;
+    std::vector<int> engine_traversal;
+    engine_traversal.reserve(size);
+    PostorderTraversalEngine(root_ptr, stack, engine_traversal);
+    std::cout << "    " << tree_name << " (engine stack capacity after the first run: "
+              << stack.capacity() << " frames):" << std::endl;
+
+    std::vector<int> hand_written;
+    std::cout << "        Postorder: ";
+    TimeAndCount("hand-written", [&]() { hand_written = PostorderTraversal(root_ptr); });
+    engine_traversal.clear();
+    TimeAndCount(", engine", [&]() {
+        PostorderTraversalEngine(root_ptr, stack, engine_traversal);
+    });
+    bool results_match = (engine_traversal == hand_written);
+    if (run_recursive) {
+        std::vector<int> recursive_traversal;
+        recursive_traversal.reserve(size);
+        TimeAndCount(", recursive", [&]() {
+            PostorderTraversalR(root_ptr, recursive_traversal);
+        });
+        results_match = results_match && (recursive_traversal == hand_written);
+    }
+    std::cout << ", " << (results_match ? "results match" : "MISMATCH") << std::endl;
+
+    std::cout << "        Inorder:   ";
+    TimeAndCount("hand-written", [&]() { hand_written = InorderTraversal(root_ptr); });
+    engine_traversal.clear();
+    TimeAndCount(", engine", [&]() {
+        InorderTraversalEngine(root_ptr, stack, engine_traversal);
+    });
+    std::cout << ", " << (engine_traversal == hand_written ? "results match" : "MISMATCH")
+              << std::endl;
+}
+
+int main() {
+    ExplicitStack<FooFrame, int> foo_stack;
+    std::cout << "foo(20): recursive " << foo_recursive(20) << ", hand-written iterative "
+              << foo_iterative(20) << ", engine " << foo_engine(20, foo_stack) << std::endl;
+    std::unique_ptr<Node<int>> test_root = MakeCompleteTree(15);
+    ExplicitStack<TraversalFrame<int>> traversal_stack;
+    std::vector<int> test_traversal;
+    PostorderTraversalEngine(test_root.get(), traversal_stack, test_traversal);
+    std::cout << "Postorder of a complete tree of 0..14: " << test_traversal << std::endl;
+    test_traversal.clear();
+    InorderTraversalEngine(test_root.get(), traversal_stack, test_traversal);
+    std::cout << "Inorder of a complete tree of 0..14:   " << test_traversal << std::endl
+              << std::endl;
+
+    for (int value = -5; value <= 300; ++value) {
+        const int expected = foo_recursive(value);
+        if ((foo_iterative(value) != expected) || (foo_engine(value, foo_stack) != expected)) {
+            std::cout << "MISMATCH for foo(" << value << ")" << std::endl;
+            return 1;
+        }
+    }
+    for (int size = 0; size <= 200; ++size) {
+        std::unique_ptr<Node<int>> root_ptr = MakeCompleteTree(size);
+        std::vector<int> postorder;
+        PostorderTraversalEngine(root_ptr.get(), traversal_stack, postorder);
+        std::vector<int> inorder;
+        InorderTraversalEngine(root_ptr.get(), traversal_stack, inorder);
+        if ((postorder != PostorderTraversal(root_ptr.get())) ||
+                (inorder != InorderTraversal(root_ptr.get()))) {
+            std::cout << "MISMATCH for complete tree of " << size << " nodes" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "foo(-5..300) and traversals of complete trees of 0-200 nodes: engine "
+              << "versions match the hand-written ones" << std::endl << std::endl;
+
+    std::cout << "Benchmark:" << std::endl;
+    for (const int value : {600, 900}) {
+        std::cout << "    foo(" << value << "): ";
+        int recursive_result = 0;
+        int iterative_result = 0;
+        int engine_result = 0;
+        TimeAndCount("hand-written", [&]() { iterative_result = foo_iterative(value); });
+        TimeAndCount(", engine", [&]() { engine_result = foo_engine(value, foo_stack); });
+        TimeAndCount(", recursive", [&]() { recursive_result = foo_recursive(value); });
+        std::cout << ", "
+                  << ((engine_result == iterative_result) && (recursive_result == iterative_result)
+                              ? "results match" : "MISMATCH")
+                  << std::endl;
+    }
+
+    const int kTreeSize = 10'000'000;
+    std::unique_ptr<Node<int>> complete_root = MakeCompleteTree(kTreeSize);
+    BenchmarkTraversals("Complete tree of " + std::to_string(kTreeSize) + " nodes",
+                        complete_root.get(), kTreeSize, /*run_recursive=*/true);
+    DestroyTree(std::move(complete_root));
+
+    // Recursion this deep would overflow the native stack
+    const int kChainSize = 2'000'000;
+    std::unique_ptr<Node<int>> chain_root = MakeChain(kChainSize, [](int) { return true; });
+    BenchmarkTraversals("Left chain of " + std::to_string(kChainSize) + " nodes",
+                        chain_root.get(), kChainSize, /*run_recursive=*/false);
+    DestroyTree(std::move(chain_root));
+
+    return 0;
+}
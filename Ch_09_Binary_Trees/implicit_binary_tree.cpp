@@ -0,0 +1,411 @@
+/* Array-backed version of the complete BinaryTree from iterative_binary_tree_traversals.cpp.
+ *
+ * BinaryTree::insert only ever builds a complete tree, but each insert still walks down from
+ * the root (FindNthNodePath), builds a vector of the path, and allocates a node.  A complete
+ * tree doesn't need any of that: stored in level order in one array, the node at index i has
+ * its children at 2i + 1 and 2i + 2 and its parent at (i - 1) / 2.  So insert is just a
+ * push_back, and nodes don't need pointers at all.
+ *
+ * The index arithmetic also tells us everything a traversal needs to know about where it is
+ * (is this a left or a right child?  does it have a sibling?), so the traversals below walk
+ * the array without a stack: they only move to a child, parent or sibling index.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const std::vector<T>& v) {
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i];
+        if (i + 1 < v.size()) os << ", ";
+    }
+    os << "]";
+    return os;
+}
+
+// Copy of Node and BinaryTree from iterative_binary_tree_traversals.cpp, kept here as the
+// reference for correctness checks and benchmarking
+template <typename T>
+struct Node {
+    std::unique_ptr<Node<T>> left_child_ptr;
+    std::unique_ptr<Node<T>> right_child_ptr;
+    Node<T>* parent_ptr_raw;
+    T value;
+};
+
+template <typename T>
+class BinaryTree {
+  public:
+    BinaryTree() {}
+
+    // Simple insert: inserts value at next available node to make complete tree
+    void insert(const T& value) {
+        std::vector<Node<T>*> path_to_inserted_node = FindNthNodePath(_size + 1);
+        path_to_inserted_node.back()->value = value;
+    }
+
+    size_t size() {
+        return _size;
+    }
+
+    std::vector<T> PreorderTraversal() {
+        if (_root == nullptr) {
+            return {};
+        }
+        std::vector<T> traversal_vector;
+        std::vector<Node<T>*> frontier{_root.get()};
+        while (frontier.size() > 0) {
+            Node<T>* current_node_ptr = frontier.back();
+            frontier.pop_back();
+            traversal_vector.emplace_back(current_node_ptr->value);
+            if (current_node_ptr->right_child_ptr != nullptr) {
+                frontier.push_back(current_node_ptr->right_child_ptr.get());
+            }
+            if (current_node_ptr->left_child_ptr != nullptr) {
+                frontier.push_back(current_node_ptr->left_child_ptr.get());
+            }
+        }
+        return traversal_vector;
+    }
+
+    std::vector<T> PostorderTraversal() {
+        if (_root == nullptr) {
+            return {};
+        }
+        enum class NextAction { kTraverse, kVisit };
+        using NodeActionPair = std::pair<Node<T>*, NextAction>;
+        std::vector<T> traversal_vector;
+        std::vector<NodeActionPair> node_action_stack{
+                std::make_pair(_root.get(), NextAction::kTraverse)};
+        while (node_action_stack.size() > 0) {
+            auto [current_node_ptr, next_action] = node_action_stack.back();
+            node_action_stack.pop_back();
+            if (next_action == NextAction::kVisit) {
+                traversal_vector.emplace_back(current_node_ptr->value);
+            } else {  // next_action == NextAction::kTraverse
+                node_action_stack.emplace_back(current_node_ptr, NextAction::kVisit);
+                if (current_node_ptr->right_child_ptr != nullptr) {
+                    node_action_stack.emplace_back(
+                            current_node_ptr->right_child_ptr.get(),
+                            NextAction::kTraverse);
+                }
+                if (current_node_ptr->left_child_ptr != nullptr) {
+                    node_action_stack.emplace_back(
+                            current_node_ptr->left_child_ptr.get(),
+                            NextAction::kTraverse);
+                }
+            }
+        }
+        return traversal_vector;
+    }
+
+    std::vector<T> InorderTraversal() {
+        if (_root == nullptr) {
+            return {};
+        }
+        enum class Action { kEnter, kVisit };
+        using NodeActionPair = std::pair<Node<T>*, Action>;
+        std::vector<T> traversal_vector;
+        std::vector<NodeActionPair> node_action_stack{
+                std::make_pair(_root.get(), Action::kEnter)};
+        while (node_action_stack.size() > 0) {
+            auto [current_node_ptr, action] = node_action_stack.back();
+            node_action_stack.pop_back();
+            if (action == Action::kVisit) {
+                traversal_vector.emplace_back(current_node_ptr->value);
+            } else {  // action == Action::kEnter
+                if (current_node_ptr->right_child_ptr != nullptr) {
+                    node_action_stack.emplace_back(
+                            current_node_ptr->right_child_ptr.get(),
+                            Action::kEnter);
+                }
+                node_action_stack.emplace_back(current_node_ptr, Action::kVisit);
+                if (current_node_ptr->left_child_ptr != nullptr) {
+                    node_action_stack.emplace_back(
+                            current_node_ptr->left_child_ptr.get(),
+                            Action::kEnter);
+                }
+            }
+        }
+        return traversal_vector;
+    }
+
+  private:
+    // Retrieve the nth node in the tree assuming the tree is complete,
+    // inserting a new node if it does not exist (and any nodes along the path).
+    // Return a vector of the nodes along the path from route to the nth node.
+    // Note: n is 1-indexed here, as it makes the math easier!
+    std::vector<Node<T>*> FindNthNodePath(size_t n) {
+        size_t modulus = 1;
+        while (n / modulus > 1) {
+            modulus *= 2;
+        }
+        std::vector<Node<T>*> path_vector;
+        Node<T>* current_node_ptr = _root.get();
+        if (_root == nullptr) {
+            _root = std::make_unique<Node<T>>();
+            ++_size;
+            current_node_ptr = _root.get();
+        }
+        path_vector.push_back(current_node_ptr);
+        for (/* modulus */; modulus > 1; modulus /= 2) {
+            if ((n % modulus) < (modulus / 2)) {  // left
+                if (current_node_ptr->left_child_ptr == nullptr) {
+                    current_node_ptr->left_child_ptr = std::make_unique<Node<T>>();
+                    ++_size;
+                }
+                current_node_ptr = current_node_ptr->left_child_ptr.get();
+            } else {  // right
+                if (current_node_ptr->right_child_ptr == nullptr) {
+                    current_node_ptr->right_child_ptr = std::make_unique<Node<T>>();
+                    ++_size;
+                }
+                current_node_ptr = current_node_ptr->right_child_ptr.get();
+            }
+            path_vector.push_back(current_node_ptr);
+        }
+        return path_vector;
+    }
+
+    std::unique_ptr<Node<T>> _root;
+    size_t _size = 0;
+};
+
+// Complete binary tree stored in level order: the children of index i are at 2i + 1 and
+// 2i + 2, and its parent is at (i - 1) / 2.  Odd indices are left children, and nonzero even
+// indices are right children.
+template <typename T>
+class ImplicitBinaryTree {
+  public:
+    ImplicitBinaryTree() {}
+
+    // Inserts value at next available node to make complete tree, in amortized O(1)
+    void insert(const T& value) {
+        _values.push_back(value);
+    }
+
+    void reserve(size_t capacity) {
+        _values.reserve(capacity);
+    }
+
+    // Return by value, because if it's empty we still need to return something
+    T top() const {
+        if (_values.empty()) {
+            return T{};
+        }
+        return _values[0];
+    }
+
+    bool is_empty() const {
+        return _values.empty();
+    }
+
+    size_t size() const {
+        return _values.size();
+    }
+
+    std::vector<T> PreorderTraversal() const {
+        const size_t n = _values.size();
+        std::vector<T> traversal_vector;
+        traversal_vector.reserve(n);
+        size_t i = 0;
+        while (i < n) {
+            traversal_vector.push_back(_values[i]);
+            if (LeftChild(i) < n) {
+                i = LeftChild(i);
+                continue;
+            }
+            // Climb until we're at a left child with a right sibling, then go to the sibling
+            while ((i > 0) && (IsRightChild(i) || (i + 1 >= n))) {
+                i = Parent(i);
+            }
+            i = (i == 0) ? n : i + 1;
+        }
+        return traversal_vector;
+    }
+
+    std::vector<T> PostorderTraversal() const {
+        const size_t n = _values.size();
+        std::vector<T> traversal_vector;
+        traversal_vector.reserve(n);
+        if (n == 0) {
+            return traversal_vector;
+        }
+        // In a complete tree, a node without a left child has no right child either
+        size_t i = LeftmostDescendant(0);
+        while (true) {
+            traversal_vector.push_back(_values[i]);
+            if (i == 0) {
+                break;
+            }
+            // After a left child comes its sibling's subtree (if any), after a right child its
+            // parent
+            if (!IsRightChild(i) && (i + 1 < n)) {
+                i = LeftmostDescendant(i + 1);
+            } else {
+                i = Parent(i);
+            }
+        }
+        return traversal_vector;
+    }
+
+    std::vector<T> InorderTraversal() const {
+        const size_t n = _values.size();
+        std::vector<T> traversal_vector;
+        traversal_vector.reserve(n);
+        if (n == 0) {
+            return traversal_vector;
+        }
+        size_t i = LeftmostDescendant(0);
+        while (true) {
+            traversal_vector.push_back(_values[i]);
+            if (RightChild(i) < n) {
+                i = LeftmostDescendant(RightChild(i));
+                continue;
+            }
+            // Climb out of right subtrees; the parent of the left child we reach is next
+            while (IsRightChild(i)) {
+                i = Parent(i);
+            }
+            if (i == 0) {
+                break;
+            }
+            i = Parent(i);
+        }
+        return traversal_vector;
+    }
+
+    // Print out the tree level-by-level
+    friend std::ostream& operator<<(std::ostream& os, const ImplicitBinaryTree<T>& tree) {
+        for (size_t level_begin = 0; level_begin < tree._values.size();
+                level_begin = LeftChild(level_begin)) {
+            const size_t level_end = std::min(LeftChild(level_begin), tree._values.size());
+            for (size_t i = level_begin; i < level_end; ++i) {
+                os << tree._values[i] << " ";
+            }
+            os << std::endl;
+        }
+        return os;
+    }
+
+  private:
+    static size_t LeftChild(size_t i) {
+        return 2 * i + 1;
+    }
+
+    static size_t RightChild(size_t i) {
+        return 2 * i + 2;
+    }
+
+    static size_t Parent(size_t i) {
+        return (i - 1) / 2;
+    }
+
+    static bool IsRightChild(size_t i) {
+        return (i > 0) && (i % 2 == 0);
+    }
+
+    size_t LeftmostDescendant(size_t i) const {
+        while (LeftChild(i) < _values.size()) {
+            i = LeftChild(i);
+        }
+        return i;
+    }
+
+    std::vector<T> _values;
+};
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+// Insert and traversal times for one tree type.  The traversals are returned, to check that
+// the two tree types agree.
+template <typename Tree>
+void RunBenchmark(const std::string& name, size_t size,
+                  std::vector<std::vector<int>>* traversals) {
+    auto tree = std::make_unique<Tree>();
+    const double insert_seconds = TimeSeconds([&]() {
+        for (size_t i = 0; i < size; ++i) {
+            tree->insert(static_cast<int>(i));
+        }
+    });
+    traversals->resize(3);
+    const double preorder_seconds = TimeSeconds([&]() {
+        (*traversals)[0] = tree->PreorderTraversal();
+    });
+    const double postorder_seconds = TimeSeconds([&]() {
+        (*traversals)[1] = tree->PostorderTraversal();
+    });
+    const double inorder_seconds = TimeSeconds([&]() {
+        (*traversals)[2] = tree->InorderTraversal();
+    });
+    std::cout << "    " << name << ": insert " << insert_seconds << " s, preorder "
+              << preorder_seconds << " s, postorder " << postorder_seconds << " s, inorder "
+              << inorder_seconds << " s" << std::endl;
+}
+
+int main() {
+    std::vector<int> test_values{
+            1,
+            9, 3,
+            12, 50, 100, 5,
+            13, 16, 51, 200, 101, 102, 6, 999};
+
+    ImplicitBinaryTree<int> test_tree;
+    for (const int value : test_values) {
+        test_tree.insert(value);
+    }
+    std::cout << test_tree << std::endl << std::endl;
+
+    std::cout << "Computing preorder traversal:" << std::endl;
+    std::vector<int> preorder_traversal = test_tree.PreorderTraversal();
+    std::cout << preorder_traversal << std::endl << std::endl;
+
+    std::cout << "Computing postorder traversal:" << std::endl;
+    std::vector<int> postorder_traversal = test_tree.PostorderTraversal();
+    std::cout << postorder_traversal << std::endl << std::endl;
+
+    std::cout << "Computing inorder traversal:" << std::endl;
+    std::vector<int> inorder_traversal = test_tree.InorderTraversal();
+    std::cout << inorder_traversal << std::endl << std::endl;
+
+    // Every size of tree up to 300 nodes must traverse exactly like the pointer-based tree
+    BinaryTree<int> reference_tree;
+    ImplicitBinaryTree<int> implicit_tree;
+    for (int size = 0; size <= 300; ++size) {
+        if ((reference_tree.PreorderTraversal() != implicit_tree.PreorderTraversal()) ||
+                (reference_tree.PostorderTraversal() != implicit_tree.PostorderTraversal()) ||
+                (reference_tree.InorderTraversal() != implicit_tree.InorderTraversal())) {
+            std::cout << "MISMATCH for tree of " << size << " nodes" << std::endl;
+            return 1;
+        }
+        reference_tree.insert(1000 + size);
+        implicit_tree.insert(1000 + size);
+    }
+    std::cout << "Trees of 0 to 300 nodes: all traversals match the pointer-based tree"
+              << std::endl << std::endl;
+
+    const size_t kSize = 10'000'000;
+    std::cout << "Benchmark: " << kSize << " nodes" << std::endl;
+    std::vector<std::vector<int>> reference_traversals;
+    std::vector<std::vector<int>> implicit_traversals;
+    RunBenchmark<BinaryTree<int>>("Pointer-based", kSize, &reference_traversals);
+    RunBenchmark<ImplicitBinaryTree<int>>("Implicit     ", kSize, &implicit_traversals);
+    std::cout << "    " << (reference_traversals == implicit_traversals ? "Results match"
+                                                                        : "MISMATCH")
+              << std::endl;
+
+    return 0;
+}
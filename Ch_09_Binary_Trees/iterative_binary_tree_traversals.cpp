@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <utility>
@@ -33,6 +34,20 @@ class BinaryTree {
         path_to_inserted_node.back()->value = value;
     }
     
+    // Heap insert: inserts value at next available node, then swaps it up towards the root
+    // while it is smaller than its parent, so a tree built with push() is a min-heap
+    void push(const T& value) {
+        std::vector<Node<T>*> path_to_inserted_node = FindNthNodePath(_size + 1);
+        path_to_inserted_node.back()->value = value;
+        for (size_t i = path_to_inserted_node.size() - 1; i > 0; --i) {
+            Node<T>* parent_ptr = path_to_inserted_node[i - 1];
+            if (!(path_to_inserted_node[i]->value < parent_ptr->value)) {
+                break;
+            }
+            std::swap(path_to_inserted_node[i]->value, parent_ptr->value);
+        }
+    }
+    
     // Return by value, because if it's empty we still need to return something
     // Also it doesn't make sense to return a reference because we don't want
     // users modifying values of the heap (which would ruin the heap structure)
@@ -43,12 +58,45 @@ class BinaryTree {
         return _root->value;
     }
     
-    // NYI
+    // Removes and returns the root: the last node's value replaces it, the last node is
+    // unlinked, and the new root value is swapped down with its smaller child until neither
+    // child is smaller.  Only meaningful if the tree is a min-heap (built with push())
     T pop() {
         if (_root == nullptr) {
             return T{};
         }
-        return _root->value;
+        T top_value = std::move(_root->value);
+        std::vector<Node<T>*> path_to_last_node = FindNthNodePath(_size);
+        if (path_to_last_node.size() == 1) {
+            _root.reset();
+            _size = 0;
+            return top_value;
+        }
+        Node<T>* last_node_ptr = path_to_last_node.back();
+        Node<T>* last_parent_ptr = path_to_last_node[path_to_last_node.size() - 2];
+        _root->value = std::move(last_node_ptr->value);
+        if (last_parent_ptr->right_child_ptr.get() == last_node_ptr) {
+            last_parent_ptr->right_child_ptr.reset();
+        } else {
+            last_parent_ptr->left_child_ptr.reset();
+        }
+        --_size;
+        Node<T>* current_node_ptr = _root.get();
+        while (true) {
+            Node<T>* smallest_node_ptr = current_node_ptr;
+            for (Node<T>* child_ptr : {current_node_ptr->left_child_ptr.get(),
+                                       current_node_ptr->right_child_ptr.get()}) {
+                if ((child_ptr != nullptr) && (child_ptr->value < smallest_node_ptr->value)) {
+                    smallest_node_ptr = child_ptr;
+                }
+            }
+            if (smallest_node_ptr == current_node_ptr) {
+                break;
+            }
+            std::swap(current_node_ptr->value, smallest_node_ptr->value);
+            current_node_ptr = smallest_node_ptr;
+        }
+        return top_value;
     }
     
     bool is_empty() {
@@ -188,6 +236,7 @@ class BinaryTree {
         Node<T>* current_node_ptr = _root.get();
         if (_root == nullptr) {
             _root = std::make_unique<Node<T>>();
+            _root->parent_ptr_raw = nullptr;
             ++_size;
             current_node_ptr = _root.get();
         }
@@ -197,6 +246,7 @@ class BinaryTree {
                 // std::cout << "left" << std::endl;
                 if (current_node_ptr->left_child_ptr == nullptr) {
                     current_node_ptr->left_child_ptr = std::make_unique<Node<T>>();
+                    current_node_ptr->left_child_ptr->parent_ptr_raw = current_node_ptr;
                     ++_size;
                 }
                 current_node_ptr = current_node_ptr->left_child_ptr.get();
@@ -204,6 +254,7 @@ class BinaryTree {
                 // std::cout << "right" << std::endl;
                 if (current_node_ptr->right_child_ptr == nullptr) {
                     current_node_ptr->right_child_ptr = std::make_unique<Node<T>>();
+                    current_node_ptr->right_child_ptr->parent_ptr_raw = current_node_ptr;
                     ++_size;
                 }
                 current_node_ptr = current_node_ptr->right_child_ptr.get();
@@ -243,6 +294,24 @@ int main() {
     std::vector<int> inorder_traversal = test_tree.InorderTraversal();
     std::cout << inorder_traversal << std::endl << std::endl;
     
+    // Use the tree as a min-heap: push the values in reverse, then pop them all back out
+    std::cout << "Popping from a heap built with push():" << std::endl;
+    BinaryTree<int> heap_tree;
+    for (auto it = test_values.rbegin(); it != test_values.rend(); ++it) {
+        heap_tree.push(*it);
+    }
+    std::vector<int> popped_values;
+    while (!heap_tree.is_empty()) {
+        popped_values.push_back(heap_tree.pop());
+    }
+    std::cout << popped_values << std::endl;
+    std::vector<int> sorted_values = test_values;
+    std::sort(sorted_values.begin(), sorted_values.end());
+    if ((popped_values != sorted_values) || (heap_tree.size() != 0)) {
+        std::cout << "MISMATCH: expected " << sorted_values << std::endl;
+        return 1;
+    }
+    
     return 0;
 }
     
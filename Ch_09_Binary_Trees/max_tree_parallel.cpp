@@ -0,0 +1,424 @@
+/* Parallel max tree construction.
+ *
+ * ConstructMaxTree (max_tree.cpp) inserts the values one at a time, walking up from the last
+ * inserted node, so each step depends on the previous one.  Instead, we split the input into
+ * chunks, build the max tree of each chunk independently (with the same algorithm), and then
+ * merge the trees of neighbouring ranges, in rounds, until one tree is left.
+ *
+ * Merging the trees of A[a..b) and A[b..c): only the right spine of the left tree (the path
+ * from its root down through right children) and the left spine of the right tree can
+ * change.  Each spine has decreasing values from the top, and the merged tree has the two
+ * spines merged into one chain in decreasing order, where each left tree node's right child
+ * and each right tree node's left child is the next node down the chain.  (Equal values put
+ * the left tree's node above, which is what ConstructMaxTree does.)  Everything else stays
+ * the same.
+ *
+ * We merge the chains from the bottom: the bottoms of the two spines are b - 1 and b, so we
+ * don't need to walk down to find them, and we can stop as soon as we reach the top of one
+ * spine: the rest of the other spine is already linked together.  Every node we pass below
+ * the top of the other spine leaves the outer spine of the merged tree for good, so it's
+ * never walked over again in a later merge: the total merge work is O(n), and for sorted
+ * input each merge is O(1).
+ *
+ * The result is the same tree as ConstructMaxTree's, stored as index arrays like in
+ * max_tree_range_max_queries.cpp.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const std::vector<T>& v) {
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i];
+        if (i + 1 < v.size()) os << ", ";
+    }
+    os << "]";
+    return os;
+}
+
+template <typename T>
+struct Node {
+    Node(const T& value) : value(value) {}
+
+    T value;
+    std::unique_ptr<Node<T>> left_child;
+    std::unique_ptr<Node<T>> right_child;
+    Node<T>* parent = nullptr;
+};
+
+// Copy of ConstructMaxTree from max_tree.cpp, kept here as the reference for correctness
+// checks and benchmarking
+template <typename T>
+std::unique_ptr<Node<T>> ConstructMaxTree(const std::vector<T>& input_vector) {
+    if (input_vector.size() == 0) {
+        return nullptr;
+    }
+    std::unique_ptr<Node<T>> root = std::make_unique<Node<T>>(input_vector[0]);
+    Node<T>* current_node = root.get();
+    for (size_t i = 1; i < input_vector.size(); ++i) {
+        const T& value_to_insert = input_vector[i];
+        // Walk up the tree until new value is not greater than parent value
+        while ((current_node != nullptr) && (value_to_insert > current_node->value)) {
+            current_node = current_node->parent;
+        }
+        // Now we need to make the new value current_node's right child
+        // and move current_node's current right child to new node's left child
+        // If current node is nullptr, then the new node will be the new root
+        // and the current root will be this new node's left child
+        if (current_node == nullptr) {
+            std::unique_ptr<Node<T>> new_root = std::make_unique<Node<T>>(value_to_insert);
+            new_root->left_child = std::move(root);
+            new_root->left_child->parent = new_root.get();
+            root = std::move(new_root);
+            current_node = root.get();
+        } else {
+            // Insert and rotate right child, if exists
+            if (current_node->right_child != nullptr) {
+                std::unique_ptr<Node<T>> new_node = std::make_unique<Node<T>>(value_to_insert);
+                new_node->left_child = std::move(current_node->right_child);
+                new_node->left_child->parent = new_node.get();
+                current_node->right_child = std::move(new_node);
+            } else {  // no right child of current_node, so just insert as right child
+                current_node->right_child = std::make_unique<Node<T>>(value_to_insert);
+            }
+            current_node->right_child->parent = current_node;
+            // Update current_node as node we just inserted
+            current_node = current_node->right_child.get();
+        }
+    }
+    return root;
+}
+
+// Calls func(thread_index) on num_threads threads (one of them the calling thread)
+template <typename Func>
+void RunOnThreads(size_t num_threads, Func&& func) {
+    std::vector<std::thread> threads;
+    for (size_t thread_index = 1; thread_index < num_threads; ++thread_index) {
+        threads.emplace_back(func, thread_index);
+    }
+    func(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// IndexMaxTree from max_tree_range_max_queries.cpp, built on any number of threads
+template <typename T>
+class IndexMaxTree {
+  public:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    // With num_threads > 1, the input is split into chunks that are built in parallel and
+    // then merged (see the top of the file).  The tree is the same either way.
+    explicit IndexMaxTree(const std::vector<T>& values, size_t num_threads = 1)
+            : _values(values),
+              _parent(CheckedSize(values), kNone),
+              _left_child(values.size(), kNone),
+              _right_child(values.size(), kNone) {
+        const uint32_t size = static_cast<uint32_t>(values.size());
+        num_threads = std::max<size_t>(num_threads, 1);
+        if ((num_threads == 1) || (size < kMinChunkSize)) {
+            _root = BuildRange(0, size);
+            return;
+        }
+        // A few chunks per thread, so that threads that finish early can take more
+        const size_t num_chunks =
+                std::min<size_t>(num_threads * kChunksPerThread, size / kMinChunkSize);
+        std::vector<uint32_t> range_begins(num_chunks + 1);
+        for (size_t chunk = 0; chunk <= num_chunks; ++chunk) {
+            range_begins[chunk] = static_cast<uint32_t>(size * chunk / num_chunks);
+        }
+        std::vector<uint32_t> range_roots(num_chunks);
+        std::atomic<size_t> next_chunk = 0;
+        RunOnThreads(num_threads, [&](size_t /* thread_index */) {
+            for (size_t chunk = next_chunk++; chunk < num_chunks; chunk = next_chunk++) {
+                range_roots[chunk] = BuildRange(range_begins[chunk], range_begins[chunk + 1]);
+            }
+        });
+        // Each round merges pairs of neighbouring ranges, which touch disjoint nodes
+        while (range_roots.size() > 1) {
+            const size_t num_merges = range_roots.size() / 2;
+            std::vector<uint32_t> merged_begins;
+            std::vector<uint32_t> merged_roots(num_merges);
+            for (size_t merge = 0; merge < num_merges; ++merge) {
+                merged_begins.push_back(range_begins[2 * merge]);
+            }
+            std::atomic<size_t> next_merge = 0;
+            RunOnThreads(std::min(num_threads, num_merges), [&](size_t /* thread_index */) {
+                for (size_t merge = next_merge++; merge < num_merges; merge = next_merge++) {
+                    merged_roots[merge] = MergeRanges(range_roots[2 * merge],
+                                                      range_roots[2 * merge + 1],
+                                                      range_begins[2 * merge + 1]);
+                }
+            });
+            if (range_roots.size() % 2 == 1) {
+                merged_begins.push_back(range_begins[range_roots.size() - 1]);
+                merged_roots.push_back(range_roots.back());
+            }
+            merged_begins.push_back(size);
+            range_begins = std::move(merged_begins);
+            range_roots = std::move(merged_roots);
+        }
+        _root = range_roots[0];
+    }
+
+    size_t size() const {
+        return _values.size();
+    }
+
+    const std::vector<T>& values() const {
+        return _values;
+    }
+
+    uint32_t root() const {
+        return _root;
+    }
+
+    uint32_t parent(uint32_t node) const {
+        return _parent[node];
+    }
+
+    uint32_t left_child(uint32_t node) const {
+        return _left_child[node];
+    }
+
+    uint32_t right_child(uint32_t node) const {
+        return _right_child[node];
+    }
+
+    // Same shape (the values are those of the input either way)
+    bool operator==(const IndexMaxTree<T>& other) const {
+        return (_root == other._root) && (_parent == other._parent) &&
+               (_left_child == other._left_child) && (_right_child == other._right_child);
+    }
+
+  private:
+    static constexpr size_t kChunksPerThread = 4;
+    static constexpr size_t kMinChunkSize = 1 << 12;
+
+    // values.size(), checked before anything is allocated: indices must fit in 32 bits, with
+    // kNone left over
+    static size_t CheckedSize(const std::vector<T>& values) {
+        if (values.size() >= kNone) {
+            throw std::length_error("IndexMaxTree: too many values for 32-bit indices");
+        }
+        return values.size();
+    }
+
+    // Same algorithm as ConstructMaxTree, on values[begin, end).  Returns the root.
+    uint32_t BuildRange(uint32_t begin, uint32_t end) {
+        if (begin == end) {
+            return kNone;
+        }
+        uint32_t root = begin;
+        uint32_t current_node = begin;
+        for (uint32_t i = begin + 1; i < end; ++i) {
+            const T& value_to_insert = _values[i];
+            // The node that becomes i's left child: the last one we walked past
+            uint32_t below = kNone;
+            while ((current_node != kNone) && (value_to_insert > _values[current_node])) {
+                below = current_node;
+                current_node = _parent[current_node];
+            }
+            _left_child[i] = below;
+            if (below != kNone) {
+                _parent[below] = i;
+            }
+            _parent[i] = current_node;
+            if (current_node == kNone) {
+                root = i;
+            } else {
+                _right_child[current_node] = i;
+            }
+            current_node = i;
+        }
+        return root;
+    }
+
+    // Merges the trees of neighbouring ranges [.., middle) and [middle, ..), with the given
+    // roots, as described at the top of the file.  Returns the merged root.
+    uint32_t MergeRanges(uint32_t left_root, uint32_t right_root, uint32_t middle) {
+        // Next unplaced node of each spine, from the bottom, or kNone once the top is placed
+        uint32_t left_node = middle - 1;
+        uint32_t right_node = middle;
+        // Last node placed in the merged chain, which goes below the next one
+        uint32_t below = kNone;
+        while ((left_node != kNone) && (right_node != kNone)) {
+            // On equal values the left tree's node goes above, so the right one is placed first
+            if (_values[right_node] <= _values[left_node]) {
+                const uint32_t next_right_node = _parent[right_node];
+                LinkBelow(right_node, _left_child, below);
+                below = right_node;
+                right_node = next_right_node;
+            } else {
+                const uint32_t next_left_node = _parent[left_node];
+                LinkBelow(left_node, _right_child, below);
+                below = left_node;
+                left_node = next_left_node;
+            }
+        }
+        // One spine is used up.  The rest of the other one is still linked together, and its
+        // lowest remaining node goes above the last node placed.
+        if (left_node != kNone) {
+            LinkBelow(left_node, _right_child, below);
+            return left_root;
+        }
+        if (right_node != kNone) {
+            LinkBelow(right_node, _left_child, below);
+            return right_root;
+        }
+        return below;  // both spines ended together, at the top of the chain
+    }
+
+    // Makes child the next node down the chain from node, which continues through the given
+    // side of node.  node's own parent is set when the next node up is linked (or is already
+    // right, for the top of the chain).
+    void LinkBelow(uint32_t node, std::vector<uint32_t>& child_side, uint32_t child) {
+        child_side[node] = child;
+        if (child != kNone) {
+            _parent[child] = node;
+        }
+    }
+
+    const std::vector<T>& _values;
+    std::vector<uint32_t> _parent;
+    std::vector<uint32_t> _left_child;
+    std::vector<uint32_t> _right_child;
+    uint32_t _root = kNone;
+};
+
+// Whether the pointer tree and the index tree have the same shape and values
+template <typename T>
+bool SameTree(const Node<T>* pointer_root, const IndexMaxTree<T>& index_tree) {
+    constexpr uint32_t kNone = IndexMaxTree<T>::kNone;
+    std::vector<std::pair<const Node<T>*, uint32_t>> frontier{{pointer_root, index_tree.root()}};
+    while (!frontier.empty()) {
+        const auto [node_ptr, node] = frontier.back();
+        frontier.pop_back();
+        if ((node_ptr == nullptr) || (node == kNone)) {
+            if ((node_ptr != nullptr) || (node != kNone)) {
+                return false;
+            }
+            continue;
+        }
+        if (node_ptr->value != index_tree.values()[node]) {
+            return false;
+        }
+        const uint32_t parent = index_tree.parent(node);
+        if ((node_ptr->parent == nullptr) != (parent == kNone)) {
+            return false;
+        }
+        frontier.emplace_back(node_ptr->left_child.get(), index_tree.left_child(node));
+        frontier.emplace_back(node_ptr->right_child.get(), index_tree.right_child(node));
+    }
+    return true;
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+int main() {
+    std::mt19937 rng(12345);
+
+    // Random inputs with many ties, and sorted ones, large enough to be split into chunks,
+    // against ConstructMaxTree (random ones only: sorted inputs give paths, which would
+    // overflow the stack when the pointer tree is destroyed) and the sequential build
+    for (int trial = 0; trial < 60; ++trial) {
+        std::vector<int> values(std::uniform_int_distribution<int>(0, 200'000)(rng));
+        std::uniform_int_distribution<int> value_dist(0, 1 + trial % 6 * 1000);
+        for (int& value : values) {
+            value = value_dist(rng);
+        }
+        if (trial % 3 == 1) {
+            std::sort(values.begin(), values.end());
+        } else if (trial % 3 == 2) {
+            std::sort(values.rbegin(), values.rend());
+        }
+        const IndexMaxTree<int> sequential_tree(values);
+        bool all_match = true;
+        if (trial % 3 == 0) {
+            all_match = SameTree(ConstructMaxTree(values).get(), sequential_tree);
+        }
+        for (const size_t num_threads : {2, 3, 8, 13}) {
+            all_match = all_match && (IndexMaxTree<int>(values, num_threads) == sequential_tree);
+        }
+        if (!all_match) {
+            std::cout << "MISMATCH for trial " << trial << " (" << values.size() << " values)"
+                      << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Random and sorted inputs of up to 200000 values: parallel builds match "
+              << "ConstructMaxTree and the sequential build" << std::endl;
+
+    // Too many values for 32-bit indices must be rejected before the node arrays (12 bytes per
+    // value) are allocated.  A vector<bool> keeps the input itself at 512 MB.
+    {
+        const std::vector<bool> too_many_values(size_t{IndexMaxTree<bool>::kNone} + 1);
+        bool threw = false;
+        try {
+            IndexMaxTree<bool> too_big_tree(too_many_values, 4);
+        } catch (const std::length_error&) {
+            threw = true;
+        }
+        if (!threw) {
+            std::cout << "No std::length_error for 2^32 values" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "2^32 values: std::length_error before allocating" << std::endl << std::endl;
+
+    const size_t kSize = 100'000'000;
+    std::vector<int> values(kSize);
+    std::uniform_int_distribution<int> value_dist(0, 1'000'000'000);
+    for (int& value : values) {
+        value = value_dist(rng);
+    }
+    std::cout << "Benchmark: " << kSize << " values" << std::endl;
+    for (const std::string input_order : {"random", "ascending", "descending"}) {
+        if (input_order == "ascending") {
+            std::sort(values.begin(), values.end());
+        } else if (input_order == "descending") {
+            std::sort(values.rbegin(), values.rend());
+        }
+        std::unique_ptr<IndexMaxTree<int>> sequential_tree;
+        const double sequential_seconds = TimeSeconds([&]() {
+            sequential_tree = std::make_unique<IndexMaxTree<int>>(values);
+        });
+        std::cout << "    " << input_order << ": sequential " << sequential_seconds << " s"
+                  << std::endl;
+        const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t num_threads = 2; num_threads <= std::max<size_t>(max_threads, 16);
+                num_threads *= 2) {
+            std::unique_ptr<IndexMaxTree<int>> parallel_tree;
+            const double parallel_seconds = TimeSeconds([&]() {
+                parallel_tree = std::make_unique<IndexMaxTree<int>>(values, num_threads);
+            });
+            std::cout << "        " << num_threads << " threads: " << parallel_seconds
+                      << " s, speedup " << sequential_seconds / parallel_seconds << "x, "
+                      << (*parallel_tree == *sequential_tree ? "same tree" : "DIFFERENT TREE")
+                      << std::endl;
+        }
+    }
+    std::cout << "(hardware threads available: " << std::thread::hardware_concurrency() << ")"
+              << std::endl;
+
+    return 0;
+}
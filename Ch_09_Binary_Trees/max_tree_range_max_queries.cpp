@@ -0,0 +1,553 @@
+/* Index-based max tree, and O(1) range-maximum queries built on it.
+ *
+ * IndexMaxTree is ConstructMaxTree from max_tree.cpp, with nodes identified by their index in
+ * the input: the tree is three uint32_t arrays (parent, left child, right child) over the
+ * original input, instead of one allocation per element holding a copy of the value.
+ *
+ * The max tree of A is also the answer to range-maximum queries: the maximum of A[i..j] is
+ * the lowest common ancestor of i and j.  RangeMaxQuery answers these in O(1) after O(n)
+ * preprocessing, using the tree as follows.
+ *
+ * Index k < j is an ancestor of j exactly when A[k] is at least every value in A[k+1..j], so
+ * the ancestors of j with smaller indices (plus j itself) are the "candidate maxima" for
+ * ranges ending at j: for any i <= j, the maximum of A[i..j] is the first of them at or after
+ * i.  Split the input into blocks of 64, and for each j keep a bitmask of its candidates
+ * within its block.  Then a query inside a block is one mask lookup, a shift and a count of
+ * trailing zeros.  A query spanning blocks is the suffix of the first block, the prefix of
+ * the last, and a sparse table lookup over the whole blocks in between (a sparse table over
+ * n/64 blocks is O(n) space).
+ *
+ * The masks take O(n) to compute: mask[j] is mask[p] plus j's own bit, where p is j's
+ * nearest ancestor with a smaller index (if it's in the same block).  p is the parent of the
+ * top of the chain of left-child edges that j is on.  Climbing that chain from every j would
+ * be O(n^2) for sorted input, whose tree is one long left chain, so instead we walk each chain
+ * down once from its top, and give all of its nodes the same p: O(n) steps in total.
+ *
+ * Ties: like ConstructMaxTree, an equal value later in the input goes below an earlier one,
+ * so all queries return the index of the leftmost maximum.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const std::vector<T>& v) {
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i];
+        if (i + 1 < v.size()) os << ", ";
+    }
+    os << "]";
+    return os;
+}
+
+template <typename T>
+struct Node {
+    Node(const T& value) : value(value) {}
+
+    T value;
+    std::unique_ptr<Node<T>> left_child;
+    std::unique_ptr<Node<T>> right_child;
+    Node<T>* parent = nullptr;
+};
+
+// Copy of ConstructMaxTree from max_tree.cpp, kept here as the reference for correctness
+// checks and benchmarking
+template <typename T>
+std::unique_ptr<Node<T>> ConstructMaxTree(const std::vector<T>& input_vector) {
+    if (input_vector.size() == 0) {
+        return nullptr;
+    }
+    std::unique_ptr<Node<T>> root = std::make_unique<Node<T>>(input_vector[0]);
+    Node<T>* current_node = root.get();
+    for (size_t i = 1; i < input_vector.size(); ++i) {
+        const T& value_to_insert = input_vector[i];
+        // Walk up the tree until new value is not greater than parent value
+        while ((current_node != nullptr) && (value_to_insert > current_node->value)) {
+            current_node = current_node->parent;
+        }
+        // Now we need to make the new value current_node's right child
+        // and move current_node's current right child to new node's left child
+        // If current node is nullptr, then the new node will be the new root
+        // and the current root will be this new node's left child
+        if (current_node == nullptr) {
+            std::unique_ptr<Node<T>> new_root = std::make_unique<Node<T>>(value_to_insert);
+            new_root->left_child = std::move(root);
+            new_root->left_child->parent = new_root.get();
+            root = std::move(new_root);
+            current_node = root.get();
+        } else {
+            // Insert and rotate right child, if exists
+            if (current_node->right_child != nullptr) {
+                std::unique_ptr<Node<T>> new_node = std::make_unique<Node<T>>(value_to_insert);
+                new_node->left_child = std::move(current_node->right_child);
+                new_node->left_child->parent = new_node.get();
+                current_node->right_child = std::move(new_node);
+            } else {  // no right child of current_node, so just insert as right child
+                current_node->right_child = std::make_unique<Node<T>>(value_to_insert);
+            }
+            current_node->right_child->parent = current_node;
+            // Update current_node as node we just inserted
+            current_node = current_node->right_child.get();
+        }
+    }
+    return root;
+}
+
+// Max tree over a vector, which must outlive it.  Nodes are indices into the vector, and
+// kNone stands for a missing node.
+template <typename T>
+class IndexMaxTree {
+  public:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    // Same algorithm as ConstructMaxTree: walk up from the last inserted node until we find
+    // a value not less than the new one, and make the new node its right child, with its old
+    // right child (if any) as the new node's left child
+    explicit IndexMaxTree(const std::vector<T>& values)
+            : _values(values),
+              _parent(CheckedSize(values), kNone),
+              _left_child(values.size(), kNone),
+              _right_child(values.size(), kNone) {
+        const uint32_t size = static_cast<uint32_t>(values.size());
+        if (size == 0) {
+            return;
+        }
+        _root = 0;
+        uint32_t current_node = 0;
+        for (uint32_t i = 1; i < size; ++i) {
+            const T& value_to_insert = values[i];
+            // The node that becomes i's left child: the last one we walked past
+            uint32_t below = kNone;
+            while ((current_node != kNone) && (value_to_insert > values[current_node])) {
+                below = current_node;
+                current_node = _parent[current_node];
+            }
+            _left_child[i] = below;
+            if (below != kNone) {
+                _parent[below] = i;
+            }
+            _parent[i] = current_node;
+            if (current_node == kNone) {
+                _root = i;
+            } else {
+                _right_child[current_node] = i;
+            }
+            current_node = i;
+        }
+    }
+
+    size_t size() const {
+        return _values.size();
+    }
+
+    const std::vector<T>& values() const {
+        return _values;
+    }
+
+    uint32_t root() const {
+        return _root;
+    }
+
+    uint32_t parent(uint32_t node) const {
+        return _parent[node];
+    }
+
+    uint32_t left_child(uint32_t node) const {
+        return _left_child[node];
+    }
+
+    uint32_t right_child(uint32_t node) const {
+        return _right_child[node];
+    }
+
+  private:
+    // values.size(), checked before anything is allocated: indices must fit in 32 bits, with
+    // kNone left over
+    static size_t CheckedSize(const std::vector<T>& values) {
+        if (values.size() >= kNone) {
+            throw std::length_error("IndexMaxTree: too many values for 32-bit indices");
+        }
+        return values.size();
+    }
+
+    const std::vector<T>& _values;
+    std::vector<uint32_t> _parent;
+    std::vector<uint32_t> _left_child;
+    std::vector<uint32_t> _right_child;
+    uint32_t _root = kNone;
+};
+
+// O(1) range-maximum queries over the values of an IndexMaxTree (see the top of the file).
+// Only keeps a reference to the values, not to the tree.
+template <typename T>
+class RangeMaxQuery {
+  public:
+    explicit RangeMaxQuery(const IndexMaxTree<T>& max_tree)
+            : _values(max_tree.values()), _candidate_masks(max_tree.size()) {
+        constexpr uint32_t kNone = IndexMaxTree<T>::kNone;
+        const uint32_t size = static_cast<uint32_t>(max_tree.size());
+        // First store each node's nearest ancestor with a smaller index in its mask slot, by
+        // walking every chain of left-child edges down from its top (the root or a right child)
+        for (uint32_t top = 0; top < size; ++top) {
+            const uint32_t top_parent = max_tree.parent(top);
+            if ((top_parent != kNone) && (max_tree.left_child(top_parent) == top)) {
+                continue;
+            }
+            for (uint32_t node = top; node != kNone; node = max_tree.left_child(node)) {
+                _candidate_masks[node] = top_parent;
+            }
+        }
+        // Then replace them with the masks, in index order, so that the ancestor's mask is
+        // already done
+        for (uint32_t j = 0; j < size; ++j) {
+            const uint32_t nearest_left_ancestor = static_cast<uint32_t>(_candidate_masks[j]);
+            uint64_t mask = uint64_t{1} << (j % kBlockSize);
+            if ((nearest_left_ancestor != kNone) &&
+                    (nearest_left_ancestor / kBlockSize == j / kBlockSize)) {
+                mask |= _candidate_masks[nearest_left_ancestor];
+            }
+            _candidate_masks[j] = mask;
+        }
+        // Sparse table over the blocks: level k holds the maximum of 2^k blocks from each block
+        const size_t num_blocks = (size + kBlockSize - 1) / kBlockSize;
+        if (num_blocks == 0) {
+            return;
+        }
+        _block_max_levels.emplace_back(num_blocks);
+        for (size_t block = 0; block < num_blocks; ++block) {
+            const size_t block_end = std::min<size_t>((block + 1) * kBlockSize, size) - 1;
+            const uint32_t max_index = static_cast<uint32_t>(
+                    block * kBlockSize + std::countr_zero(_candidate_masks[block_end]));
+            _block_max_levels[0][block] = {_values[max_index], max_index};
+        }
+        for (size_t width = 2; width <= num_blocks; width *= 2) {
+            const std::vector<IndexedValue>& previous = _block_max_levels.back();
+            std::vector<IndexedValue> level(num_blocks - width + 1);
+            for (size_t block = 0; block < level.size(); ++block) {
+                level[block] = LeftmostMax(previous[block], previous[block + width / 2]);
+            }
+            _block_max_levels.push_back(std::move(level));
+        }
+    }
+
+    // Index of the (leftmost) maximum of values[i..j], for i <= j
+    uint32_t MaxIndex(size_t i, size_t j) const {
+        const size_t first_block = i / kBlockSize;
+        const size_t last_block = j / kBlockSize;
+        if (first_block == last_block) {
+            return InBlockMax(i, j);
+        }
+        IndexedValue max = AtIndex(InBlockMax(i, first_block * kBlockSize + kBlockSize - 1));
+        if (last_block - first_block > 1) {
+            max = LeftmostMax(max, BlockRangeMax(first_block + 1, last_block - 1));
+        }
+        return LeftmostMax(max, AtIndex(InBlockMax(last_block * kBlockSize, j))).index;
+    }
+
+    const T& Max(size_t i, size_t j) const {
+        return _values[MaxIndex(i, j)];
+    }
+
+  private:
+    static constexpr size_t kBlockSize = 64;
+
+    // Block maxima keep their value next to the index, so that combining them doesn't need
+    // another (likely cache-missing) read of the values
+    struct IndexedValue {
+        T value;
+        uint32_t index;
+    };
+
+    IndexedValue AtIndex(uint32_t index) const {
+        return {_values[index], index};
+    }
+
+    // i and j in the same block
+    uint32_t InBlockMax(size_t i, size_t j) const {
+        const uint64_t candidates = _candidate_masks[j] >> (i % kBlockSize);
+        return static_cast<uint32_t>(i + std::countr_zero(candidates));
+    }
+
+    IndexedValue BlockRangeMax(size_t first_block, size_t last_block) const {
+        const size_t level = std::bit_width(last_block - first_block + 1) - 1;
+        return LeftmostMax(_block_max_levels[level][first_block],
+                           _block_max_levels[level][last_block + 1 - (size_t{1} << level)]);
+    }
+
+    // left is before right in the values
+    static IndexedValue LeftmostMax(const IndexedValue& left, const IndexedValue& right) {
+        return (right.value > left.value) ? right : left;
+    }
+
+    const std::vector<T>& _values;
+    std::vector<uint64_t> _candidate_masks;
+    std::vector<std::vector<IndexedValue>> _block_max_levels;
+};
+
+// Standard sparse table, for comparison: level k holds the index of the maximum of each
+// range of 2^k values.  O(n log n) preprocessing and space, O(1) queries.
+template <typename T>
+class SparseTable {
+  public:
+    explicit SparseTable(const std::vector<T>& values) : _values(values) {
+        if (values.size() == 0) {
+            return;
+        }
+        _levels.emplace_back(values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            _levels[0][i] = static_cast<uint32_t>(i);
+        }
+        for (size_t width = 2; width <= values.size(); width *= 2) {
+            const std::vector<uint32_t>& previous = _levels.back();
+            std::vector<uint32_t> level(values.size() - width + 1);
+            for (size_t i = 0; i < level.size(); ++i) {
+                const uint32_t left_index = previous[i];
+                const uint32_t right_index = previous[i + width / 2];
+                level[i] = (values[right_index] > values[left_index]) ? right_index : left_index;
+            }
+            _levels.push_back(std::move(level));
+        }
+    }
+
+    uint32_t MaxIndex(size_t i, size_t j) const {
+        const size_t level = std::bit_width(j - i + 1) - 1;
+        const uint32_t left_index = _levels[level][i];
+        const uint32_t right_index = _levels[level][j + 1 - (size_t{1} << level)];
+        return (_values[right_index] > _values[left_index]) ? right_index : left_index;
+    }
+
+  private:
+    const std::vector<T>& _values;
+    std::vector<std::vector<uint32_t>> _levels;
+};
+
+// Deletes a tree one node at a time, since destroying a deep tree through its unique_ptrs
+// would recurse once per level and overflow the stack
+template <typename T>
+void DestroyTree(std::unique_ptr<Node<T>> root) {
+    std::vector<std::unique_ptr<Node<T>>> pending;
+    if (root != nullptr) {
+        pending.push_back(std::move(root));
+    }
+    while (!pending.empty()) {
+        std::unique_ptr<Node<T>> node = std::move(pending.back());
+        pending.pop_back();
+        if (node->left_child != nullptr) {
+            pending.push_back(std::move(node->left_child));
+        }
+        if (node->right_child != nullptr) {
+            pending.push_back(std::move(node->right_child));
+        }
+    }
+}
+
+// Whether the pointer tree and the index tree have the same shape and values
+template <typename T>
+bool SameTree(const Node<T>* pointer_root, const IndexMaxTree<T>& index_tree) {
+    constexpr uint32_t kNone = IndexMaxTree<T>::kNone;
+    std::vector<std::pair<const Node<T>*, uint32_t>> frontier{{pointer_root, index_tree.root()}};
+    while (!frontier.empty()) {
+        const auto [node_ptr, node] = frontier.back();
+        frontier.pop_back();
+        if ((node_ptr == nullptr) || (node == kNone)) {
+            if ((node_ptr != nullptr) || (node != kNone)) {
+                return false;
+            }
+            continue;
+        }
+        if (node_ptr->value != index_tree.values()[node]) {
+            return false;
+        }
+        const uint32_t parent = index_tree.parent(node);
+        if ((node_ptr->parent == nullptr) != (parent == kNone)) {
+            return false;
+        }
+        frontier.emplace_back(node_ptr->left_child.get(), index_tree.left_child(node));
+        frontier.emplace_back(node_ptr->right_child.get(), index_tree.right_child(node));
+    }
+    return true;
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+// Random query ranges: uniformly random pairs, or with length at most max_length
+std::vector<std::pair<uint32_t, uint32_t>> RandomQueries(size_t num_queries, size_t size,
+                                                         size_t max_length, std::mt19937& rng) {
+    std::vector<std::pair<uint32_t, uint32_t>> queries(num_queries);
+    std::uniform_int_distribution<size_t> index_dist(0, size - 1);
+    std::uniform_int_distribution<size_t> length_dist(1, max_length);
+    for (auto& [i, j] : queries) {
+        if (max_length >= size) {
+            i = static_cast<uint32_t>(index_dist(rng));
+            j = static_cast<uint32_t>(index_dist(rng));
+            if (i > j) {
+                std::swap(i, j);
+            }
+        } else {
+            i = static_cast<uint32_t>(index_dist(rng));
+            j = static_cast<uint32_t>(std::min(size - 1, i + length_dist(rng) - 1));
+        }
+    }
+    return queries;
+}
+
+int main() {
+    const std::vector<int> test_vector{6, 2, 1, 4, 3, 7, 2, 5, 1, 6, 8};
+    const IndexMaxTree<int> test_tree(test_vector);
+    std::cout << "Input: " << test_vector << std::endl;
+    std::vector<uint32_t> parents;
+    for (size_t i = 0; i < test_vector.size(); ++i) {
+        parents.push_back(test_tree.parent(static_cast<uint32_t>(i)));
+    }
+    std::cout << "Root index: " << test_tree.root() << ", parent indices: " << parents
+              << " (" << IndexMaxTree<int>::kNone << " = none)" << std::endl;
+    const RangeMaxQuery<int> test_rmq(test_tree);
+    std::cout << "max(A[1..4]) = " << test_rmq.Max(1, 4) << ", max(A[6..9]) = "
+              << test_rmq.Max(6, 9) << ", max(A[0..10]) = " << test_rmq.Max(0, 10) << std::endl
+              << std::endl;
+
+    // Random inputs with many ties, plus sorted ones (whose trees are paths), against the
+    // pointer tree and against a linear scan for every range
+    std::mt19937 rng(12345);
+    for (int trial = 0; trial < 600; ++trial) {
+        std::vector<int> values(trial % 300);
+        std::uniform_int_distribution<int> value_dist(0, 1 + trial % 7 * 20);
+        for (int& value : values) {
+            value = value_dist(rng);
+        }
+        if (trial % 3 == 1) {
+            std::sort(values.begin(), values.end());
+        } else if (trial % 3 == 2) {
+            std::sort(values.rbegin(), values.rend());
+        }
+        const IndexMaxTree<int> index_tree(values);
+        const RangeMaxQuery<int> rmq(index_tree);
+        const SparseTable<int> sparse_table(values);
+        std::unique_ptr<Node<int>> pointer_root = ConstructMaxTree(values);
+        bool all_match = SameTree(pointer_root.get(), index_tree);
+        for (size_t i = 0; i < values.size(); ++i) {
+            size_t max_index = i;
+            for (size_t j = i; j < values.size(); ++j) {
+                if (values[j] > values[max_index]) {
+                    max_index = j;
+                }
+                all_match = all_match && (rmq.MaxIndex(i, j) == max_index) &&
+                            (sparse_table.MaxIndex(i, j) == max_index);
+            }
+        }
+        if (!all_match) {
+            std::cout << "MISMATCH for " << values << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Random and sorted inputs of up to 300 values: trees match ConstructMaxTree, "
+              << "and queries match a linear scan for every range" << std::endl;
+
+    // Too many values for 32-bit indices must be rejected before the node arrays (12 bytes per
+    // value) are allocated.  A vector<bool> keeps the input itself at 512 MB.
+    {
+        const std::vector<bool> too_many_values(size_t{IndexMaxTree<bool>::kNone} + 1);
+        bool threw = false;
+        try {
+            IndexMaxTree<bool> too_big_tree(too_many_values);
+        } catch (const std::length_error&) {
+            threw = true;
+        }
+        if (!threw) {
+            std::cout << "No std::length_error for 2^32 values" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "2^32 values: std::length_error before allocating" << std::endl << std::endl;
+
+    const size_t kSize = 10'000'000;
+    const size_t kNumQueries = 10'000'000;
+    std::vector<int> prices(kSize);
+    std::uniform_int_distribution<int> price_dist(0, 1'000'000);
+    for (int& price : prices) {
+        price = price_dist(rng);
+    }
+    std::cout << "Benchmark: " << kSize << " values" << std::endl;
+    // Ascending prices give a tree that's one long left chain
+    for (const std::string input_order : {"random", "ascending"}) {
+        if (input_order == "ascending") {
+            std::sort(prices.begin(), prices.end());
+        }
+        std::cout << "  " << input_order << ":" << std::endl;
+
+        std::unique_ptr<Node<int>> pointer_root;
+        const double pointer_seconds = TimeSeconds([&]() {
+            pointer_root = ConstructMaxTree(prices);
+        });
+        std::unique_ptr<IndexMaxTree<int>> index_tree;
+        const double index_seconds = TimeSeconds([&]() {
+            index_tree = std::make_unique<IndexMaxTree<int>>(prices);
+        });
+        std::unique_ptr<RangeMaxQuery<int>> rmq;
+        const double rmq_seconds = TimeSeconds([&]() {
+            rmq = std::make_unique<RangeMaxQuery<int>>(*index_tree);
+        });
+        std::unique_ptr<SparseTable<int>> sparse_table;
+        const double sparse_table_seconds = TimeSeconds([&]() {
+            sparse_table = std::make_unique<SparseTable<int>>(prices);
+        });
+        const bool same_tree = SameTree(pointer_root.get(), *index_tree);
+        DestroyTree(std::move(pointer_root));
+        std::cout << "    Build: pointer max tree " << pointer_seconds << " s ("
+                  << sizeof(Node<int>) << " bytes per node plus allocator overhead), "
+                  << "index max tree " << index_seconds << " s (12 bytes per value), "
+                  << (same_tree ? "same tree" : "DIFFERENT TREES") << std::endl;
+        std::cout << "    Build: range max query index " << rmq_seconds
+                  << " s on top of the tree (8 bytes per value), sparse table "
+                  << sparse_table_seconds << " s (" << 4 * (std::bit_width(kSize) - 1)
+                  << " bytes per value)" << std::endl;
+        if (!same_tree) {
+            return 1;
+        }
+
+        for (const size_t max_length : {size_t{64}, size_t{4096}, kSize}) {
+            const std::vector<std::pair<uint32_t, uint32_t>> queries =
+                    RandomQueries(kNumQueries, kSize, max_length, rng);
+            unsigned long long rmq_checksum = 0;
+            const double rmq_query_seconds = TimeSeconds([&]() {
+                for (const auto& [i, j] : queries) {
+                    rmq_checksum += rmq->MaxIndex(i, j);
+                }
+            });
+            unsigned long long sparse_table_checksum = 0;
+            const double sparse_table_query_seconds = TimeSeconds([&]() {
+                for (const auto& [i, j] : queries) {
+                    sparse_table_checksum += sparse_table->MaxIndex(i, j);
+                }
+            });
+            std::cout << "    " << kNumQueries << " queries of length "
+                      << (max_length < kSize ? "up to " + std::to_string(max_length) : "any")
+                      << ": range max query index " << kNumQueries / rmq_query_seconds / 1e6
+                      << " M/s, sparse table " << kNumQueries / sparse_table_query_seconds / 1e6
+                      << " M/s, "
+                      << (rmq_checksum == sparse_table_checksum ? "results match" : "MISMATCH")
+                      << std::endl;
+            if (rmq_checksum != sparse_table_checksum) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,596 @@
+/* Parallel reductions over a BinaryTree: whole-tree reductions (sums, maxima, ...), per-level
+ * reductions (e.g. the average of each level, from the Ch_08 Readme), and the search for
+ * root-to-leaf paths with a given sum (from this chapter's Readme).
+ *
+ * Each of these is a recursion over subtrees whose results are combined at the parent.  When
+ * a subtree is large, its right child's subtree is handed to another thread, if one is spare,
+ * while this thread does the left one.  Small subtrees are done sequentially.  This is the same
+ * scheme as polish_notation_parallel.cpp: a thread that finishes its subtree returns itself
+ * to the budget, and the next large subtree reached by any thread picks it up.
+ *
+ * The results never depend on the number of threads: subtree results are always combined in
+ * the same order, following the shape of the tree, no matter which thread computed them.
+ * This holds even when combining isn't associative, as with floating point addition.
+ *
+ * BinaryTree always builds complete trees, so the size of the subtree at (1-indexed) heap
+ * index i can be computed from i and the tree size in O(log n), without a pass over the
+ * tree to count nodes.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const std::vector<T>& v) {
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i];
+        if (i + 1 < v.size()) os << ", ";
+    }
+    os << "]";
+    return os;
+}
+
+template <typename T>
+struct Node {
+    std::unique_ptr<Node<T>> left_child_ptr;
+    std::unique_ptr<Node<T>> right_child_ptr;
+    Node<T>* parent_ptr_raw;
+    T value;
+};
+
+// A number of threads shared by fork-join tasks, as in polish_notation_parallel.cpp
+class ThreadBudget {
+  public:
+    explicit ThreadBudget(size_t num_threads)
+            : _spare_threads(static_cast<int>(std::max<size_t>(num_threads, 1)) - 1) {}
+
+    // Returns the pair (left(), right()).  right() runs on another thread if one is spare,
+    // otherwise both run on this thread, left() first.
+    template <typename LeftFunc, typename RightFunc>
+    auto ForkJoin(LeftFunc&& left, RightFunc&& right) {
+        using RightResult = decltype(right());
+        if (TryAcquireThread()) {
+            std::future<RightResult> right_future = std::async(std::launch::async,
+                    [this, &right]() {
+                        ThreadReleaser releaser(*this);
+                        return right();
+                    });
+            auto left_result = left();
+            return std::make_pair(std::move(left_result), right_future.get());
+        }
+        auto left_result = left();
+        return std::make_pair(std::move(left_result), right());
+    }
+
+  private:
+    // Gives an acquired thread back when the task that used it ends, even if the task throws
+    class ThreadReleaser {
+      public:
+        explicit ThreadReleaser(ThreadBudget& thread_budget) : _thread_budget(thread_budget) {}
+        ThreadReleaser(const ThreadReleaser&) = delete;
+        ThreadReleaser& operator=(const ThreadReleaser&) = delete;
+        ~ThreadReleaser() {
+            _thread_budget.ReleaseThread();
+        }
+
+      private:
+        ThreadBudget& _thread_budget;
+    };
+
+    bool TryAcquireThread() {
+        int spare = _spare_threads.load();
+        while (spare > 0) {
+            if (_spare_threads.compare_exchange_weak(spare, spare - 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void ReleaseThread() {
+        ++_spare_threads;
+    }
+
+    std::atomic<int> _spare_threads;
+};
+
+// Number of nodes in the subtree at (1-indexed) heap index i of a complete tree of n nodes:
+// at each level below i, the subtree covers a contiguous range of heap indices
+size_t CompleteSubtreeSize(size_t i, size_t n) {
+    size_t subtree_size = 0;
+    for (size_t first = i, last = i; first <= n; first = 2 * first, last = 2 * last + 1) {
+        subtree_size += std::min(last, n) - first + 1;
+    }
+    return subtree_size;
+}
+
+// Sum and number of values, for averages
+struct SumCount {
+    long long sum;
+    size_t count;
+};
+
+template <typename T>
+class BinaryTree {
+  public:
+    static constexpr size_t kDefaultSequentialCutoff = 1 << 14;
+
+    BinaryTree() {}
+
+    // Simple insert: inserts value at next available node to make complete tree
+    void insert(const T& value) {
+        std::vector<Node<T>*> path_to_inserted_node = FindNthNodePath(_size + 1);
+        path_to_inserted_node.back()->value = value;
+    }
+
+    size_t size() {
+        return _size;
+    }
+
+    // Reduces the tree in a fixed order that follows its shape: an empty subtree gives
+    // identity, and a node gives
+    //     combine(combine(result of left subtree, map(value)), result of right subtree)
+    // Subtrees of at least sequential_cutoff nodes are split between threads, but the result
+    // is the same for any number of threads (and any cutoff).  map and combine must be safe to
+    // call concurrently.
+    template <typename Result, typename Map, typename Combine>
+    Result Reduce(const Result& identity, Map&& map, Combine&& combine, size_t num_threads,
+                  size_t sequential_cutoff = kDefaultSequentialCutoff) const {
+        ThreadBudget thread_budget(num_threads);
+        return ReduceSubtree(_root.get(), 1, identity, map, combine, thread_budget,
+                             std::max<size_t>(sequential_cutoff, 1));
+    }
+
+    // Element d of the result is the reduction of the values at depth d, starting from
+    // identity.  Within a subtree done sequentially, each level is combined from left to
+    // right; results of larger subtrees are combined level by level as
+    // combine(left subtree's level, right subtree's level).  So the result is the same for
+    // any number of threads, for a given cutoff (and for any cutoff if combine is associative).
+    template <typename Result, typename Map, typename Combine>
+    std::vector<Result> ReduceLevels(const Result& identity, Map&& map, Combine&& combine,
+                                     size_t num_threads,
+                                     size_t sequential_cutoff = kDefaultSequentialCutoff) const {
+        ThreadBudget thread_budget(num_threads);
+        return ReduceLevelsSubtree(_root.get(), 1, identity, map, combine, thread_budget,
+                                   std::max<size_t>(sequential_cutoff, 1));
+    }
+
+    // Average of the values at each level, from the top
+    std::vector<double> LevelAverages(size_t num_threads,
+                                      size_t sequential_cutoff = kDefaultSequentialCutoff) const {
+        const std::vector<SumCount> level_sums = ReduceLevels(
+                SumCount{0, 0},
+                [](const T& value) { return SumCount{static_cast<long long>(value), 1}; },
+                [](const SumCount& a, const SumCount& b) {
+                    return SumCount{a.sum + b.sum, a.count + b.count};
+                },
+                num_threads, sequential_cutoff);
+        std::vector<double> level_averages;
+        for (const SumCount& level_sum : level_sums) {
+            level_averages.push_back(static_cast<double>(level_sum.sum) / level_sum.count);
+        }
+        return level_averages;
+    }
+
+    // Reference for LevelAverages, one level at a time as in operator<< of
+    // iterative_binary_tree_traversals.cpp
+    std::vector<double> LevelAveragesSequential() const {
+        std::vector<double> level_averages;
+        if (_root == nullptr) {
+            return level_averages;
+        }
+        std::vector<const Node<T>*> current_level_node_ptrs{_root.get()};
+        std::vector<const Node<T>*> next_level_node_ptrs;
+        while (current_level_node_ptrs.size() > 0) {
+            long long level_sum = 0;
+            for (const Node<T>* current_node_ptr : current_level_node_ptrs) {
+                level_sum += current_node_ptr->value;
+                if (current_node_ptr->left_child_ptr != nullptr) {
+                    next_level_node_ptrs.push_back(current_node_ptr->left_child_ptr.get());
+                }
+                if (current_node_ptr->right_child_ptr != nullptr) {
+                    next_level_node_ptrs.push_back(current_node_ptr->right_child_ptr.get());
+                }
+            }
+            level_averages.push_back(static_cast<double>(level_sum) /
+                                     current_level_node_ptrs.size());
+            current_level_node_ptrs = std::move(next_level_node_ptrs);
+            next_level_node_ptrs.clear();
+        }
+        return level_averages;
+    }
+
+    // All root-to-leaf paths whose values sum to target_sum, from left to right
+    std::vector<std::vector<T>> PathsWithSum(
+            const T& target_sum, size_t num_threads,
+            size_t sequential_cutoff = kDefaultSequentialCutoff) const {
+        std::vector<std::vector<T>> paths;
+        if (_root == nullptr) {
+            return paths;
+        }
+        ThreadBudget thread_budget(num_threads);
+        std::vector<T> path;
+        return PathsWithSumSubtree(_root.get(), 1, target_sum, T{}, path, thread_budget,
+                                   std::max<size_t>(sequential_cutoff, 1));
+    }
+
+    // Reference for PathsWithSum: a single depth-first search, keeping track of the current
+    // path and its sum, as described in the Readme
+    std::vector<std::vector<T>> PathsWithSumSequential(const T& target_sum) const {
+        std::vector<std::vector<T>> paths;
+        if (_root != nullptr) {
+            std::vector<T> path;
+            PathsWithSumSequentialRecursive(_root.get(), target_sum, T{}, path, paths);
+        }
+        return paths;
+    }
+
+  private:
+    template <typename Result, typename Map, typename Combine>
+    Result ReduceSubtree(const Node<T>* node_ptr, size_t heap_index, const Result& identity,
+                         Map& map, Combine& combine, ThreadBudget& thread_budget,
+                         size_t sequential_cutoff) const {
+        if (node_ptr == nullptr) {
+            return identity;
+        }
+        if (CompleteSubtreeSize(heap_index, _size) < sequential_cutoff) {
+            return ReduceSequential(node_ptr, identity, map, combine);
+        }
+        auto [left_result, right_result] = thread_budget.ForkJoin(
+                [&]() {
+                    return ReduceSubtree(node_ptr->left_child_ptr.get(), 2 * heap_index,
+                                         identity, map, combine, thread_budget,
+                                         sequential_cutoff);
+                },
+                [&]() {
+                    return ReduceSubtree(node_ptr->right_child_ptr.get(), 2 * heap_index + 1,
+                                         identity, map, combine, thread_budget,
+                                         sequential_cutoff);
+                });
+        return combine(combine(left_result, map(node_ptr->value)), right_result);
+    }
+
+    // Recursion depth is the height of the tree, which is log(n) for a complete tree
+    template <typename Result, typename Map, typename Combine>
+    static Result ReduceSequential(const Node<T>* node_ptr, const Result& identity, Map& map,
+                                   Combine& combine) {
+        if (node_ptr == nullptr) {
+            return identity;
+        }
+        Result result = ReduceSequential(node_ptr->left_child_ptr.get(), identity, map, combine);
+        result = combine(result, map(node_ptr->value));
+        return combine(result,
+                       ReduceSequential(node_ptr->right_child_ptr.get(), identity, map, combine));
+    }
+
+    template <typename Result, typename Map, typename Combine>
+    std::vector<Result> ReduceLevelsSubtree(const Node<T>* node_ptr, size_t heap_index,
+                                            const Result& identity, Map& map, Combine& combine,
+                                            ThreadBudget& thread_budget,
+                                            size_t sequential_cutoff) const {
+        std::vector<Result> level_results;
+        if (node_ptr == nullptr) {
+            return level_results;
+        }
+        if (CompleteSubtreeSize(heap_index, _size) < sequential_cutoff) {
+            ReduceLevelsSequential(node_ptr, 0, identity, map, combine, level_results);
+            return level_results;
+        }
+        auto [left_results, right_results] = thread_budget.ForkJoin(
+                [&]() {
+                    return ReduceLevelsSubtree(node_ptr->left_child_ptr.get(), 2 * heap_index,
+                                               identity, map, combine, thread_budget,
+                                               sequential_cutoff);
+                },
+                [&]() {
+                    return ReduceLevelsSubtree(node_ptr->right_child_ptr.get(),
+                                               2 * heap_index + 1, identity, map, combine,
+                                               thread_budget, sequential_cutoff);
+                });
+        level_results.push_back(combine(identity, map(node_ptr->value)));
+        for (size_t depth = 0; depth < std::max(left_results.size(), right_results.size());
+                ++depth) {
+            const Result& left_result =
+                    (depth < left_results.size()) ? left_results[depth] : identity;
+            const Result& right_result =
+                    (depth < right_results.size()) ? right_results[depth] : identity;
+            level_results.push_back(combine(left_result, right_result));
+        }
+        return level_results;
+    }
+
+    // Preorder, so that each level is visited from left to right
+    template <typename Result, typename Map, typename Combine>
+    static void ReduceLevelsSequential(const Node<T>* node_ptr, size_t depth,
+                                       const Result& identity, Map& map, Combine& combine,
+                                       std::vector<Result>& level_results) {
+        if (node_ptr == nullptr) {
+            return;
+        }
+        if (depth == level_results.size()) {
+            level_results.push_back(identity);
+        }
+        level_results[depth] = combine(level_results[depth], map(node_ptr->value));
+        ReduceLevelsSequential(node_ptr->left_child_ptr.get(), depth + 1, identity, map, combine,
+                               level_results);
+        ReduceLevelsSequential(node_ptr->right_child_ptr.get(), depth + 1, identity, map,
+                               combine, level_results);
+    }
+
+    // path and path_sum are those of the path down to (not including) node_ptr.  The right
+    // subtree gets its own copy of the path when it's handed to another thread.
+    std::vector<std::vector<T>> PathsWithSumSubtree(const Node<T>* node_ptr, size_t heap_index,
+                                                    const T& target_sum, const T& path_sum,
+                                                    std::vector<T>& path,
+                                                    ThreadBudget& thread_budget,
+                                                    size_t sequential_cutoff) const {
+        std::vector<std::vector<T>> paths;
+        const bool is_leaf =
+                (node_ptr->left_child_ptr == nullptr) && (node_ptr->right_child_ptr == nullptr);
+        if (is_leaf || (CompleteSubtreeSize(heap_index, _size) < sequential_cutoff)) {
+            PathsWithSumSequentialRecursive(node_ptr, target_sum, path_sum, path, paths);
+            return paths;
+        }
+        path.push_back(node_ptr->value);
+        const T child_path_sum = path_sum + node_ptr->value;
+        std::vector<T> right_path = path;
+        auto [left_paths, right_paths] = thread_budget.ForkJoin(
+                [&]() {
+                    if (node_ptr->left_child_ptr == nullptr) {
+                        return std::vector<std::vector<T>>();
+                    }
+                    return PathsWithSumSubtree(node_ptr->left_child_ptr.get(), 2 * heap_index,
+                                               target_sum, child_path_sum, path, thread_budget,
+                                               sequential_cutoff);
+                },
+                [&]() {
+                    if (node_ptr->right_child_ptr == nullptr) {
+                        return std::vector<std::vector<T>>();
+                    }
+                    return PathsWithSumSubtree(node_ptr->right_child_ptr.get(),
+                                               2 * heap_index + 1, target_sum, child_path_sum,
+                                               right_path, thread_budget, sequential_cutoff);
+                });
+        path.pop_back();
+        paths = std::move(left_paths);
+        paths.insert(paths.end(), std::make_move_iterator(right_paths.begin()),
+                     std::make_move_iterator(right_paths.end()));
+        return paths;
+    }
+
+    static void PathsWithSumSequentialRecursive(const Node<T>* node_ptr, const T& target_sum,
+                                                const T& path_sum, std::vector<T>& path,
+                                                std::vector<std::vector<T>>& paths) {
+        path.push_back(node_ptr->value);
+        const T new_path_sum = path_sum + node_ptr->value;
+        if ((node_ptr->left_child_ptr == nullptr) && (node_ptr->right_child_ptr == nullptr)) {
+            if (new_path_sum == target_sum) {
+                paths.push_back(path);
+            }
+        }
+        if (node_ptr->left_child_ptr != nullptr) {
+            PathsWithSumSequentialRecursive(node_ptr->left_child_ptr.get(), target_sum,
+                                            new_path_sum, path, paths);
+        }
+        if (node_ptr->right_child_ptr != nullptr) {
+            PathsWithSumSequentialRecursive(node_ptr->right_child_ptr.get(), target_sum,
+                                            new_path_sum, path, paths);
+        }
+        path.pop_back();
+    }
+
+    // Retrieve the nth node in the tree assuming the tree is complete,
+    // inserting a new node if it does not exist (and any nodes along the path).
+    // Return a vector of the nodes along the path from route to the nth node.
+    // Note: n is 1-indexed here, as it makes the math easier!
+    std::vector<Node<T>*> FindNthNodePath(size_t n) {
+        size_t modulus = 1;
+        while (n / modulus > 1) {
+            modulus *= 2;
+        }
+        std::vector<Node<T>*> path_vector;
+        Node<T>* current_node_ptr = _root.get();
+        if (_root == nullptr) {
+            _root = std::make_unique<Node<T>>();
+            ++_size;
+            current_node_ptr = _root.get();
+        }
+        path_vector.push_back(current_node_ptr);
+        for (/* modulus */; modulus > 1; modulus /= 2) {
+            if ((n % modulus) < (modulus / 2)) {  // left
+                if (current_node_ptr->left_child_ptr == nullptr) {
+                    current_node_ptr->left_child_ptr = std::make_unique<Node<T>>();
+                    ++_size;
+                }
+                current_node_ptr = current_node_ptr->left_child_ptr.get();
+            } else {  // right
+                if (current_node_ptr->right_child_ptr == nullptr) {
+                    current_node_ptr->right_child_ptr = std::make_unique<Node<T>>();
+                    ++_size;
+                }
+                current_node_ptr = current_node_ptr->right_child_ptr.get();
+            }
+            path_vector.push_back(current_node_ptr);
+        }
+        return path_vector;
+    }
+
+    std::unique_ptr<Node<T>> _root;
+    size_t _size = 0;
+};
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+// Floating point results must match bit for bit
+bool BitwiseEqual(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+// Sum of square roots: floating point addition isn't associative, so this checks that the
+// order of combination doesn't depend on the threads
+double SumOfSquareRoots(const BinaryTree<int>& tree, size_t num_threads,
+                        size_t sequential_cutoff = BinaryTree<int>::kDefaultSequentialCutoff) {
+    return tree.Reduce(
+            0.0, [](int value) { return std::sqrt(std::abs(static_cast<double>(value))); },
+            [](double a, double b) { return a + b; }, num_threads, sequential_cutoff);
+}
+
+long long Sum(const BinaryTree<int>& tree, size_t num_threads) {
+    return tree.Reduce(
+            0LL, [](int value) { return static_cast<long long>(value); },
+            [](long long a, long long b) { return a + b; }, num_threads);
+}
+
+int main() {
+    std::vector<int> test_values{
+            1,
+            9, 3,
+            12, 50, 100, 5,
+            13, 16, 51, 200, 101, 102, 6, 999};
+    BinaryTree<int> test_tree;
+    for (const int value : test_values) {
+        test_tree.insert(value);
+    }
+    std::cout << "Sum: " << Sum(test_tree, 4) << std::endl;
+    std::cout << "Level averages: " << test_tree.LevelAverages(4, /*sequential_cutoff=*/2)
+              << std::endl;
+    std::cout << "Paths with sum 35: " << test_tree.PathsWithSum(35, 4, /*sequential_cutoff=*/2)
+              << std::endl << std::endl;
+
+    // Small trees of every size, split as finely as possible, against the references
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> small_value_dist(-3, 3);
+    BinaryTree<int> small_tree;
+    std::vector<int> small_values;
+    for (int size = 1; size <= 300; ++size) {
+        small_values.push_back(small_value_dist(rng));
+        small_tree.insert(small_values.back());
+        long long expected_sum = 0;
+        for (const int value : small_values) {
+            expected_sum += value;
+        }
+        const int expected_max = *std::max_element(small_values.begin(), small_values.end());
+        for (const size_t num_threads : {1, 3, 8}) {
+            const long long sum = small_tree.Reduce(
+                    0LL, [](int value) { return static_cast<long long>(value); },
+                    [](long long a, long long b) { return a + b; }, num_threads, 1);
+            const int max = small_tree.Reduce(
+                    -1000, [](int value) { return value; },
+                    [](int a, int b) { return std::max(a, b); }, num_threads, 1);
+            if ((sum != expected_sum) || (max != expected_max) ||
+                    !BitwiseEqual(SumOfSquareRoots(small_tree, num_threads, 1),
+                                  SumOfSquareRoots(small_tree, 1)) ||
+                    (small_tree.LevelAverages(num_threads, 1) !=
+                     small_tree.LevelAveragesSequential()) ||
+                    (small_tree.PathsWithSum(0, num_threads, 1) !=
+                     small_tree.PathsWithSumSequential(0))) {
+                std::cout << "MISMATCH for tree of " << size << " nodes, " << num_threads
+                          << " threads" << std::endl;
+                return 1;
+            }
+        }
+    }
+    std::cout << "Trees of 1-300 nodes: all results match the sequential references"
+              << std::endl;
+
+    // A forked task that throws must still give its thread back: with a budget of 2 threads,
+    // the next fork must run on another thread again
+    ThreadBudget thread_budget(2);
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        try {
+            thread_budget.ForkJoin([]() { return 0; },
+                                   []() -> int { throw std::runtime_error("right failed"); });
+            std::cout << "MISSING EXCEPTION from ForkJoin" << std::endl;
+            return 1;
+        } catch (const std::runtime_error&) {
+        }
+    }
+    const auto [main_thread_id, forked_thread_id] =
+            thread_budget.ForkJoin([]() { return std::this_thread::get_id(); },
+                                   []() { return std::this_thread::get_id(); });
+    if (main_thread_id == forked_thread_id) {
+        std::cout << "THREAD LEAKED: ForkJoin no longer forks after exceptions" << std::endl;
+        return 1;
+    }
+    std::cout << "ForkJoin gives threads back when the forked task throws" << std::endl
+              << std::endl;
+
+    const size_t kSize = 10'000'000;
+    std::uniform_int_distribution<int> value_dist(-10, 10);
+    BinaryTree<int> tree;
+    for (size_t i = 0; i < kSize; ++i) {
+        tree.insert(value_dist(rng));
+    }
+    std::cout << "Benchmark: complete tree of " << kSize << " nodes" << std::endl;
+
+    long long sequential_sum = 0;
+    double sequential_root_sum = 0;
+    std::vector<double> sequential_averages;
+    std::vector<std::vector<int>> sequential_paths;
+    const double sum_seconds = TimeSeconds([&]() {
+        sequential_sum = Sum(tree, 1);
+    });
+    const double root_sum_seconds = TimeSeconds([&]() {
+        sequential_root_sum = SumOfSquareRoots(tree, 1);
+    });
+    const double averages_seconds = TimeSeconds([&]() {
+        sequential_averages = tree.LevelAveragesSequential();
+    });
+    const double paths_seconds = TimeSeconds([&]() {
+        sequential_paths = tree.PathsWithSumSequential(0);
+    });
+    std::cout << "    Sequential: sum " << sum_seconds << " s, sum of square roots "
+              << root_sum_seconds << " s, level averages " << averages_seconds
+              << " s, paths with sum 0 " << paths_seconds << " s (" << sequential_paths.size()
+              << " paths)" << std::endl;
+
+    const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t num_threads = 1; num_threads <= std::max<size_t>(max_threads, 16);
+            num_threads *= 2) {
+        long long sum = 0;
+        double root_sum = 0;
+        std::vector<double> averages;
+        std::vector<std::vector<int>> paths;
+        const double parallel_sum_seconds = TimeSeconds([&]() {
+            sum = Sum(tree, num_threads);
+        });
+        const double parallel_root_sum_seconds = TimeSeconds([&]() {
+            root_sum = SumOfSquareRoots(tree, num_threads);
+        });
+        const double parallel_averages_seconds = TimeSeconds([&]() {
+            averages = tree.LevelAverages(num_threads);
+        });
+        const double parallel_paths_seconds = TimeSeconds([&]() {
+            paths = tree.PathsWithSum(0, num_threads);
+        });
+        const bool results_match = (sum == sequential_sum) &&
+                BitwiseEqual(root_sum, sequential_root_sum) &&
+                (averages == sequential_averages) && (paths == sequential_paths);
+        std::cout << "    " << num_threads << " thread(s): sum " << parallel_sum_seconds
+                  << " s, sum of square roots " << parallel_root_sum_seconds
+                  << " s, level averages " << parallel_averages_seconds
+                  << " s, paths with sum 0 " << parallel_paths_seconds << " s, "
+                  << (results_match ? "results match" : "MISMATCH") << std::endl;
+    }
+    std::cout << "(hardware threads available: " << max_threads << ")" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+/* Memoized and bottom-up versions of foo from recursive_iterative_translation.cpp.
+ *
+ * foo(value) calls foo(value / 2) and foo(value - 3), and both of those go on to solve many
+ * of the same subproblems again: the number of calls grows faster than any polynomial
+ * (about 1e3 calls for foo(100), 1e5 for foo(300) and 1e8 for foo(1000)), while there are
+ * only value + 1 distinct subproblems.
+ *
+ * Memoized: the explicit-stack machine of foo_iterative, where a Start frame first checks
+ * a cache of finished results, and pushes the cached result instead of expanding if there is
+ * one.  A frame finishes at line C (or in the base case), which is where its result goes into
+ * the cache.  Every value is expanded at most once, so it's O(value) time and space.
+ *
+ * Tabulated: since every subproblem of foo(value) is smaller than value, we can just fill in
+ * foo(0), foo(1), ..., foo(value) in order, each from two entries already in the table.
+ *
+ * foo's results overflow an int for inputs around 1500, so the functions here take the result
+ * type as a template parameter.  With an unsigned type, results wrap around (mod 2^64 for
+ * uint64_t), which is well defined and the same for all versions.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// foo_recursive from recursive_iterative_translation.cpp without the tracing output, kept
+// here as the reference for correctness checks and benchmarking
+template <typename Result>
+Result foo_recursive(int value) {
+    if (value < 10) {
+        return value;
+    }
+    const Result a = foo_recursive<Result>(value / 2);
+    const Result b = foo_recursive<Result>(value - 3);
+    return a + b;
+}
+
+// foo_iterative from recursive_iterative_translation.cpp without the tracing output, with an
+// optional cache of the results of finished Start frames
+template <typename Result>
+Result foo_iterative(int input_value, bool memoize = false) {
+    enum class NextLine { Start, A, B, C };
+    std::vector<std::pair<int, NextLine>> call_stack;
+    call_stack.emplace_back(input_value, NextLine::Start);
+    std::vector<Result> return_value_stack;
+    // cache[value] is foo(value) if is_cached[value] (only for values >= 10)
+    std::vector<Result> cache;
+    std::vector<bool> is_cached;
+    if (memoize && (input_value >= 10)) {
+        cache.resize(input_value + 1);
+        is_cached.resize(input_value + 1);
+    }
+    while (!call_stack.empty()) {
+        // By value: the reference would dangle once the frame is popped
+        const auto [value, next_line] = call_stack.back();
+        call_stack.pop_back();
+        if (next_line == NextLine::Start) {
+            if (value < 10) {
+                return_value_stack.push_back(value);
+            } else if (memoize && is_cached[value]) {
+                // Already solved: return the cached result instead of expanding the call
+                return_value_stack.push_back(cache[value]);
+            } else {
+                call_stack.emplace_back(value, NextLine::A);
+            }
+        } else if (next_line == NextLine::A) {
+            call_stack.emplace_back(value, NextLine::B);
+            call_stack.emplace_back(value / 2, NextLine::Start);
+        } else if (next_line == NextLine::B) {
+            call_stack.emplace_back(value, NextLine::C);
+            call_stack.emplace_back(value - 3, NextLine::Start);
+        } else if (next_line == NextLine::C) {
+            const Result b = return_value_stack.back();
+            return_value_stack.pop_back();
+            const Result a = return_value_stack.back();
+            return_value_stack.pop_back();
+            // The frame for value is finished here
+            if (memoize) {
+                cache[value] = a + b;
+                is_cached[value] = true;
+            }
+            return_value_stack.push_back(a + b);
+        }
+    }
+    return return_value_stack.back();
+}
+
+// Bottom-up: foo(v) for v = 0, 1, ..., value
+template <typename Result>
+Result foo_tabulated(int value) {
+    if (value < 10) {
+        return value;
+    }
+    std::vector<Result> table(value + 1);
+    for (int v = 0; v <= value; ++v) {
+        table[v] = (v < 10) ? static_cast<Result>(v) : table[v / 2] + table[v - 3];
+    }
+    return table[value];
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+int main() {
+    std::cout << "foo(20): recursive " << foo_recursive<int>(20) << ", iterative "
+              << foo_iterative<int>(20) << ", memoized " << foo_iterative<int>(20, true)
+              << ", tabulated " << foo_tabulated<int>(20) << std::endl << std::endl;
+
+    // All versions must agree, for every input where an int doesn't overflow (and a few
+    // negative ones, which are base cases)
+    for (int value = -5; value <= 1000; ++value) {
+        const int expected = foo_recursive<int>(value);
+        if (((value <= 400) && (foo_iterative<int>(value) != expected)) ||
+                (foo_iterative<int>(value, true) != expected) ||
+                (foo_tabulated<int>(value) != expected)) {
+            std::cout << "MISMATCH for foo(" << value << ")" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "foo(-5..1000): memoized and tabulated versions match the recursive one "
+              << "(and so does the plain iterative one, up to 400)" << std::endl << std::endl;
+
+    std::cout << "Benchmark (uint64_t results):" << std::endl;
+    for (const int value : {100, 200, 400, 800, 1000, 1200, 10'000, 1'000'000, 10'000'000}) {
+        const bool run_exponential = (value <= 1200);
+        uint64_t recursive_result = 0;
+        uint64_t iterative_result = 0;
+        uint64_t memoized_result = 0;
+        uint64_t tabulated_result = 0;
+        std::string timings;
+        if (run_exponential) {
+            const double recursive_seconds = TimeSeconds([&]() {
+                recursive_result = foo_recursive<uint64_t>(value);
+            });
+            const double iterative_seconds = TimeSeconds([&]() {
+                iterative_result = foo_iterative<uint64_t>(value);
+            });
+            timings += "recursive " + std::to_string(recursive_seconds) + " s, iterative " +
+                       std::to_string(iterative_seconds) + " s, ";
+        }
+        const double memoized_seconds = TimeSeconds([&]() {
+            memoized_result = foo_iterative<uint64_t>(value, true);
+        });
+        const double tabulated_seconds = TimeSeconds([&]() {
+            tabulated_result = foo_tabulated<uint64_t>(value);
+        });
+        timings += "memoized " + std::to_string(memoized_seconds) + " s, tabulated " +
+                   std::to_string(tabulated_seconds) + " s";
+        const bool results_match = (memoized_result == tabulated_result) &&
+                (!run_exponential || ((recursive_result == tabulated_result) &&
+                                      (iterative_result == tabulated_result)));
+        std::cout << "    foo(" << value << "): " << timings << ", "
+                  << (results_match ? "results match" : "MISMATCH") << std::endl;
+    }
+
+    return 0;
+}
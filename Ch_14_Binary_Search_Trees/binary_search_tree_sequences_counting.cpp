@@ -0,0 +1,1010 @@
+/* Counting, ranking, unranking and uniform sampling of BST sequences (see
+ * binary_search_tree_sequences.cpp), without enumerating them.
+ *
+ * Counting: each sequence of a node's subtree is the node, followed by some interleaving of
+ * one of the left subtree's sequences with one of the right subtree's sequences.  Every
+ * choice of the three gives a different sequence, so
+ *     count(node) = count(left) * count(right) * binomial(left size + right size, left size),
+ * which works out to n! / (product of all the subtree sizes).  These numbers are huge (a
+ * complete tree of 4095 nodes has over 10^11000 sequences), so they are BigUnsigned.
+ *
+ * Ranking: BstSequences orders a node's sequences by left subtree sequence, then right
+ * subtree sequence, then interleaving.  GenerateInterleavedSequencesRecursive produces the
+ * interleavings in lexicographic order of their patterns of L's and R's (which subtree each
+ * position is taken from), with L < R.  So a sequence's rank is a mixed-radix number:
+ *     rank = (left rank * count(right) + right rank) * binomial(...) + pattern rank,
+ * and unranking peels the digits back off with two divisions.  A pattern's rank is built one
+ * position at a time: of the B patterns with a L's and b R's, B * a / (a + b) start with L.
+ *
+ * Sampling: the digits are independent, so choosing each node's pattern uniformly at random
+ * (by shuffling its L's and R's) gives a uniformly random sequence.
+ *
+ * Everything is polynomial in the number of nodes: the big numbers have O(n log n) bits.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <compare>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+template <typename T>
+void GenerateInterleavedSequencesRecursive(
+        const std::vector<T>& input_sequence_a,
+        const std::vector<T>& input_sequence_b,
+        std::vector<T>& current_sequence,
+        size_t i,
+        size_t j,
+        std::vector<std::vector<T>>& generated_sequences);
+
+template <typename T>
+std::vector<std::vector<T>> GenerateInterleavedSequences(
+        const std::vector<T>& sequence, const std::vector<T>& other_sequence) {
+    std::vector<T> current_sequence;
+    size_t i = 0;
+    size_t j = 0;
+    std::vector<std::vector<T>> generated_sequences;
+    GenerateInterleavedSequencesRecursive(
+            sequence, other_sequence, current_sequence, i, j, generated_sequences);
+    return generated_sequences;
+}
+
+template <typename T>
+void GenerateInterleavedSequencesRecursive(
+        const std::vector<T>& input_sequence_a,
+        const std::vector<T>& input_sequence_b,
+        std::vector<T>& current_sequence,
+        size_t i,
+        size_t j,
+        std::vector<std::vector<T>>& generated_sequences) {
+    if (i < input_sequence_a.size()) {
+        current_sequence.emplace_back(input_sequence_a[i]);
+        GenerateInterleavedSequencesRecursive(
+                input_sequence_a, input_sequence_b, current_sequence,
+                i + 1, j, generated_sequences);
+        current_sequence.pop_back();
+    }
+    if (j < input_sequence_b.size()) {
+        current_sequence.emplace_back(input_sequence_b[j]);
+        GenerateInterleavedSequencesRecursive(
+                input_sequence_a, input_sequence_b, current_sequence,
+                i, j + 1, generated_sequences);
+        current_sequence.pop_back();
+    }
+    if ((i == input_sequence_a.size()) && (j == input_sequence_b.size())) {
+        generated_sequences.emplace_back(current_sequence);
+    }
+}
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const std::vector<T>& v) {
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i];
+        if (i + 1 < v.size()) os << ", ";
+    }
+    os << "]";
+    return os;
+}
+
+template <typename T>
+struct Node {
+    std::unique_ptr<Node<T>> left_child_ptr;
+    std::unique_ptr<Node<T>> right_child_ptr;
+    Node<T>* parent_ptr_raw;
+    T value;
+};
+
+// Arbitrary-precision unsigned integer, with just the operations needed here.  Stored as
+// little-endian 32-bit limbs with no leading zero limbs, so zero has no limbs at all.
+class BigUnsigned {
+  public:
+    BigUnsigned() {}
+
+    BigUnsigned(uint64_t value) {
+        while (value != 0) {
+            _limbs.push_back(static_cast<uint32_t>(value));
+            value >>= 32;
+        }
+    }
+
+    bool is_zero() const {
+        return _limbs.empty();
+    }
+
+    size_t bit_length() const {
+        return _limbs.empty() ? 0 : 32 * _limbs.size() - std::countl_zero(_limbs.back());
+    }
+
+    friend bool operator==(const BigUnsigned& a, const BigUnsigned& b) = default;
+
+    friend std::strong_ordering operator<=>(const BigUnsigned& a, const BigUnsigned& b) {
+        if (a._limbs.size() != b._limbs.size()) {
+            return a._limbs.size() <=> b._limbs.size();
+        }
+        for (size_t i = a._limbs.size(); i-- > 0;) {
+            if (a._limbs[i] != b._limbs[i]) {
+                return a._limbs[i] <=> b._limbs[i];
+            }
+        }
+        return std::strong_ordering::equal;
+    }
+
+    BigUnsigned& operator+=(const BigUnsigned& other) {
+        if (_limbs.size() < other._limbs.size()) {
+            _limbs.resize(other._limbs.size(), 0);
+        }
+        uint64_t carry = 0;
+        for (size_t i = 0; i < _limbs.size(); ++i) {
+            if ((i >= other._limbs.size()) && (carry == 0)) {
+                break;
+            }
+            carry += _limbs[i];
+            if (i < other._limbs.size()) {
+                carry += other._limbs[i];
+            }
+            _limbs[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        if (carry != 0) {
+            _limbs.push_back(static_cast<uint32_t>(carry));
+        }
+        return *this;
+    }
+
+    // Requires *this >= other
+    BigUnsigned& operator-=(const BigUnsigned& other) {
+        uint32_t borrow = 0;
+        for (size_t i = 0; i < _limbs.size(); ++i) {
+            if ((i >= other._limbs.size()) && (borrow == 0)) {
+                break;
+            }
+            const uint64_t subtrahend =
+                    uint64_t{borrow} + (i < other._limbs.size() ? other._limbs[i] : 0);
+            borrow = (_limbs[i] < subtrahend);
+            _limbs[i] = static_cast<uint32_t>(_limbs[i] - subtrahend);
+        }
+        Trim();
+        return *this;
+    }
+
+    BigUnsigned& operator*=(uint32_t factor) {
+        uint64_t carry = 0;
+        for (uint32_t& limb : _limbs) {
+            carry += uint64_t{limb} * factor;
+            limb = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        if (carry != 0) {
+            _limbs.push_back(static_cast<uint32_t>(carry));
+        }
+        Trim();
+        return *this;
+    }
+
+    friend BigUnsigned operator*(const BigUnsigned& a, const BigUnsigned& b) {
+        BigUnsigned product;
+        if (a.is_zero() || b.is_zero()) {
+            return product;
+        }
+        product._limbs.assign(a._limbs.size() + b._limbs.size(), 0);
+        for (size_t i = 0; i < a._limbs.size(); ++i) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < b._limbs.size(); ++j) {
+                carry += uint64_t{a._limbs[i]} * b._limbs[j] + product._limbs[i + j];
+                product._limbs[i + j] = static_cast<uint32_t>(carry);
+                carry >>= 32;
+            }
+            product._limbs[i + b._limbs.size()] = static_cast<uint32_t>(carry);
+        }
+        product.Trim();
+        return product;
+    }
+
+    // Divides in place, returning the remainder (divisor must not be zero)
+    uint32_t DivideSmall(uint32_t divisor) {
+        uint64_t remainder = 0;
+        for (size_t i = _limbs.size(); i-- > 0;) {
+            const uint64_t current = (remainder << 32) | _limbs[i];
+            _limbs[i] = static_cast<uint32_t>(current / divisor);
+            remainder = current % divisor;
+        }
+        Trim();
+        return static_cast<uint32_t>(remainder);
+    }
+
+    // Sets quotient and remainder of dividend / divisor (divisor must not be zero), using
+    // Knuth's Algorithm D (The Art of Computer Programming, vol. 2, section 4.3.1)
+    static void DivMod(const BigUnsigned& dividend, const BigUnsigned& divisor,
+                       BigUnsigned* quotient, BigUnsigned* remainder) {
+        if (dividend < divisor) {
+            *remainder = dividend;
+            *quotient = BigUnsigned();
+            return;
+        }
+        if (divisor._limbs.size() == 1) {
+            BigUnsigned result = dividend;
+            *remainder = BigUnsigned(result.DivideSmall(divisor._limbs[0]));
+            *quotient = std::move(result);
+            return;
+        }
+        // Normalize so the divisor's top bit is set, which makes each quotient digit estimate
+        // off by at most 2
+        const size_t n = divisor._limbs.size();
+        const size_t m = dividend._limbs.size() - n;
+        const int shift = std::countl_zero(divisor._limbs.back());
+        std::vector<uint32_t> v = ShiftedLeft(divisor._limbs, shift);
+        std::vector<uint32_t> u = ShiftedLeft(dividend._limbs, shift);
+        u.resize(m + n + 1, 0);
+        if (shift > 0) {
+            u[m + n] = dividend._limbs.back() >> (32 - shift);
+        }
+        BigUnsigned result;
+        result._limbs.assign(m + 1, 0);
+        for (size_t j = m + 1; j-- > 0;) {
+            const uint64_t numerator = (uint64_t{u[j + n]} << 32) | u[j + n - 1];
+            uint64_t q_hat = numerator / v[n - 1];
+            uint64_t r_hat = numerator % v[n - 1];
+            while (((q_hat >> 32) != 0) ||
+                    (q_hat * v[n - 2] > ((r_hat << 32) | u[j + n - 2]))) {
+                --q_hat;
+                r_hat += v[n - 1];
+                if ((r_hat >> 32) != 0) {
+                    break;
+                }
+            }
+            // u[j, j + n] -= q_hat * v
+            int64_t borrow = 0;
+            int64_t difference = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const uint64_t product = q_hat * v[i];
+                difference = int64_t{u[i + j]} - borrow - static_cast<int64_t>(product & 0xFFFFFFFF);
+                u[i + j] = static_cast<uint32_t>(difference);
+                borrow = static_cast<int64_t>(product >> 32) - (difference >> 32);
+            }
+            difference = int64_t{u[j + n]} - borrow;
+            u[j + n] = static_cast<uint32_t>(difference);
+            result._limbs[j] = static_cast<uint32_t>(q_hat);
+            if (difference < 0) {  // q_hat was one too large: add v back
+                --result._limbs[j];
+                uint64_t carry = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    carry += uint64_t{u[i + j]} + v[i];
+                    u[i + j] = static_cast<uint32_t>(carry);
+                    carry >>= 32;
+                }
+                u[j + n] += static_cast<uint32_t>(carry);
+            }
+        }
+        result.Trim();
+        // The remainder is what's left of u, shifted back
+        remainder->_limbs.assign(n, 0);
+        for (size_t i = 0; i < n; ++i) {
+            remainder->_limbs[i] = u[i] >> shift;
+            if (shift > 0) {
+                remainder->_limbs[i] |= u[i + 1] << (32 - shift);
+            }
+        }
+        remainder->Trim();
+        *quotient = std::move(result);
+    }
+
+    // Uniformly random number in [0, bound) (bound must not be zero)
+    template <typename Rng>
+    static BigUnsigned RandomBelow(const BigUnsigned& bound, Rng& rng) {
+        const size_t num_top_bits = bound.bit_length() % 32;
+        std::uniform_int_distribution<uint32_t> limb_dist;
+        BigUnsigned result;
+        do {
+            result._limbs.resize(bound._limbs.size());
+            for (uint32_t& limb : result._limbs) {
+                limb = limb_dist(rng);
+            }
+            if (num_top_bits != 0) {
+                result._limbs.back() &= (uint32_t{1} << num_top_bits) - 1;
+            }
+            result.Trim();
+        } while (result >= bound);
+        return result;
+    }
+
+    std::string to_string() const {
+        if (is_zero()) {
+            return "0";
+        }
+        // Base 10^9 digits, least significant first
+        std::vector<uint32_t> chunks;
+        BigUnsigned rest = *this;
+        while (!rest.is_zero()) {
+            chunks.push_back(rest.DivideSmall(1'000'000'000));
+        }
+        std::string result = std::to_string(chunks.back());
+        for (size_t i = chunks.size() - 1; i-- > 0;) {
+            const std::string chunk = std::to_string(chunks[i]);
+            result += std::string(9 - chunk.size(), '0') + chunk;
+        }
+        return result;
+    }
+
+  private:
+    static std::vector<uint32_t> ShiftedLeft(const std::vector<uint32_t>& limbs, int shift) {
+        std::vector<uint32_t> shifted(limbs.size());
+        for (size_t i = 0; i < limbs.size(); ++i) {
+            shifted[i] = limbs[i] << shift;
+            if ((shift > 0) && (i > 0)) {
+                shifted[i] |= limbs[i - 1] >> (32 - shift);
+            }
+        }
+        return shifted;
+    }
+
+    void Trim() {
+        while (!_limbs.empty() && (_limbs.back() == 0)) {
+            _limbs.pop_back();
+        }
+    }
+
+    std::vector<uint32_t> _limbs;
+};
+
+std::ostream& operator<<(std::ostream& os, const BigUnsigned& value) {
+    return os << value.to_string();
+}
+
+// Number of ways to choose k of n things
+BigUnsigned Binomial(size_t n, size_t k) {
+    k = std::min(k, n - k);
+    BigUnsigned result(1);
+    // After step i, result = binomial(n - k + i, i)
+    for (size_t i = 1; i <= k; ++i) {
+        result *= static_cast<uint32_t>(n - k + i);
+        result.DivideSmall(static_cast<uint32_t>(i));
+    }
+    return result;
+}
+
+// Counts, ranks, unranks and samples the BST sequences of the tree rooted at root_ptr without
+// enumerating them.  Ranks follow the order of BinaryTree::BstSequences.  The tree must not
+// change while the ranker is in use.
+template <typename T>
+class BstSequenceRanker {
+  public:
+    explicit BstSequenceRanker(const Node<T>* root_ptr) {
+        // Number the nodes in preorder
+        std::vector<const Node<T>*> node_stack;
+        if (root_ptr != nullptr) {
+            node_stack.push_back(root_ptr);
+        }
+        std::vector<bool> has_left_child;
+        std::vector<bool> has_right_child;
+        while (!node_stack.empty()) {
+            const Node<T>* node_ptr = node_stack.back();
+            node_stack.pop_back();
+            _node_values.push_back(node_ptr->value);
+            has_left_child.push_back(node_ptr->left_child_ptr != nullptr);
+            has_right_child.push_back(node_ptr->right_child_ptr != nullptr);
+            if (node_ptr->right_child_ptr != nullptr) {
+                node_stack.push_back(node_ptr->right_child_ptr.get());
+            }
+            if (node_ptr->left_child_ptr != nullptr) {
+                node_stack.push_back(node_ptr->left_child_ptr.get());
+            }
+        }
+        // In preorder, node v's left child is v + 1 and its right child comes right after
+        // the left subtree, so everything can be filled in from the back
+        const size_t n = _node_values.size();
+        _left_size.assign(n, 0);
+        _subtree_size.assign(n, 1);
+        _num_interleavings.resize(n);
+        _num_sequences.resize(n);
+        for (size_t v = n; v-- > 0;) {
+            _left_size[v] = has_left_child[v] ? _subtree_size[v + 1] : 0;
+            const size_t right_child = v + 1 + _left_size[v];
+            const size_t right_size = has_right_child[v] ? _subtree_size[right_child] : 0;
+            _subtree_size[v] = 1 + _left_size[v] + right_size;
+            _num_interleavings[v] = Binomial(_left_size[v] + right_size, _left_size[v]);
+            _num_sequences[v] = _num_interleavings[v];
+            if (has_left_child[v]) {
+                _num_sequences[v] = _num_sequences[v] * _num_sequences[v + 1];
+            }
+            if (has_right_child[v]) {
+                _num_sequences[v] = _num_sequences[v] * _num_sequences[right_child];
+            }
+        }
+        if (n > 0) {
+            _count = _num_sequences[0];
+        }
+    }
+
+    // Number of sequences
+    const BigUnsigned& count() const {
+        return _count;
+    }
+
+    // The sequence at index rank of BstSequences (rank must be less than count())
+    std::vector<T> Unrank(const BigUnsigned& rank) const {
+        // Start from the preorder sequence, where every subtree occupies the positions of its
+        // own node numbers; UnrankRecursive rearranges each subtree within those positions
+        std::vector<size_t> sequence(_node_values.size());
+        std::iota(sequence.begin(), sequence.end(), 0);
+        if (!sequence.empty()) {
+            UnrankRecursive(0, rank, sequence);
+        }
+        return ToValues(sequence);
+    }
+
+    // Index of sequence in BstSequences.  The tree's values must be distinct (as in a BST),
+    // and sequence must be one of its BST sequences.
+    BigUnsigned Rank(const std::vector<T>& sequence) const {
+        std::map<T, size_t> node_of_value;
+        for (size_t v = 0; v < _node_values.size(); ++v) {
+            node_of_value[_node_values[v]] = v;
+        }
+        std::vector<size_t> nodes;
+        nodes.reserve(sequence.size());
+        for (const T& value : sequence) {
+            nodes.push_back(node_of_value.at(value));
+        }
+        return nodes.empty() ? BigUnsigned() : RankRecursive(0, nodes, 0);
+    }
+
+    // Uniformly random sequence
+    template <typename Rng>
+    std::vector<T> Sample(Rng& rng) const {
+        std::vector<size_t> sequence(_node_values.size());
+        std::iota(sequence.begin(), sequence.end(), 0);
+        std::vector<char> pattern;
+        std::vector<size_t> interleaved;
+        // Children before parents, so each subtree is arranged within its own positions (as in
+        // Unrank) before its parent interleaves it with its sibling
+        for (size_t v = sequence.size(); v-- > 0;) {
+            const size_t num_left = _left_size[v];
+            const size_t num_right = _subtree_size[v] - 1 - num_left;
+            if ((num_left == 0) || (num_right == 0)) {
+                continue;
+            }
+            pattern.assign(num_left, false);
+            pattern.resize(num_left + num_right, true);
+            std::shuffle(pattern.begin(), pattern.end(), rng);
+            interleaved.clear();
+            size_t next_left = v + 1;
+            size_t next_right = v + 1 + num_left;
+            for (const char is_right : pattern) {
+                interleaved.push_back(is_right ? sequence[next_right++] : sequence[next_left++]);
+            }
+            std::copy(interleaved.begin(), interleaved.end(), sequence.begin() + v + 1);
+        }
+        return ToValues(sequence);
+    }
+
+  private:
+    // Arranges the subtree of v, which occupies sequence[v, v + subtree size), as its
+    // sequence of the given rank
+    void UnrankRecursive(size_t v, const BigUnsigned& rank, std::vector<size_t>& sequence) const {
+        const size_t num_left = _left_size[v];
+        const size_t num_right = _subtree_size[v] - 1 - num_left;
+        const size_t right_child = v + 1 + num_left;
+        if ((num_left > 0) && (num_right > 0)) {
+            BigUnsigned children_rank;
+            BigUnsigned pattern_rank;
+            BigUnsigned::DivMod(rank, _num_interleavings[v], &children_rank, &pattern_rank);
+            BigUnsigned left_rank;
+            BigUnsigned right_rank;
+            BigUnsigned::DivMod(children_rank, _num_sequences[right_child], &left_rank,
+                                &right_rank);
+            UnrankRecursive(v + 1, left_rank, sequence);
+            UnrankRecursive(right_child, right_rank, sequence);
+            Interleave(v, pattern_rank, sequence);
+        } else if (num_left > 0) {
+            UnrankRecursive(v + 1, rank, sequence);
+        } else if (num_right > 0) {
+            UnrankRecursive(right_child, rank, sequence);
+        }
+    }
+
+    // Interleaves v's left subtree elements, at the front of sequence[v + 1, v + subtree size),
+    // with its right subtree elements after them, following the pattern of the given rank
+    void Interleave(size_t v, BigUnsigned pattern_rank, std::vector<size_t>& sequence) const {
+        const size_t begin = v + 1;
+        const size_t end = v + _subtree_size[v];
+        const size_t num_left = _left_size[v];
+        const std::vector<size_t> left_elements(sequence.begin() + begin,
+                                                sequence.begin() + begin + num_left);
+        const std::vector<size_t> right_elements(sequence.begin() + begin + num_left,
+                                                 sequence.begin() + end);
+        size_t num_left_taken = 0;
+        size_t num_right_taken = 0;
+        BigUnsigned num_patterns = _num_interleavings[v];  // for the elements not yet taken
+        BigUnsigned num_starting_left;
+        for (size_t position = begin; position < end; ++position) {
+            const size_t left_remaining = left_elements.size() - num_left_taken;
+            const size_t right_remaining = right_elements.size() - num_right_taken;
+            bool take_left = (right_remaining == 0);
+            if ((left_remaining > 0) && (right_remaining > 0)) {
+                num_starting_left = num_patterns;
+                num_starting_left *= static_cast<uint32_t>(left_remaining);
+                num_starting_left.DivideSmall(static_cast<uint32_t>(left_remaining +
+                                                                    right_remaining));
+                take_left = (pattern_rank < num_starting_left);
+                if (take_left) {
+                    num_patterns = num_starting_left;
+                } else {
+                    pattern_rank -= num_starting_left;
+                    num_patterns -= num_starting_left;
+                }
+            }
+            sequence[position] = take_left ? left_elements[num_left_taken++]
+                                           : right_elements[num_right_taken++];
+        }
+    }
+
+    // Rank of the subtree of v, whose nodes appear (in some order) in
+    // nodes[begin, begin + subtree size).  Leaves that range in preorder.
+    BigUnsigned RankRecursive(size_t v, std::vector<size_t>& nodes, size_t begin) const {
+        const size_t num_left = _left_size[v];
+        const size_t num_right = _subtree_size[v] - 1 - num_left;
+        const size_t right_child = v + 1 + num_left;
+        if ((num_left > 0) && (num_right > 0)) {
+            const BigUnsigned pattern_rank = Deinterleave(v, nodes, begin);
+            BigUnsigned rank = RankRecursive(v + 1, nodes, begin + 1) *
+                               _num_sequences[right_child];
+            rank += RankRecursive(right_child, nodes, begin + 1 + num_left);
+            rank = rank * _num_interleavings[v];
+            rank += pattern_rank;
+            return rank;
+        } else if (num_left > 0) {
+            return RankRecursive(v + 1, nodes, begin + 1);
+        } else if (num_right > 0) {
+            return RankRecursive(right_child, nodes, begin + 1);
+        }
+        return BigUnsigned();
+    }
+
+    // Returns the rank of the interleaving pattern of v's subtree in nodes[begin, ...), and
+    // moves its left subtree elements in front of its right subtree elements
+    BigUnsigned Deinterleave(size_t v, std::vector<size_t>& nodes, size_t begin) const {
+        const size_t end = begin + _subtree_size[v];
+        const size_t num_left = _left_size[v];
+        const size_t num_right = _subtree_size[v] - 1 - num_left;
+        const size_t right_child = v + 1 + num_left;
+        std::vector<size_t> left_elements;
+        std::vector<size_t> right_elements;
+        BigUnsigned pattern_rank;
+        BigUnsigned num_patterns = _num_interleavings[v];  // for the elements not yet seen
+        BigUnsigned num_starting_left;
+        for (size_t position = begin + 1; position < end; ++position) {
+            const size_t left_remaining = num_left - left_elements.size();
+            const size_t right_remaining = num_right - right_elements.size();
+            const bool is_left = (nodes[position] < right_child);
+            if ((left_remaining > 0) && (right_remaining > 0)) {
+                num_starting_left = num_patterns;
+                num_starting_left *= static_cast<uint32_t>(left_remaining);
+                num_starting_left.DivideSmall(static_cast<uint32_t>(left_remaining +
+                                                                    right_remaining));
+                if (is_left) {
+                    num_patterns = num_starting_left;
+                } else {
+                    pattern_rank += num_starting_left;
+                    num_patterns -= num_starting_left;
+                }
+            }
+            (is_left ? left_elements : right_elements).push_back(nodes[position]);
+        }
+        std::copy(left_elements.begin(), left_elements.end(), nodes.begin() + begin + 1);
+        std::copy(right_elements.begin(), right_elements.end(),
+                  nodes.begin() + begin + 1 + num_left);
+        return pattern_rank;
+    }
+
+    std::vector<T> ToValues(const std::vector<size_t>& sequence) const {
+        std::vector<T> values;
+        values.reserve(sequence.size());
+        for (const size_t v : sequence) {
+            values.push_back(_node_values[v]);
+        }
+        return values;
+    }
+
+    // Per node, numbered in preorder
+    std::vector<T> _node_values;
+    std::vector<size_t> _left_size;
+    std::vector<size_t> _subtree_size;
+    std::vector<BigUnsigned> _num_interleavings;  // binomial(subtree size - 1, left size)
+    std::vector<BigUnsigned> _num_sequences;
+    BigUnsigned _count;
+};
+
+template <typename T>
+class BinaryTree {
+  public:
+    BinaryTree() {}
+
+    // Simple insert: inserts value at next available node to make complete tree
+    void insert(const T& value) {
+        std::vector<Node<T>*> path_to_inserted_node = FindNthNodePath(_size + 1);
+        path_to_inserted_node.back()->value = value;
+    }
+
+    size_t size() {
+        return _size;
+    }
+
+    // Copy of BstSequences from binary_search_tree_sequences.cpp, kept here as the reference
+    // for correctness checks and benchmarking
+    std::vector<std::vector<T>> BstSequences() {
+        return BstSequencesRecursive(_root.get());
+    }
+
+    std::vector<std::vector<T>> BstSequencesRecursive(const Node<T>* root_ptr) {
+        const bool has_left_child = root_ptr->left_child_ptr != nullptr;
+        const bool has_right_child = root_ptr->right_child_ptr != nullptr;
+        if (!has_left_child && !has_right_child) {
+            return {std::vector<T>{root_ptr->value}};
+        } else if (has_left_child && !has_right_child) {
+            std::vector<std::vector<T>> left_subtree_sequences =
+                    BstSequencesRecursive(root_ptr->left_child_ptr.get());
+            for (std::vector<T>& left_seq : left_subtree_sequences) {
+                left_seq.insert(left_seq.begin(), root_ptr->value);
+            }
+            return left_subtree_sequences;
+        } else if (!has_left_child && has_right_child) {
+            std::vector<std::vector<T>> right_subtree_sequences =
+                    BstSequencesRecursive(root_ptr->right_child_ptr.get());
+            for (std::vector<T>& right_seq : right_subtree_sequences) {
+                right_seq.insert(right_seq.begin(), root_ptr->value);
+            }
+            return right_subtree_sequences;
+        }
+        std::vector<std::vector<T>> left_subtree_sequences =
+                BstSequencesRecursive(root_ptr->left_child_ptr.get());
+        std::vector<std::vector<T>> right_subtree_sequences =
+                BstSequencesRecursive(root_ptr->right_child_ptr.get());
+        std::vector<std::vector<T>> all_interleaved_sequences;
+        for (const std::vector<T>& left_seq : left_subtree_sequences) {
+            for (const std::vector<T>& right_seq : right_subtree_sequences) {
+                std::vector<std::vector<T>> new_sequences =
+                        GenerateInterleavedSequences(left_seq, right_seq);
+                all_interleaved_sequences.insert(
+                        all_interleaved_sequences.end(),
+                        std::make_move_iterator(new_sequences.begin()),
+                        std::make_move_iterator(new_sequences.end()));
+            }
+        }
+        for (std::vector<T>& interleaved_seq : all_interleaved_sequences) {
+            interleaved_seq.insert(interleaved_seq.begin(), root_ptr->value);
+        }
+        return all_interleaved_sequences;
+    }
+
+    // Ranks, unranks and samples the sequences BstSequences would return
+    BstSequenceRanker<T> BstSequencesRanker() const {
+        return BstSequenceRanker<T>(_root.get());
+    }
+
+    // Number of sequences BstSequences would return
+    BigUnsigned CountBstSequences() const {
+        return BstSequenceRanker<T>(_root.get()).count();
+    }
+
+  private:
+    // Retrieve the nth node in the tree assuming the tree is complete,
+    // inserting a new node if it does not exist (and any nodes along the path).
+    // Return a vector of the nodes along the path from route to the nth node.
+    // Note: n is 1-indexed here, as it makes the math easier!
+    std::vector<Node<T>*> FindNthNodePath(size_t n) {
+        size_t modulus = 1;
+        while (n / modulus > 1) {
+            modulus *= 2;
+        }
+        std::vector<Node<T>*> path_vector;
+        Node<T>* current_node_ptr = _root.get();
+        if (_root == nullptr) {
+            _root = std::make_unique<Node<T>>();
+            ++_size;
+            current_node_ptr = _root.get();
+        }
+        path_vector.push_back(current_node_ptr);
+        for (/* modulus */; modulus > 1; modulus /= 2) {
+            if ((n % modulus) < (modulus / 2)) {  // left
+                if (current_node_ptr->left_child_ptr == nullptr) {
+                    current_node_ptr->left_child_ptr = std::make_unique<Node<T>>();
+                    ++_size;
+                }
+                current_node_ptr = current_node_ptr->left_child_ptr.get();
+            } else {  // right
+                if (current_node_ptr->right_child_ptr == nullptr) {
+                    current_node_ptr->right_child_ptr = std::make_unique<Node<T>>();
+                    ++_size;
+                }
+                current_node_ptr = current_node_ptr->right_child_ptr.get();
+            }
+            path_vector.push_back(current_node_ptr);
+        }
+        return path_vector;
+    }
+
+    std::unique_ptr<Node<T>> _root;
+    size_t _size = 0;
+};
+
+// Complete tree of values 0..n-1 inserted in level order (the structure is all that matters
+// for BST sequences)
+BinaryTree<int> MakeCompleteTree(int n) {
+    BinaryTree<int> tree;
+    for (int value = 0; value < n; ++value) {
+        tree.insert(value);
+    }
+    return tree;
+}
+
+// Complete tree of n nodes that is also a BST: the node at level-order position i gets its
+// inorder position as its value
+BinaryTree<int> MakeCompleteBst(int n) {
+    std::vector<int> inorder_position(n + 1);  // indexed by 1-based level-order position
+    int next_inorder_position = 0;
+    std::vector<int> position_stack;
+    int position = 1;
+    while ((position <= n) || !position_stack.empty()) {
+        if (position <= n) {
+            position_stack.push_back(position);
+            position *= 2;
+        } else {
+            position = position_stack.back();
+            position_stack.pop_back();
+            inorder_position[position] = next_inorder_position++;
+            position = 2 * position + 1;
+        }
+    }
+    BinaryTree<int> tree;
+    for (int i = 1; i <= n; ++i) {
+        tree.insert(inorder_position[i]);
+    }
+    return tree;
+}
+
+// Root of the BST built by inserting values in order
+std::unique_ptr<Node<int>> MakeBst(const std::vector<int>& values) {
+    std::unique_ptr<Node<int>> root_ptr;
+    for (const int value : values) {
+        std::unique_ptr<Node<int>>* link_ptr = &root_ptr;
+        Node<int>* parent_ptr = nullptr;
+        while (*link_ptr != nullptr) {
+            parent_ptr = link_ptr->get();
+            link_ptr = (value < parent_ptr->value) ? &parent_ptr->left_child_ptr
+                                                   : &parent_ptr->right_child_ptr;
+        }
+        *link_ptr = std::make_unique<Node<int>>();
+        (*link_ptr)->parent_ptr_raw = parent_ptr;
+        (*link_ptr)->value = value;
+    }
+    return root_ptr;
+}
+
+// Random BigUnsigned of 1 to max_limbs limbs, biased towards limbs that stress carries and
+// Algorithm D's corrections
+BigUnsigned RandomEdgyBigUnsigned(size_t max_limbs, std::mt19937& rng) {
+    const uint32_t kEdgyLimbs[] = {0, 1, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFE, 0xFFFFFFFF};
+    std::uniform_int_distribution<size_t> size_dist(1, max_limbs);
+    std::uniform_int_distribution<int> kind_dist(0, 6);
+    std::uniform_int_distribution<uint32_t> limb_dist;
+    BigUnsigned result;
+    for (size_t i = size_dist(rng); i > 0; --i) {
+        const int kind = kind_dist(rng);
+        result *= 0x10000;
+        result *= 0x10000;
+        result += BigUnsigned(kind < 6 ? kEdgyLimbs[kind] : limb_dist(rng));
+    }
+    return result;
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+int main() {
+    std::vector<int> test_values{
+            3,
+            1, 5,
+            0, 2};
+    BinaryTree<int> test_tree;
+    for (const int value : test_values) {
+        test_tree.insert(value);
+    }
+    const BstSequenceRanker<int> test_ranker = test_tree.BstSequencesRanker();
+    std::cout << "Number of bst sequences: " << test_tree.CountBstSequences() << std::endl;
+    for (uint64_t rank = 0; BigUnsigned(rank) < test_ranker.count(); ++rank) {
+        const std::vector<int> sequence = test_ranker.Unrank(rank);
+        std::cout << "    Unrank(" << rank << ") = " << sequence << ", Rank of that = "
+                  << test_ranker.Rank(sequence) << std::endl;
+    }
+    std::cout << std::endl;
+
+    // Division: quotient * divisor + remainder must give back the dividend
+    std::mt19937 rng(12345);
+    for (int trial = 0; trial < 100000; ++trial) {
+        const BigUnsigned dividend = RandomEdgyBigUnsigned(8, rng);
+        const BigUnsigned divisor = RandomEdgyBigUnsigned(5, rng);
+        if (divisor.is_zero()) {
+            continue;
+        }
+        BigUnsigned quotient;
+        BigUnsigned remainder;
+        BigUnsigned::DivMod(dividend, divisor, &quotient, &remainder);
+        BigUnsigned product = quotient * divisor;
+        product += remainder;
+        if ((product != dividend) || (remainder >= divisor)) {
+            std::cout << "DIVISION MISMATCH: " << dividend << " / " << divisor << std::endl;
+            return 1;
+        }
+        BigUnsigned difference = dividend;
+        difference -= remainder;
+        if (difference != quotient * divisor) {
+            std::cout << "SUBTRACTION MISMATCH: " << dividend << " - " << remainder << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Random divisions: all correct" << std::endl;
+
+    // Count, Unrank and Rank must agree with BstSequences, on complete trees and on random BSTs
+    // (which also have nodes with only one child)
+    for (int trial = 0; trial < 300; ++trial) {
+        const int n = 1 + trial % 11;
+        std::unique_ptr<Node<int>> random_root_ptr;
+        BinaryTree<int> complete_tree;
+        const Node<int>* root_ptr = nullptr;
+        std::vector<std::vector<int>> expected;
+        if (trial < 11) {
+            complete_tree = MakeCompleteTree(n);
+            expected = complete_tree.BstSequences();
+        } else {
+            std::vector<int> values(n);
+            std::iota(values.begin(), values.end(), 0);
+            std::shuffle(values.begin(), values.end(), rng);
+            random_root_ptr = MakeBst(values);
+            root_ptr = random_root_ptr.get();
+            expected = complete_tree.BstSequencesRecursive(root_ptr);
+        }
+        const BstSequenceRanker<int> ranker =
+                (root_ptr == nullptr) ? complete_tree.BstSequencesRanker()
+                                      : BstSequenceRanker<int>(root_ptr);
+        if (ranker.count() != BigUnsigned(expected.size())) {
+            std::cout << "COUNT MISMATCH: " << ranker.count() << " vs " << expected.size()
+                      << std::endl;
+            return 1;
+        }
+        for (size_t rank = 0; rank < expected.size(); ++rank) {
+            if ((ranker.Unrank(rank) != expected[rank]) ||
+                    (ranker.Rank(expected[rank]) != BigUnsigned(rank))) {
+                std::cout << "RANK MISMATCH at " << rank << ": " << expected[rank] << std::endl;
+                return 1;
+            }
+        }
+    }
+    std::cout << "Small trees: Count, Unrank and Rank match BstSequences" << std::endl;
+
+    // Sampling must hit every one of the 80 sequences of a 7-node complete tree about equally
+    // often.  Pearson's chi-squared statistic has 79 degrees of freedom, so it should be
+    // around 79 +- 13.
+    BinaryTree<int> seven_tree = MakeCompleteTree(7);
+    const BstSequenceRanker<int> seven_ranker = seven_tree.BstSequencesRanker();
+    const int kNumSamples = 800000;
+    std::vector<int> times_sampled(80, 0);
+    for (int sample = 0; sample < kNumSamples; ++sample) {
+        BigUnsigned rank = seven_ranker.Rank(seven_ranker.Sample(rng));
+        ++times_sampled[rank.DivideSmall(1000)];
+    }
+    double chi_squared = 0.0;
+    for (const int count : times_sampled) {
+        const double expected_count = kNumSamples / 80.0;
+        chi_squared += (count - expected_count) * (count - expected_count) / expected_count;
+    }
+    std::cout << "Sampling the 80 sequences of a 7-node tree " << kNumSamples
+              << " times: chi-squared = " << chi_squared << std::endl;
+    if (chi_squared > 140.0) {
+        std::cout << "SAMPLING IS NOT UNIFORM" << std::endl;
+        return 1;
+    }
+    std::cout << std::endl;
+
+    // Big trees: a complete tree and a random BST
+    BinaryTree<int> big_complete_tree = MakeCompleteBst(4095);
+    std::vector<int> big_values(5000);
+    std::iota(big_values.begin(), big_values.end(), 0);
+    std::shuffle(big_values.begin(), big_values.end(), rng);
+    const std::unique_ptr<Node<int>> big_bst_root_ptr = MakeBst(big_values);
+    for (const bool complete : {true, false}) {
+        std::unique_ptr<BstSequenceRanker<int>> ranker;
+        const double count_seconds = TimeSeconds([&]() {
+            ranker = complete ? std::make_unique<BstSequenceRanker<int>>(
+                                        big_complete_tree.BstSequencesRanker())
+                              : std::make_unique<BstSequenceRanker<int>>(
+                                        big_bst_root_ptr.get());
+        });
+        const std::string count_string = ranker->count().to_string();
+        std::cout << (complete ? "Complete tree of 4095 nodes" : "Random BST of 5000 nodes")
+                  << ": " << count_string.substr(0, 20) << "... (" << count_string.size()
+                  << " digits) sequences, counted in " << count_seconds << " s" << std::endl;
+
+        // Same count as n! / (product of subtree sizes)
+        const size_t n = complete ? 4095 : 5000;
+        BigUnsigned factorial(1);
+        for (size_t i = 2; i <= n; ++i) {
+            factorial *= static_cast<uint32_t>(i);
+        }
+        const std::vector<int> preorder = ranker->Unrank(0);
+        const std::unique_ptr<Node<int>> copy_root_ptr =
+                MakeBst(complete ? preorder : big_values);
+        BigUnsigned size_product(1);
+        std::vector<std::pair<const Node<int>*, bool>> node_stack{{copy_root_ptr.get(), false}};
+        std::vector<size_t> size_stack;
+        while (!node_stack.empty()) {  // postorder, computing subtree sizes
+            auto [node_ptr, children_done] = node_stack.back();
+            node_stack.pop_back();
+            if (node_ptr == nullptr) {
+                size_stack.push_back(0);
+            } else if (!children_done) {
+                node_stack.push_back({node_ptr, true});
+                node_stack.push_back({node_ptr->left_child_ptr.get(), false});
+                node_stack.push_back({node_ptr->right_child_ptr.get(), false});
+            } else {
+                const size_t left_size = size_stack.back();
+                size_stack.pop_back();
+                const size_t right_size = size_stack.back();
+                size_stack.pop_back();
+                size_stack.push_back(1 + left_size + right_size);
+                size_product *= static_cast<uint32_t>(1 + left_size + right_size);
+            }
+        }
+        BigUnsigned quotient;
+        BigUnsigned remainder;
+        BigUnsigned::DivMod(factorial, size_product, &quotient, &remainder);
+        std::cout << "    n! / (product of subtree sizes) "
+                  << ((quotient == ranker->count()) && remainder.is_zero() ? "matches"
+                                                                           : "MISMATCH")
+                  << std::endl;
+
+        for (int trial = 0; trial < 3; ++trial) {
+            const BigUnsigned rank = BigUnsigned::RandomBelow(ranker->count(), rng);
+            std::vector<int> sequence;
+            const double unrank_seconds = TimeSeconds([&]() {
+                sequence = ranker->Unrank(rank);
+            });
+            BigUnsigned rank_again;
+            const double rank_seconds = TimeSeconds([&]() {
+                rank_again = ranker->Rank(sequence);
+            });
+            std::vector<int> sample;
+            const double sample_seconds = TimeSeconds([&]() {
+                sample = ranker->Sample(rng);
+            });
+            // A sample is valid if inserting it into an empty BST gives back the same tree
+            const bool sample_valid = (ranker->Unrank(ranker->Rank(sample)) == sample) &&
+                                      (BstSequenceRanker<int>(MakeBst(sample).get()).Unrank(0) ==
+                                       preorder);
+            std::cout << "    Random rank: Unrank " << unrank_seconds << " s, Rank "
+                      << rank_seconds << " s ("
+                      << (rank_again == rank ? "round trip matches" : "MISMATCH")
+                      << "), Sample " << sample_seconds << " s ("
+                      << (sample_valid ? "valid" : "INVALID") << ")" << std::endl;
+        }
+        if (!complete) {
+            std::cout << "    Rank of the insertion order that built the BST: "
+                      << ranker->Rank(big_values).to_string().substr(0, 20) << "..."
+                      << std::endl;
+        }
+    }
+
+    return 0;
+}
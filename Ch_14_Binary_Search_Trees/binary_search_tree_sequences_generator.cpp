@@ -0,0 +1,444 @@
+/* Lazy generation of BST sequences (see binary_search_tree_sequences.cpp).
+ *
+ * BstSequences returns every sequence at once, and there are exponentially many of them:
+ * a complete tree of just 15 nodes has 21964800.  The generator here produces them one at a
+ * time, in the same order as BstSequences, into a single reused buffer.
+ *
+ * Order of the sequences: for a node with two children, BstSequencesRecursive loops over
+ * the left subtree's sequences, then (inside that) the right subtree's sequences, then
+ * (innermost) the interleavings of the two.  The interleavings come out of
+ * GenerateInterleavedSequencesRecursive in lexicographic order if we write each one as a
+ * pattern of L's and R's (which subtree each position is taken from), with L < R.
+ *
+ * State: the current sequence is all the state we need.  A node's subtree elements appear
+ * in it, in order, and which of them are from the left vs. right subtree gives the node's
+ * current interleaving pattern.  To advance the subtree of a node:
+ *   1. Advance its interleaving pattern with std::next_permutation, and rearrange the
+ *      subtree's elements to match.  If that worked, we're done.
+ *   2. Otherwise next_permutation wrapped around to the first pattern, LL...LRR...R, so the
+ *      left subtree's elements are now contiguous, followed by the right subtree's.
+ *      Advance the right subtree (recursively, on its contiguous range).  If it wrapped
+ *      around too, advance the left subtree.  If that also wrapped around, the whole
+ *      subtree has wrapped around.
+ * The first sequence is the preorder traversal (every pattern LL...LRR...R).
+ *
+ * Nodes are numbered in preorder, so each subtree is a contiguous range of numbers and
+ * "is this element in the right subtree?" is one comparison.  Working memory is a few arrays
+ * of n entries, no matter how many sequences there are.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+template <typename T>
+void GenerateInterleavedSequencesRecursive(
+        const std::vector<T>& input_sequence_a,
+        const std::vector<T>& input_sequence_b,
+        std::vector<T>& current_sequence,
+        size_t i,
+        size_t j,
+        std::vector<std::vector<T>>& generated_sequences);
+
+template <typename T>
+std::vector<std::vector<T>> GenerateInterleavedSequences(
+        const std::vector<T>& sequence, const std::vector<T>& other_sequence) {
+    std::vector<T> current_sequence;
+    size_t i = 0;
+    size_t j = 0;
+    std::vector<std::vector<T>> generated_sequences;
+    GenerateInterleavedSequencesRecursive(
+            sequence, other_sequence, current_sequence, i, j, generated_sequences);
+    return generated_sequences;
+}
+
+template <typename T>
+void GenerateInterleavedSequencesRecursive(
+        const std::vector<T>& input_sequence_a,
+        const std::vector<T>& input_sequence_b,
+        std::vector<T>& current_sequence,
+        size_t i,
+        size_t j,
+        std::vector<std::vector<T>>& generated_sequences) {
+    if (i < input_sequence_a.size()) {
+        current_sequence.emplace_back(input_sequence_a[i]);
+        GenerateInterleavedSequencesRecursive(
+                input_sequence_a, input_sequence_b, current_sequence,
+                i + 1, j, generated_sequences);
+        current_sequence.pop_back();
+    }
+    if (j < input_sequence_b.size()) {
+        current_sequence.emplace_back(input_sequence_b[j]);
+        GenerateInterleavedSequencesRecursive(
+                input_sequence_a, input_sequence_b, current_sequence,
+                i, j + 1, generated_sequences);
+        current_sequence.pop_back();
+    }
+    if ((i == input_sequence_a.size()) && (j == input_sequence_b.size())) {
+        generated_sequences.emplace_back(current_sequence);
+    }
+}
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const std::vector<T>& v) {
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i];
+        if (i + 1 < v.size()) os << ", ";
+    }
+    os << "]";
+    return os;
+}
+
+template <typename T>
+struct Node {
+    std::unique_ptr<Node<T>> left_child_ptr;
+    std::unique_ptr<Node<T>> right_child_ptr;
+    Node<T>* parent_ptr_raw;
+    T value;
+};
+
+// Produces the BST sequences of the tree rooted at root_ptr one at a time, in the same order
+// as BinaryTree::BstSequences:
+//     for (BstSequenceGenerator<T> generator(root); !generator.done(); generator.next()) {
+//         use(generator.current());
+//     }
+// The tree must not change while the generator is in use.
+template <typename T>
+class BstSequenceGenerator {
+  public:
+    explicit BstSequenceGenerator(const Node<T>* root_ptr) {
+        // Number the nodes in preorder
+        std::vector<const Node<T>*> node_stack;
+        if (root_ptr != nullptr) {
+            node_stack.push_back(root_ptr);
+        }
+        std::vector<bool> has_left_child;
+        std::vector<bool> has_right_child;
+        while (!node_stack.empty()) {
+            const Node<T>* node_ptr = node_stack.back();
+            node_stack.pop_back();
+            _node_values.push_back(node_ptr->value);
+            has_left_child.push_back(node_ptr->left_child_ptr != nullptr);
+            has_right_child.push_back(node_ptr->right_child_ptr != nullptr);
+            if (node_ptr->right_child_ptr != nullptr) {
+                node_stack.push_back(node_ptr->right_child_ptr.get());
+            }
+            if (node_ptr->left_child_ptr != nullptr) {
+                node_stack.push_back(node_ptr->left_child_ptr.get());
+            }
+        }
+        // In preorder, node v's left child is v + 1 and its right child comes right after
+        // the left subtree, so sizes can be filled in from the back
+        const size_t n = _node_values.size();
+        _left_size.assign(n, 0);
+        _subtree_size.assign(n, 1);
+        for (size_t v = n; v-- > 0;) {
+            _left_size[v] = has_left_child[v] ? _subtree_size[v + 1] : 0;
+            const size_t right_size =
+                    has_right_child[v] ? _subtree_size[v + 1 + _left_size[v]] : 0;
+            _subtree_size[v] = 1 + _left_size[v] + right_size;
+        }
+        _sequence.resize(n);
+        _values.resize(n);
+        for (size_t v = 0; v < n; ++v) {
+            _sequence[v] = v;
+            _values[v] = _node_values[v];
+        }
+        _pattern.resize(n);
+        _scratch.resize(n);
+        _done = (n == 0);
+    }
+
+    bool done() const {
+        return _done;
+    }
+
+    // The current sequence (only valid while !done())
+    const std::vector<T>& current() const {
+        return _values;
+    }
+
+    void next() {
+        _done = !Advance(0, 0, _sequence.size());
+    }
+
+  private:
+    // Advances the subtree of node v, whose elements occupy positions [begin, end) of the
+    // current sequence, to its next arrangement.  Returns false if it wrapped around to its
+    // first arrangement instead.
+    bool Advance(size_t v, size_t begin, size_t end) {
+        const size_t num_left = _left_size[v];
+        const size_t num_right = _subtree_size[v] - 1 - num_left;
+        const size_t right_child = v + 1 + num_left;
+        if ((num_left > 0) && (num_right > 0)) {
+            // Pattern: 0 for left subtree elements, 1 for right subtree elements.
+            // The left elements are copied to the front of _scratch, the right ones after them.
+            size_t num_left_seen = 0;
+            size_t num_right_seen = 0;
+            for (size_t position = begin + 1; position < end; ++position) {
+                const bool is_right = (_sequence[position] >= right_child);
+                _pattern[position] = is_right;
+                if (is_right) {
+                    _scratch[num_left + num_right_seen++] = _sequence[position];
+                } else {
+                    _scratch[num_left_seen++] = _sequence[position];
+                }
+            }
+            const bool advanced = std::next_permutation(_pattern.begin() + begin + 1,
+                                                        _pattern.begin() + end);
+            num_left_seen = 0;
+            num_right_seen = 0;
+            for (size_t position = begin + 1; position < end; ++position) {
+                _sequence[position] = _pattern[position]
+                        ? _scratch[num_left + num_right_seen++] : _scratch[num_left_seen++];
+                _values[position] = _node_values[_sequence[position]];
+            }
+            if (advanced) {
+                return true;
+            }
+        }
+        if ((num_right > 0) && Advance(right_child, end - num_right, end)) {
+            return true;
+        }
+        if ((num_left > 0) && Advance(v + 1, begin + 1, begin + 1 + num_left)) {
+            return true;
+        }
+        return false;
+    }
+
+    // Per node, numbered in preorder
+    std::vector<T> _node_values;
+    std::vector<size_t> _left_size;
+    std::vector<size_t> _subtree_size;
+    // Current sequence, as node numbers and as values
+    std::vector<size_t> _sequence;
+    std::vector<T> _values;
+    // Scratch space for Advance, used by one node at a time
+    std::vector<char> _pattern;
+    std::vector<size_t> _scratch;
+    bool _done;
+};
+
+template <typename T>
+class BinaryTree {
+  public:
+    BinaryTree() {}
+
+    // Simple insert: inserts value at next available node to make complete tree
+    void insert(const T& value) {
+        std::vector<Node<T>*> path_to_inserted_node = FindNthNodePath(_size + 1);
+        path_to_inserted_node.back()->value = value;
+    }
+
+    size_t size() {
+        return _size;
+    }
+
+    // Copy of BstSequences from binary_search_tree_sequences.cpp, kept here as the reference
+    // for correctness checks and benchmarking
+    std::vector<std::vector<T>> BstSequences() {
+        return BstSequencesRecursive(_root.get());
+    }
+
+    std::vector<std::vector<T>> BstSequencesRecursive(const Node<T>* root_ptr) {
+        const bool has_left_child = root_ptr->left_child_ptr != nullptr;
+        const bool has_right_child = root_ptr->right_child_ptr != nullptr;
+        if (!has_left_child && !has_right_child) {
+            return {std::vector<T>{root_ptr->value}};
+        } else if (has_left_child && !has_right_child) {
+            std::vector<std::vector<T>> left_subtree_sequences =
+                    BstSequencesRecursive(root_ptr->left_child_ptr.get());
+            for (std::vector<T>& left_seq : left_subtree_sequences) {
+                left_seq.insert(left_seq.begin(), root_ptr->value);
+            }
+            return left_subtree_sequences;
+        } else if (!has_left_child && has_right_child) {
+            std::vector<std::vector<T>> right_subtree_sequences =
+                    BstSequencesRecursive(root_ptr->right_child_ptr.get());
+            for (std::vector<T>& right_seq : right_subtree_sequences) {
+                right_seq.insert(right_seq.begin(), root_ptr->value);
+            }
+            return right_subtree_sequences;
+        }
+        std::vector<std::vector<T>> left_subtree_sequences =
+                BstSequencesRecursive(root_ptr->left_child_ptr.get());
+        std::vector<std::vector<T>> right_subtree_sequences =
+                BstSequencesRecursive(root_ptr->right_child_ptr.get());
+        std::vector<std::vector<T>> all_interleaved_sequences;
+        for (const std::vector<T>& left_seq : left_subtree_sequences) {
+            for (const std::vector<T>& right_seq : right_subtree_sequences) {
+                std::vector<std::vector<T>> new_sequences =
+                        GenerateInterleavedSequences(left_seq, right_seq);
+                all_interleaved_sequences.insert(
+                        all_interleaved_sequences.end(),
+                        std::make_move_iterator(new_sequences.begin()),
+                        std::make_move_iterator(new_sequences.end()));
+            }
+        }
+        for (std::vector<T>& interleaved_seq : all_interleaved_sequences) {
+            interleaved_seq.insert(interleaved_seq.begin(), root_ptr->value);
+        }
+        return all_interleaved_sequences;
+    }
+
+    // Generator of the same sequences as BstSequences, one at a time
+    BstSequenceGenerator<T> BstSequencesGenerator() const {
+        return BstSequenceGenerator<T>(_root.get());
+    }
+
+    // Calls sink(sequence) for each sequence BstSequences would return, in the same order,
+    // stopping early if sink returns false.  The sequence passed to sink is a reused buffer,
+    // only valid during the call.  Returns the number of sequences passed to sink.
+    template <typename Sink>
+    size_t ForEachBstSequence(Sink&& sink) const {
+        size_t num_sequences = 0;
+        for (BstSequenceGenerator<T> generator(_root.get()); !generator.done();
+                generator.next()) {
+            ++num_sequences;
+            if (!sink(generator.current())) {
+                break;
+            }
+        }
+        return num_sequences;
+    }
+
+  private:
+    // Retrieve the nth node in the tree assuming the tree is complete,
+    // inserting a new node if it does not exist (and any nodes along the path).
+    // Return a vector of the nodes along the path from route to the nth node.
+    // Note: n is 1-indexed here, as it makes the math easier!
+    std::vector<Node<T>*> FindNthNodePath(size_t n) {
+        size_t modulus = 1;
+        while (n / modulus > 1) {
+            modulus *= 2;
+        }
+        std::vector<Node<T>*> path_vector;
+        Node<T>* current_node_ptr = _root.get();
+        if (_root == nullptr) {
+            _root = std::make_unique<Node<T>>();
+            ++_size;
+            current_node_ptr = _root.get();
+        }
+        path_vector.push_back(current_node_ptr);
+        for (/* modulus */; modulus > 1; modulus /= 2) {
+            if ((n % modulus) < (modulus / 2)) {  // left
+                if (current_node_ptr->left_child_ptr == nullptr) {
+                    current_node_ptr->left_child_ptr = std::make_unique<Node<T>>();
+                    ++_size;
+                }
+                current_node_ptr = current_node_ptr->left_child_ptr.get();
+            } else {  // right
+                if (current_node_ptr->right_child_ptr == nullptr) {
+                    current_node_ptr->right_child_ptr = std::make_unique<Node<T>>();
+                    ++_size;
+                }
+                current_node_ptr = current_node_ptr->right_child_ptr.get();
+            }
+            path_vector.push_back(current_node_ptr);
+        }
+        return path_vector;
+    }
+
+    std::unique_ptr<Node<T>> _root;
+    size_t _size = 0;
+};
+
+// Complete tree of values 0..n-1 inserted in level order (the structure is all that matters
+// for BST sequences)
+BinaryTree<int> MakeCompleteTree(int n) {
+    BinaryTree<int> tree;
+    for (int value = 0; value < n; ++value) {
+        tree.insert(value);
+    }
+    return tree;
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+int main() {
+    std::vector<int> test_values{
+            3,
+            1, 5,
+            0, 2};
+    BinaryTree<int> test_tree;
+    for (const int value : test_values) {
+        test_tree.insert(value);
+    }
+    std::cout << "All bst sequences (generated one at a time):" << std::endl;
+    test_tree.ForEachBstSequence([](const std::vector<int>& seq) {
+        std::cout << "    " << seq << std::endl;
+        return true;
+    });
+    std::cout << std::endl;
+
+    // Same sequences, in the same order, as BstSequences
+    for (int n = 1; n <= 11; ++n) {
+        BinaryTree<int> tree = MakeCompleteTree(n);
+        const std::vector<std::vector<int>> expected = tree.BstSequences();
+        std::vector<std::vector<int>> generated;
+        tree.ForEachBstSequence([&](const std::vector<int>& seq) {
+            generated.push_back(seq);
+            return true;
+        });
+        if (generated != expected) {
+            std::cout << "MISMATCH for complete tree of " << n << " nodes" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Complete trees of 1 to 11 nodes: generator matches BstSequences" << std::endl
+              << std::endl;
+
+    // Stopping early: the first 4 of the 20-node tree's 319258368000 sequences
+    BinaryTree<int> big_tree = MakeCompleteTree(20);
+    size_t num_printed = 0;
+    big_tree.ForEachBstSequence([&](const std::vector<int>& seq) {
+        std::cout << "20-node tree, sequence " << num_printed << ": " << seq << std::endl;
+        return ++num_printed < 4;
+    });
+    std::cout << std::endl;
+
+    // Benchmark: full enumeration, materialized vs. streamed into a checksum
+    BinaryTree<int> bench_tree = MakeCompleteTree(12);
+    size_t materialized_count = 0;
+    const double materialized_seconds = TimeSeconds([&]() {
+        materialized_count = bench_tree.BstSequences().size();
+    });
+    long long checksum = 0;
+    size_t streamed_count = 0;
+    const double streamed_seconds = TimeSeconds([&]() {
+        streamed_count = bench_tree.ForEachBstSequence([&](const std::vector<int>& seq) {
+            checksum += seq.back();
+            return true;
+        });
+    });
+    std::cout << "Benchmark: complete tree of 12 nodes, " << materialized_count
+              << " sequences" << std::endl;
+    std::cout << "    BstSequences: " << materialized_seconds << " s" << std::endl;
+    std::cout << "    Generator:    " << streamed_seconds << " s (" << streamed_count
+              << " sequences, " << streamed_count / streamed_seconds / 1e6
+              << " M sequences/s), speedup " << materialized_seconds / streamed_seconds << "x"
+              << std::endl;
+
+    // 15 nodes: 21964800 sequences, far too many to materialize, but easy to stream
+    BinaryTree<int> stream_tree = MakeCompleteTree(15);
+    const double stream_seconds = TimeSeconds([&]() {
+        streamed_count = stream_tree.ForEachBstSequence([&](const std::vector<int>& seq) {
+            checksum += seq.back();
+            return true;
+        });
+    });
+    std::cout << "    Complete tree of 15 nodes: streamed " << streamed_count << " sequences in "
+              << stream_seconds << " s (checksum " << checksum << ")" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,1153 @@
+/* Parallel enumeration of BST sequences (see binary_search_tree_sequences.cpp).
+ *
+ * Even streamed one at a time (binary_search_tree_sequences_generator.cpp), there are far too
+ * many sequences to enumerate on one core for mid-sized trees.  But the sequences are
+ * numbered: binary_search_tree_sequences_counting.cpp can jump straight to the sequence of any
+ * rank, and the generator can continue from any sequence, since the current sequence is all
+ * of its state.  So we split the ranks [0, count) into contiguous shards, and each shard
+ * unranks its first sequence and generates the rest of its range from there.  The shards are
+ * disjoint and cover every rank, and each one produces its range in order, so putting the
+ * shards back together in order gives exactly the sequential output.
+ *
+ * Shards are handed out to threads one at a time, so using a few more shards than threads
+ * evens out the load if some threads run slower than others.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <compare>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+template <typename T>
+void GenerateInterleavedSequencesRecursive(
+        const std::vector<T>& input_sequence_a,
+        const std::vector<T>& input_sequence_b,
+        std::vector<T>& current_sequence,
+        size_t i,
+        size_t j,
+        std::vector<std::vector<T>>& generated_sequences);
+
+template <typename T>
+std::vector<std::vector<T>> GenerateInterleavedSequences(
+        const std::vector<T>& sequence, const std::vector<T>& other_sequence) {
+    std::vector<T> current_sequence;
+    size_t i = 0;
+    size_t j = 0;
+    std::vector<std::vector<T>> generated_sequences;
+    GenerateInterleavedSequencesRecursive(
+            sequence, other_sequence, current_sequence, i, j, generated_sequences);
+    return generated_sequences;
+}
+
+template <typename T>
+void GenerateInterleavedSequencesRecursive(
+        const std::vector<T>& input_sequence_a,
+        const std::vector<T>& input_sequence_b,
+        std::vector<T>& current_sequence,
+        size_t i,
+        size_t j,
+        std::vector<std::vector<T>>& generated_sequences) {
+    if (i < input_sequence_a.size()) {
+        current_sequence.emplace_back(input_sequence_a[i]);
+        GenerateInterleavedSequencesRecursive(
+                input_sequence_a, input_sequence_b, current_sequence,
+                i + 1, j, generated_sequences);
+        current_sequence.pop_back();
+    }
+    if (j < input_sequence_b.size()) {
+        current_sequence.emplace_back(input_sequence_b[j]);
+        GenerateInterleavedSequencesRecursive(
+                input_sequence_a, input_sequence_b, current_sequence,
+                i, j + 1, generated_sequences);
+        current_sequence.pop_back();
+    }
+    if ((i == input_sequence_a.size()) && (j == input_sequence_b.size())) {
+        generated_sequences.emplace_back(current_sequence);
+    }
+}
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const std::vector<T>& v) {
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i];
+        if (i + 1 < v.size()) os << ", ";
+    }
+    os << "]";
+    return os;
+}
+
+template <typename T>
+struct Node {
+    std::unique_ptr<Node<T>> left_child_ptr;
+    std::unique_ptr<Node<T>> right_child_ptr;
+    Node<T>* parent_ptr_raw;
+    T value;
+};
+
+// BigUnsigned, Binomial and BstSequenceRanker are copied from
+// binary_search_tree_sequences_counting.cpp (without sampling, and with
+// BigUnsigned::low_64_bits and BstSequenceRanker::UnrankNodes added), and BstSequenceGenerator
+// from binary_search_tree_sequences_generator.cpp (with a constructor that starts from any
+// sequence added)
+
+// Arbitrary-precision unsigned integer, with just the operations needed here.  Stored as
+// little-endian 32-bit limbs with no leading zero limbs, so zero has no limbs at all.
+class BigUnsigned {
+  public:
+    BigUnsigned() {}
+
+    BigUnsigned(uint64_t value) {
+        while (value != 0) {
+            _limbs.push_back(static_cast<uint32_t>(value));
+            value >>= 32;
+        }
+    }
+
+    bool is_zero() const {
+        return _limbs.empty();
+    }
+
+    size_t bit_length() const {
+        return _limbs.empty() ? 0 : 32 * _limbs.size() - std::countl_zero(_limbs.back());
+    }
+
+    // Value modulo 2^64
+    uint64_t low_64_bits() const {
+        uint64_t result = 0;
+        for (size_t i = std::min<size_t>(_limbs.size(), 2); i-- > 0;) {
+            result = (result << 32) | _limbs[i];
+        }
+        return result;
+    }
+
+    friend bool operator==(const BigUnsigned& a, const BigUnsigned& b) = default;
+
+    friend std::strong_ordering operator<=>(const BigUnsigned& a, const BigUnsigned& b) {
+        if (a._limbs.size() != b._limbs.size()) {
+            return a._limbs.size() <=> b._limbs.size();
+        }
+        for (size_t i = a._limbs.size(); i-- > 0;) {
+            if (a._limbs[i] != b._limbs[i]) {
+                return a._limbs[i] <=> b._limbs[i];
+            }
+        }
+        return std::strong_ordering::equal;
+    }
+
+    BigUnsigned& operator+=(const BigUnsigned& other) {
+        if (_limbs.size() < other._limbs.size()) {
+            _limbs.resize(other._limbs.size(), 0);
+        }
+        uint64_t carry = 0;
+        for (size_t i = 0; i < _limbs.size(); ++i) {
+            if ((i >= other._limbs.size()) && (carry == 0)) {
+                break;
+            }
+            carry += _limbs[i];
+            if (i < other._limbs.size()) {
+                carry += other._limbs[i];
+            }
+            _limbs[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        if (carry != 0) {
+            _limbs.push_back(static_cast<uint32_t>(carry));
+        }
+        return *this;
+    }
+
+    // Requires *this >= other
+    BigUnsigned& operator-=(const BigUnsigned& other) {
+        uint32_t borrow = 0;
+        for (size_t i = 0; i < _limbs.size(); ++i) {
+            if ((i >= other._limbs.size()) && (borrow == 0)) {
+                break;
+            }
+            const uint64_t subtrahend =
+                    uint64_t{borrow} + (i < other._limbs.size() ? other._limbs[i] : 0);
+            borrow = (_limbs[i] < subtrahend);
+            _limbs[i] = static_cast<uint32_t>(_limbs[i] - subtrahend);
+        }
+        Trim();
+        return *this;
+    }
+
+    BigUnsigned& operator*=(uint32_t factor) {
+        uint64_t carry = 0;
+        for (uint32_t& limb : _limbs) {
+            carry += uint64_t{limb} * factor;
+            limb = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        if (carry != 0) {
+            _limbs.push_back(static_cast<uint32_t>(carry));
+        }
+        Trim();
+        return *this;
+    }
+
+    friend BigUnsigned operator*(const BigUnsigned& a, const BigUnsigned& b) {
+        BigUnsigned product;
+        if (a.is_zero() || b.is_zero()) {
+            return product;
+        }
+        product._limbs.assign(a._limbs.size() + b._limbs.size(), 0);
+        for (size_t i = 0; i < a._limbs.size(); ++i) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < b._limbs.size(); ++j) {
+                carry += uint64_t{a._limbs[i]} * b._limbs[j] + product._limbs[i + j];
+                product._limbs[i + j] = static_cast<uint32_t>(carry);
+                carry >>= 32;
+            }
+            product._limbs[i + b._limbs.size()] = static_cast<uint32_t>(carry);
+        }
+        product.Trim();
+        return product;
+    }
+
+    // Divides in place, returning the remainder (divisor must not be zero)
+    uint32_t DivideSmall(uint32_t divisor) {
+        uint64_t remainder = 0;
+        for (size_t i = _limbs.size(); i-- > 0;) {
+            const uint64_t current = (remainder << 32) | _limbs[i];
+            _limbs[i] = static_cast<uint32_t>(current / divisor);
+            remainder = current % divisor;
+        }
+        Trim();
+        return static_cast<uint32_t>(remainder);
+    }
+
+    // Sets quotient and remainder of dividend / divisor (divisor must not be zero), using
+    // Knuth's Algorithm D (The Art of Computer Programming, vol. 2, section 4.3.1)
+    static void DivMod(const BigUnsigned& dividend, const BigUnsigned& divisor,
+                       BigUnsigned* quotient, BigUnsigned* remainder) {
+        if (dividend < divisor) {
+            *remainder = dividend;
+            *quotient = BigUnsigned();
+            return;
+        }
+        if (divisor._limbs.size() == 1) {
+            BigUnsigned result = dividend;
+            *remainder = BigUnsigned(result.DivideSmall(divisor._limbs[0]));
+            *quotient = std::move(result);
+            return;
+        }
+        // Normalize so the divisor's top bit is set, which makes each quotient digit estimate
+        // off by at most 2
+        const size_t n = divisor._limbs.size();
+        const size_t m = dividend._limbs.size() - n;
+        const int shift = std::countl_zero(divisor._limbs.back());
+        std::vector<uint32_t> v = ShiftedLeft(divisor._limbs, shift);
+        std::vector<uint32_t> u = ShiftedLeft(dividend._limbs, shift);
+        u.resize(m + n + 1, 0);
+        if (shift > 0) {
+            u[m + n] = dividend._limbs.back() >> (32 - shift);
+        }
+        BigUnsigned result;
+        result._limbs.assign(m + 1, 0);
+        for (size_t j = m + 1; j-- > 0;) {
+            const uint64_t numerator = (uint64_t{u[j + n]} << 32) | u[j + n - 1];
+            uint64_t q_hat = numerator / v[n - 1];
+            uint64_t r_hat = numerator % v[n - 1];
+            while (((q_hat >> 32) != 0) ||
+                    (q_hat * v[n - 2] > ((r_hat << 32) | u[j + n - 2]))) {
+                --q_hat;
+                r_hat += v[n - 1];
+                if ((r_hat >> 32) != 0) {
+                    break;
+                }
+            }
+            // u[j, j + n] -= q_hat * v
+            int64_t borrow = 0;
+            int64_t difference = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const uint64_t product = q_hat * v[i];
+                difference = int64_t{u[i + j]} - borrow - static_cast<int64_t>(product & 0xFFFFFFFF);
+                u[i + j] = static_cast<uint32_t>(difference);
+                borrow = static_cast<int64_t>(product >> 32) - (difference >> 32);
+            }
+            difference = int64_t{u[j + n]} - borrow;
+            u[j + n] = static_cast<uint32_t>(difference);
+            result._limbs[j] = static_cast<uint32_t>(q_hat);
+            if (difference < 0) {  // q_hat was one too large: add v back
+                --result._limbs[j];
+                uint64_t carry = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    carry += uint64_t{u[i + j]} + v[i];
+                    u[i + j] = static_cast<uint32_t>(carry);
+                    carry >>= 32;
+                }
+                u[j + n] += static_cast<uint32_t>(carry);
+            }
+        }
+        result.Trim();
+        // The remainder is what's left of u, shifted back
+        remainder->_limbs.assign(n, 0);
+        for (size_t i = 0; i < n; ++i) {
+            remainder->_limbs[i] = u[i] >> shift;
+            if (shift > 0) {
+                remainder->_limbs[i] |= u[i + 1] << (32 - shift);
+            }
+        }
+        remainder->Trim();
+        *quotient = std::move(result);
+    }
+
+    std::string to_string() const {
+        if (is_zero()) {
+            return "0";
+        }
+        // Base 10^9 digits, least significant first
+        std::vector<uint32_t> chunks;
+        BigUnsigned rest = *this;
+        while (!rest.is_zero()) {
+            chunks.push_back(rest.DivideSmall(1'000'000'000));
+        }
+        std::string result = std::to_string(chunks.back());
+        for (size_t i = chunks.size() - 1; i-- > 0;) {
+            const std::string chunk = std::to_string(chunks[i]);
+            result += std::string(9 - chunk.size(), '0') + chunk;
+        }
+        return result;
+    }
+
+  private:
+    static std::vector<uint32_t> ShiftedLeft(const std::vector<uint32_t>& limbs, int shift) {
+        std::vector<uint32_t> shifted(limbs.size());
+        for (size_t i = 0; i < limbs.size(); ++i) {
+            shifted[i] = limbs[i] << shift;
+            if ((shift > 0) && (i > 0)) {
+                shifted[i] |= limbs[i - 1] >> (32 - shift);
+            }
+        }
+        return shifted;
+    }
+
+    void Trim() {
+        while (!_limbs.empty() && (_limbs.back() == 0)) {
+            _limbs.pop_back();
+        }
+    }
+
+    std::vector<uint32_t> _limbs;
+};
+
+std::ostream& operator<<(std::ostream& os, const BigUnsigned& value) {
+    return os << value.to_string();
+}
+
+// Number of ways to choose k of n things
+BigUnsigned Binomial(size_t n, size_t k) {
+    k = std::min(k, n - k);
+    BigUnsigned result(1);
+    // After step i, result = binomial(n - k + i, i)
+    for (size_t i = 1; i <= k; ++i) {
+        result *= static_cast<uint32_t>(n - k + i);
+        result.DivideSmall(static_cast<uint32_t>(i));
+    }
+    return result;
+}
+
+// Counts, ranks and unranks the BST sequences of the tree rooted at root_ptr without
+// enumerating them.  Ranks follow the order of BinaryTree::BstSequences.  The tree must not
+// change while the ranker is in use.
+template <typename T>
+class BstSequenceRanker {
+  public:
+    explicit BstSequenceRanker(const Node<T>* root_ptr) {
+        // Number the nodes in preorder
+        std::vector<const Node<T>*> node_stack;
+        if (root_ptr != nullptr) {
+            node_stack.push_back(root_ptr);
+        }
+        std::vector<bool> has_left_child;
+        std::vector<bool> has_right_child;
+        while (!node_stack.empty()) {
+            const Node<T>* node_ptr = node_stack.back();
+            node_stack.pop_back();
+            _node_values.push_back(node_ptr->value);
+            has_left_child.push_back(node_ptr->left_child_ptr != nullptr);
+            has_right_child.push_back(node_ptr->right_child_ptr != nullptr);
+            if (node_ptr->right_child_ptr != nullptr) {
+                node_stack.push_back(node_ptr->right_child_ptr.get());
+            }
+            if (node_ptr->left_child_ptr != nullptr) {
+                node_stack.push_back(node_ptr->left_child_ptr.get());
+            }
+        }
+        // In preorder, node v's left child is v + 1 and its right child comes right after
+        // the left subtree, so everything can be filled in from the back
+        const size_t n = _node_values.size();
+        _left_size.assign(n, 0);
+        _subtree_size.assign(n, 1);
+        _num_interleavings.resize(n);
+        _num_sequences.resize(n);
+        for (size_t v = n; v-- > 0;) {
+            _left_size[v] = has_left_child[v] ? _subtree_size[v + 1] : 0;
+            const size_t right_child = v + 1 + _left_size[v];
+            const size_t right_size = has_right_child[v] ? _subtree_size[right_child] : 0;
+            _subtree_size[v] = 1 + _left_size[v] + right_size;
+            _num_interleavings[v] = Binomial(_left_size[v] + right_size, _left_size[v]);
+            _num_sequences[v] = _num_interleavings[v];
+            if (has_left_child[v]) {
+                _num_sequences[v] = _num_sequences[v] * _num_sequences[v + 1];
+            }
+            if (has_right_child[v]) {
+                _num_sequences[v] = _num_sequences[v] * _num_sequences[right_child];
+            }
+        }
+        if (n > 0) {
+            _count = _num_sequences[0];
+        }
+    }
+
+    // Number of sequences
+    const BigUnsigned& count() const {
+        return _count;
+    }
+
+    // The sequence at index rank of BstSequences (rank must be less than count())
+    std::vector<T> Unrank(const BigUnsigned& rank) const {
+        return ToValues(UnrankNodes(rank));
+    }
+
+    // Same as Unrank, but as node numbers (nodes are numbered in preorder)
+    std::vector<size_t> UnrankNodes(const BigUnsigned& rank) const {
+        // Start from the preorder sequence, where every subtree occupies the positions of its
+        // own node numbers; UnrankRecursive rearranges each subtree within those positions
+        std::vector<size_t> sequence(_node_values.size());
+        std::iota(sequence.begin(), sequence.end(), 0);
+        if (!sequence.empty()) {
+            UnrankRecursive(0, rank, sequence);
+        }
+        return sequence;
+    }
+
+    // Index of sequence in BstSequences.  The tree's values must be distinct (as in a BST),
+    // and sequence must be one of its BST sequences.
+    BigUnsigned Rank(const std::vector<T>& sequence) const {
+        std::map<T, size_t> node_of_value;
+        for (size_t v = 0; v < _node_values.size(); ++v) {
+            node_of_value[_node_values[v]] = v;
+        }
+        std::vector<size_t> nodes;
+        nodes.reserve(sequence.size());
+        for (const T& value : sequence) {
+            nodes.push_back(node_of_value.at(value));
+        }
+        return nodes.empty() ? BigUnsigned() : RankRecursive(0, nodes, 0);
+    }
+
+  private:
+    // Arranges the subtree of v, which occupies sequence[v, v + subtree size), as its
+    // sequence of the given rank
+    void UnrankRecursive(size_t v, const BigUnsigned& rank, std::vector<size_t>& sequence) const {
+        const size_t num_left = _left_size[v];
+        const size_t num_right = _subtree_size[v] - 1 - num_left;
+        const size_t right_child = v + 1 + num_left;
+        if ((num_left > 0) && (num_right > 0)) {
+            BigUnsigned children_rank;
+            BigUnsigned pattern_rank;
+            BigUnsigned::DivMod(rank, _num_interleavings[v], &children_rank, &pattern_rank);
+            BigUnsigned left_rank;
+            BigUnsigned right_rank;
+            BigUnsigned::DivMod(children_rank, _num_sequences[right_child], &left_rank,
+                                &right_rank);
+            UnrankRecursive(v + 1, left_rank, sequence);
+            UnrankRecursive(right_child, right_rank, sequence);
+            Interleave(v, pattern_rank, sequence);
+        } else if (num_left > 0) {
+            UnrankRecursive(v + 1, rank, sequence);
+        } else if (num_right > 0) {
+            UnrankRecursive(right_child, rank, sequence);
+        }
+    }
+
+    // Interleaves v's left subtree elements, at the front of sequence[v + 1, v + subtree size),
+    // with its right subtree elements after them, following the pattern of the given rank
+    void Interleave(size_t v, BigUnsigned pattern_rank, std::vector<size_t>& sequence) const {
+        const size_t begin = v + 1;
+        const size_t end = v + _subtree_size[v];
+        const size_t num_left = _left_size[v];
+        const std::vector<size_t> left_elements(sequence.begin() + begin,
+                                                sequence.begin() + begin + num_left);
+        const std::vector<size_t> right_elements(sequence.begin() + begin + num_left,
+                                                 sequence.begin() + end);
+        size_t num_left_taken = 0;
+        size_t num_right_taken = 0;
+        BigUnsigned num_patterns = _num_interleavings[v];  // for the elements not yet taken
+        BigUnsigned num_starting_left;
+        for (size_t position = begin; position < end; ++position) {
+            const size_t left_remaining = left_elements.size() - num_left_taken;
+            const size_t right_remaining = right_elements.size() - num_right_taken;
+            bool take_left = (right_remaining == 0);
+            if ((left_remaining > 0) && (right_remaining > 0)) {
+                num_starting_left = num_patterns;
+                num_starting_left *= static_cast<uint32_t>(left_remaining);
+                num_starting_left.DivideSmall(static_cast<uint32_t>(left_remaining +
+                                                                    right_remaining));
+                take_left = (pattern_rank < num_starting_left);
+                if (take_left) {
+                    num_patterns = num_starting_left;
+                } else {
+                    pattern_rank -= num_starting_left;
+                    num_patterns -= num_starting_left;
+                }
+            }
+            sequence[position] = take_left ? left_elements[num_left_taken++]
+                                           : right_elements[num_right_taken++];
+        }
+    }
+
+    // Rank of the subtree of v, whose nodes appear (in some order) in
+    // nodes[begin, begin + subtree size).  Leaves that range in preorder.
+    BigUnsigned RankRecursive(size_t v, std::vector<size_t>& nodes, size_t begin) const {
+        const size_t num_left = _left_size[v];
+        const size_t num_right = _subtree_size[v] - 1 - num_left;
+        const size_t right_child = v + 1 + num_left;
+        if ((num_left > 0) && (num_right > 0)) {
+            const BigUnsigned pattern_rank = Deinterleave(v, nodes, begin);
+            BigUnsigned rank = RankRecursive(v + 1, nodes, begin + 1) *
+                               _num_sequences[right_child];
+            rank += RankRecursive(right_child, nodes, begin + 1 + num_left);
+            rank = rank * _num_interleavings[v];
+            rank += pattern_rank;
+            return rank;
+        } else if (num_left > 0) {
+            return RankRecursive(v + 1, nodes, begin + 1);
+        } else if (num_right > 0) {
+            return RankRecursive(right_child, nodes, begin + 1);
+        }
+        return BigUnsigned();
+    }
+
+    // Returns the rank of the interleaving pattern of v's subtree in nodes[begin, ...), and
+    // moves its left subtree elements in front of its right subtree elements
+    BigUnsigned Deinterleave(size_t v, std::vector<size_t>& nodes, size_t begin) const {
+        const size_t end = begin + _subtree_size[v];
+        const size_t num_left = _left_size[v];
+        const size_t num_right = _subtree_size[v] - 1 - num_left;
+        const size_t right_child = v + 1 + num_left;
+        std::vector<size_t> left_elements;
+        std::vector<size_t> right_elements;
+        BigUnsigned pattern_rank;
+        BigUnsigned num_patterns = _num_interleavings[v];  // for the elements not yet seen
+        BigUnsigned num_starting_left;
+        for (size_t position = begin + 1; position < end; ++position) {
+            const size_t left_remaining = num_left - left_elements.size();
+            const size_t right_remaining = num_right - right_elements.size();
+            const bool is_left = (nodes[position] < right_child);
+            if ((left_remaining > 0) && (right_remaining > 0)) {
+                num_starting_left = num_patterns;
+                num_starting_left *= static_cast<uint32_t>(left_remaining);
+                num_starting_left.DivideSmall(static_cast<uint32_t>(left_remaining +
+                                                                    right_remaining));
+                if (is_left) {
+                    num_patterns = num_starting_left;
+                } else {
+                    pattern_rank += num_starting_left;
+                    num_patterns -= num_starting_left;
+                }
+            }
+            (is_left ? left_elements : right_elements).push_back(nodes[position]);
+        }
+        std::copy(left_elements.begin(), left_elements.end(), nodes.begin() + begin + 1);
+        std::copy(right_elements.begin(), right_elements.end(),
+                  nodes.begin() + begin + 1 + num_left);
+        return pattern_rank;
+    }
+
+    std::vector<T> ToValues(const std::vector<size_t>& sequence) const {
+        std::vector<T> values;
+        values.reserve(sequence.size());
+        for (const size_t v : sequence) {
+            values.push_back(_node_values[v]);
+        }
+        return values;
+    }
+
+    // Per node, numbered in preorder
+    std::vector<T> _node_values;
+    std::vector<size_t> _left_size;
+    std::vector<size_t> _subtree_size;
+    std::vector<BigUnsigned> _num_interleavings;  // binomial(subtree size - 1, left size)
+    std::vector<BigUnsigned> _num_sequences;
+    BigUnsigned _count;
+};
+
+// Produces the BST sequences of the tree rooted at root_ptr one at a time, in the same order
+// as BinaryTree::BstSequences:
+//     for (BstSequenceGenerator<T> generator(root); !generator.done(); generator.next()) {
+//         use(generator.current());
+//     }
+// The tree must not change while the generator is in use.
+template <typename T>
+class BstSequenceGenerator {
+  public:
+    explicit BstSequenceGenerator(const Node<T>* root_ptr) {
+        // Number the nodes in preorder
+        std::vector<const Node<T>*> node_stack;
+        if (root_ptr != nullptr) {
+            node_stack.push_back(root_ptr);
+        }
+        std::vector<bool> has_left_child;
+        std::vector<bool> has_right_child;
+        while (!node_stack.empty()) {
+            const Node<T>* node_ptr = node_stack.back();
+            node_stack.pop_back();
+            _node_values.push_back(node_ptr->value);
+            has_left_child.push_back(node_ptr->left_child_ptr != nullptr);
+            has_right_child.push_back(node_ptr->right_child_ptr != nullptr);
+            if (node_ptr->right_child_ptr != nullptr) {
+                node_stack.push_back(node_ptr->right_child_ptr.get());
+            }
+            if (node_ptr->left_child_ptr != nullptr) {
+                node_stack.push_back(node_ptr->left_child_ptr.get());
+            }
+        }
+        // In preorder, node v's left child is v + 1 and its right child comes right after
+        // the left subtree, so sizes can be filled in from the back
+        const size_t n = _node_values.size();
+        _left_size.assign(n, 0);
+        _subtree_size.assign(n, 1);
+        for (size_t v = n; v-- > 0;) {
+            _left_size[v] = has_left_child[v] ? _subtree_size[v + 1] : 0;
+            const size_t right_size =
+                    has_right_child[v] ? _subtree_size[v + 1 + _left_size[v]] : 0;
+            _subtree_size[v] = 1 + _left_size[v] + right_size;
+        }
+        _sequence.resize(n);
+        _values.resize(n);
+        for (size_t v = 0; v < n; ++v) {
+            _sequence[v] = v;
+            _values[v] = _node_values[v];
+        }
+        _pattern.resize(n);
+        _scratch.resize(n);
+        _done = (n == 0);
+    }
+
+    // Starts from first_sequence, given as node numbers (nodes are numbered in preorder, as
+    // in BstSequenceRanker::UnrankNodes), instead of from the first sequence of BstSequences
+    BstSequenceGenerator(const Node<T>* root_ptr, std::vector<size_t> first_sequence)
+            : BstSequenceGenerator(root_ptr) {
+        _sequence = std::move(first_sequence);
+        for (size_t position = 0; position < _sequence.size(); ++position) {
+            _values[position] = _node_values[_sequence[position]];
+        }
+    }
+
+    bool done() const {
+        return _done;
+    }
+
+    // The current sequence (only valid while !done())
+    const std::vector<T>& current() const {
+        return _values;
+    }
+
+    void next() {
+        _done = !Advance(0, 0, _sequence.size());
+    }
+
+  private:
+    // Advances the subtree of node v, whose elements occupy positions [begin, end) of the
+    // current sequence, to its next arrangement.  Returns false if it wrapped around to its
+    // first arrangement instead.
+    bool Advance(size_t v, size_t begin, size_t end) {
+        const size_t num_left = _left_size[v];
+        const size_t num_right = _subtree_size[v] - 1 - num_left;
+        const size_t right_child = v + 1 + num_left;
+        if ((num_left > 0) && (num_right > 0)) {
+            // Pattern: 0 for left subtree elements, 1 for right subtree elements.
+            // The left elements are copied to the front of _scratch, the right ones after them.
+            size_t num_left_seen = 0;
+            size_t num_right_seen = 0;
+            for (size_t position = begin + 1; position < end; ++position) {
+                const bool is_right = (_sequence[position] >= right_child);
+                _pattern[position] = is_right;
+                if (is_right) {
+                    _scratch[num_left + num_right_seen++] = _sequence[position];
+                } else {
+                    _scratch[num_left_seen++] = _sequence[position];
+                }
+            }
+            const bool advanced = std::next_permutation(_pattern.begin() + begin + 1,
+                                                        _pattern.begin() + end);
+            num_left_seen = 0;
+            num_right_seen = 0;
+            for (size_t position = begin + 1; position < end; ++position) {
+                _sequence[position] = _pattern[position]
+                        ? _scratch[num_left + num_right_seen++] : _scratch[num_left_seen++];
+                _values[position] = _node_values[_sequence[position]];
+            }
+            if (advanced) {
+                return true;
+            }
+        }
+        if ((num_right > 0) && Advance(right_child, end - num_right, end)) {
+            return true;
+        }
+        if ((num_left > 0) && Advance(v + 1, begin + 1, begin + 1 + num_left)) {
+            return true;
+        }
+        return false;
+    }
+
+    // Per node, numbered in preorder
+    std::vector<T> _node_values;
+    std::vector<size_t> _left_size;
+    std::vector<size_t> _subtree_size;
+    // Current sequence, as node numbers and as values
+    std::vector<size_t> _sequence;
+    std::vector<T> _values;
+    // Scratch space for Advance, used by one node at a time
+    std::vector<char> _pattern;
+    std::vector<size_t> _scratch;
+    bool _done;
+};
+
+// Calls func(thread_index) on num_threads threads (one of them the calling thread)
+template <typename Func>
+void RunOnThreads(size_t num_threads, Func&& func) {
+    std::vector<std::thread> threads;
+    for (size_t thread_index = 1; thread_index < num_threads; ++thread_index) {
+        threads.emplace_back(func, thread_index);
+    }
+    func(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// Enumerates the BST sequences of the tree rooted at root_ptr in parallel.  The sequences are
+// split by rank into num_shards contiguous shards, which num_threads threads take one at a
+// time.  Shard s is the sequences with ranks in [count * s / num_shards,
+// count * (s + 1) / num_shards), and calls sink(s, sequence) for each of them in order, all
+// from the same thread.  So concatenating the shards' sequences in shard order gives exactly
+// the output of BstSequences.  Different shards run at the same time, so sink must be safe to
+// call for different shards concurrently.  Returning false from sink stops that shard.
+// Returns the number of sequences passed to sink.  Throws std::length_error (before starting
+// any threads) if num_shards doesn't fit in 32 bits, or if a shard would hold 2^64 or more
+// sequences (there would be no time to enumerate that many anyway).  If sink (or anything
+// else on a worker thread) throws, the other threads stop after their current shard, and the
+// exception is rethrown here once they have all finished.
+template <typename T, typename ShardSink>
+uint64_t ForEachBstSequenceInShards(const Node<T>* root_ptr, size_t num_threads,
+                                    size_t num_shards, ShardSink&& sink) {
+    if ((num_shards == 0) || (num_shards > UINT32_MAX)) {
+        throw std::length_error("ForEachBstSequenceInShards: need 1 to 2^32 - 1 shards");
+    }
+    const BstSequenceRanker<T> ranker(root_ptr);
+    // Shard sizes are count / num_shards, rounded down or up
+    BigUnsigned max_shard_size = ranker.count();
+    if (max_shard_size.DivideSmall(static_cast<uint32_t>(num_shards)) != 0) {
+        max_shard_size += BigUnsigned(1);
+    }
+    if (max_shard_size.bit_length() > 64) {
+        throw std::length_error("ForEachBstSequenceInShards: too many sequences per shard");
+    }
+    auto shard_begin = [&](size_t shard) {
+        BigUnsigned rank = ranker.count();
+        rank *= static_cast<uint32_t>(shard);
+        rank.DivideSmall(static_cast<uint32_t>(num_shards));
+        return rank;
+    };
+    std::atomic<size_t> next_shard = 0;
+    std::atomic<uint64_t> num_sequences = 0;
+    // An exception escaping a std::thread would call std::terminate, so each thread keeps its
+    // own, to be rethrown after the join
+    std::vector<std::exception_ptr> thread_exceptions(std::max<size_t>(num_threads, 1));
+    std::atomic<bool> failed = false;
+    RunOnThreads(num_threads, [&](size_t thread_index) {
+        try {
+            for (size_t shard = next_shard++; (shard < num_shards) && !failed;
+                    shard = next_shard++) {
+                const BigUnsigned begin_rank = shard_begin(shard);
+                BigUnsigned shard_size = shard_begin(shard + 1);
+                shard_size -= begin_rank;
+                uint64_t remaining = shard_size.low_64_bits();
+                if (remaining == 0) {
+                    continue;
+                }
+                // Jump straight to the shard's first sequence, then generate from there
+                BstSequenceGenerator<T> generator(root_ptr, ranker.UnrankNodes(begin_rank));
+                uint64_t num_shard_sequences = 0;
+                while (true) {
+                    ++num_shard_sequences;
+                    if (!sink(shard, generator.current()) || (--remaining == 0)) {
+                        break;
+                    }
+                    generator.next();
+                }
+                num_sequences += num_shard_sequences;
+            }
+        } catch (...) {
+            thread_exceptions[thread_index] = std::current_exception();
+            failed = true;
+        }
+    });
+    for (const std::exception_ptr& thread_exception : thread_exceptions) {
+        if (thread_exception != nullptr) {
+            std::rethrow_exception(thread_exception);
+        }
+    }
+    return num_sequences;
+}
+
+template <typename T>
+class BinaryTree {
+  public:
+    BinaryTree() {}
+
+    // Simple insert: inserts value at next available node to make complete tree
+    void insert(const T& value) {
+        std::vector<Node<T>*> path_to_inserted_node = FindNthNodePath(_size + 1);
+        path_to_inserted_node.back()->value = value;
+    }
+
+    size_t size() {
+        return _size;
+    }
+
+    // Copy of BstSequences from binary_search_tree_sequences.cpp, kept here as the reference
+    // for correctness checks and benchmarking
+    std::vector<std::vector<T>> BstSequences() {
+        return BstSequencesRecursive(_root.get());
+    }
+
+    std::vector<std::vector<T>> BstSequencesRecursive(const Node<T>* root_ptr) {
+        const bool has_left_child = root_ptr->left_child_ptr != nullptr;
+        const bool has_right_child = root_ptr->right_child_ptr != nullptr;
+        if (!has_left_child && !has_right_child) {
+            return {std::vector<T>{root_ptr->value}};
+        } else if (has_left_child && !has_right_child) {
+            std::vector<std::vector<T>> left_subtree_sequences =
+                    BstSequencesRecursive(root_ptr->left_child_ptr.get());
+            for (std::vector<T>& left_seq : left_subtree_sequences) {
+                left_seq.insert(left_seq.begin(), root_ptr->value);
+            }
+            return left_subtree_sequences;
+        } else if (!has_left_child && has_right_child) {
+            std::vector<std::vector<T>> right_subtree_sequences =
+                    BstSequencesRecursive(root_ptr->right_child_ptr.get());
+            for (std::vector<T>& right_seq : right_subtree_sequences) {
+                right_seq.insert(right_seq.begin(), root_ptr->value);
+            }
+            return right_subtree_sequences;
+        }
+        std::vector<std::vector<T>> left_subtree_sequences =
+                BstSequencesRecursive(root_ptr->left_child_ptr.get());
+        std::vector<std::vector<T>> right_subtree_sequences =
+                BstSequencesRecursive(root_ptr->right_child_ptr.get());
+        std::vector<std::vector<T>> all_interleaved_sequences;
+        for (const std::vector<T>& left_seq : left_subtree_sequences) {
+            for (const std::vector<T>& right_seq : right_subtree_sequences) {
+                std::vector<std::vector<T>> new_sequences =
+                        GenerateInterleavedSequences(left_seq, right_seq);
+                all_interleaved_sequences.insert(
+                        all_interleaved_sequences.end(),
+                        std::make_move_iterator(new_sequences.begin()),
+                        std::make_move_iterator(new_sequences.end()));
+            }
+        }
+        for (std::vector<T>& interleaved_seq : all_interleaved_sequences) {
+            interleaved_seq.insert(interleaved_seq.begin(), root_ptr->value);
+        }
+        return all_interleaved_sequences;
+    }
+
+    // Ranks and unranks the sequences BstSequences would return
+    BstSequenceRanker<T> BstSequencesRanker() const {
+        return BstSequenceRanker<T>(_root.get());
+    }
+
+    // Calls sink(sequence) for each sequence BstSequences would return, in the same order,
+    // stopping early if sink returns false.  The sequence passed to sink is a reused buffer,
+    // only valid during the call.  Returns the number of sequences passed to sink.
+    template <typename Sink>
+    uint64_t ForEachBstSequence(Sink&& sink) const {
+        uint64_t num_sequences = 0;
+        for (BstSequenceGenerator<T> generator(_root.get()); !generator.done();
+                generator.next()) {
+            ++num_sequences;
+            if (!sink(generator.current())) {
+                break;
+            }
+        }
+        return num_sequences;
+    }
+
+    // Parallel ForEachBstSequence (see ForEachBstSequenceInShards)
+    template <typename ShardSink>
+    uint64_t ForEachBstSequenceParallel(size_t num_threads, size_t num_shards,
+                                        ShardSink&& sink) const {
+        return ForEachBstSequenceInShards(_root.get(), num_threads, num_shards, sink);
+    }
+
+  private:
+    // Retrieve the nth node in the tree assuming the tree is complete,
+    // inserting a new node if it does not exist (and any nodes along the path).
+    // Return a vector of the nodes along the path from route to the nth node.
+    // Note: n is 1-indexed here, as it makes the math easier!
+    std::vector<Node<T>*> FindNthNodePath(size_t n) {
+        size_t modulus = 1;
+        while (n / modulus > 1) {
+            modulus *= 2;
+        }
+        std::vector<Node<T>*> path_vector;
+        Node<T>* current_node_ptr = _root.get();
+        if (_root == nullptr) {
+            _root = std::make_unique<Node<T>>();
+            ++_size;
+            current_node_ptr = _root.get();
+        }
+        path_vector.push_back(current_node_ptr);
+        for (/* modulus */; modulus > 1; modulus /= 2) {
+            if ((n % modulus) < (modulus / 2)) {  // left
+                if (current_node_ptr->left_child_ptr == nullptr) {
+                    current_node_ptr->left_child_ptr = std::make_unique<Node<T>>();
+                    ++_size;
+                }
+                current_node_ptr = current_node_ptr->left_child_ptr.get();
+            } else {  // right
+                if (current_node_ptr->right_child_ptr == nullptr) {
+                    current_node_ptr->right_child_ptr = std::make_unique<Node<T>>();
+                    ++_size;
+                }
+                current_node_ptr = current_node_ptr->right_child_ptr.get();
+            }
+            path_vector.push_back(current_node_ptr);
+        }
+        return path_vector;
+    }
+
+    std::unique_ptr<Node<T>> _root;
+    size_t _size = 0;
+};
+
+// Complete tree of values 0..n-1 inserted in level order (the structure is all that matters
+// for BST sequences)
+BinaryTree<int> MakeCompleteTree(int n) {
+    BinaryTree<int> tree;
+    for (int value = 0; value < n; ++value) {
+        tree.insert(value);
+    }
+    return tree;
+}
+
+// Root of the BST built by inserting values in order
+std::unique_ptr<Node<int>> MakeBst(const std::vector<int>& values) {
+    std::unique_ptr<Node<int>> root_ptr;
+    for (const int value : values) {
+        std::unique_ptr<Node<int>>* link_ptr = &root_ptr;
+        Node<int>* parent_ptr = nullptr;
+        while (*link_ptr != nullptr) {
+            parent_ptr = link_ptr->get();
+            link_ptr = (value < parent_ptr->value) ? &parent_ptr->left_child_ptr
+                                                   : &parent_ptr->right_child_ptr;
+        }
+        *link_ptr = std::make_unique<Node<int>>();
+        (*link_ptr)->parent_ptr_raw = parent_ptr;
+        (*link_ptr)->value = value;
+    }
+    return root_ptr;
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+// Per-shard sink state, padded to a cache line so that threads don't contend for one
+struct alignas(64) ShardResult {
+    uint64_t num_sequences = 0;
+    uint64_t checksum = 0;
+    std::vector<int> first_sequence;
+};
+
+// Order-dependent checksum of one sequence
+uint64_t SequenceChecksum(const std::vector<int>& sequence) {
+    uint64_t checksum = 0;
+    for (const int value : sequence) {
+        checksum = checksum * 1'000'003 + value;
+    }
+    return checksum;
+}
+
+int main() {
+    std::vector<int> test_values{
+            3,
+            1, 5,
+            0, 2};
+    BinaryTree<int> test_tree;
+    for (const int value : test_values) {
+        test_tree.insert(value);
+    }
+    std::vector<std::vector<std::vector<int>>> test_shards(3);
+    test_tree.ForEachBstSequenceParallel(2, 3, [&](size_t shard, const std::vector<int>& seq) {
+        test_shards[shard].push_back(seq);
+        return true;
+    });
+    for (size_t shard = 0; shard < test_shards.size(); ++shard) {
+        std::cout << "Shard " << shard << ":" << std::endl;
+        for (const std::vector<int>& seq : test_shards[shard]) {
+            std::cout << "    " << seq << std::endl;
+        }
+    }
+    std::cout << std::endl;
+
+    // The shards, concatenated in order, must be exactly BstSequences, for any number of
+    // shards and threads (including more shards than sequences).  Random BSTs are included
+    // since, unlike complete trees, they have many nodes with one child.
+    std::mt19937 rng(12345);
+    const size_t kShardCounts[] = {1, 2, 3, 7, 64, 1000};
+    for (int trial = 0; trial < 300; ++trial) {
+        const int n = 1 + trial % 11;
+        BinaryTree<int> complete_tree = MakeCompleteTree(n);
+        std::vector<int> values(n);
+        std::iota(values.begin(), values.end(), 0);
+        std::shuffle(values.begin(), values.end(), rng);
+        const std::unique_ptr<Node<int>> bst_root_ptr = MakeBst(values);
+        const bool use_complete_tree = (trial < 11);
+        const std::vector<std::vector<int>> expected =
+                use_complete_tree ? complete_tree.BstSequences()
+                                  : complete_tree.BstSequencesRecursive(bst_root_ptr.get());
+        const size_t num_shards = kShardCounts[trial % 6];
+        const size_t num_threads = 1 + trial % 4;
+        std::vector<std::vector<std::vector<int>>> shards(num_shards);
+        auto shard_sink = [&](size_t shard, const std::vector<int>& seq) {
+            shards[shard].push_back(seq);
+            return true;
+        };
+        const uint64_t num_sequences =
+                use_complete_tree
+                        ? complete_tree.ForEachBstSequenceParallel(num_threads, num_shards,
+                                                                   shard_sink)
+                        : ForEachBstSequenceInShards(bst_root_ptr.get(), num_threads,
+                                                     num_shards, shard_sink);
+        std::vector<std::vector<int>> concatenated;
+        for (const std::vector<std::vector<int>>& shard : shards) {
+            concatenated.insert(concatenated.end(), shard.begin(), shard.end());
+        }
+        if ((concatenated != expected) || (num_sequences != expected.size())) {
+            std::cout << "MISMATCH on trial " << trial << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Small trees: concatenated shards match BstSequences" << std::endl
+              << std::endl;
+
+    // Shard counts over 32 bits, or shards of 2^64 or more sequences, must be rejected rather
+    // than truncated.  The complete tree of 31 nodes has about 7.5e22 sequences.
+    BinaryTree<int> huge_tree = MakeCompleteTree(31);
+    for (const size_t num_shards : {size_t{0}, size_t{1}, size_t{1000}, size_t{1} << 32}) {
+        bool threw = false;
+        try {
+            huge_tree.ForEachBstSequenceParallel(
+                    2, num_shards, [](size_t, const std::vector<int>&) { return false; });
+        } catch (const std::length_error&) {
+            threw = true;
+        }
+        if (!threw) {
+            std::cout << "No std::length_error for " << num_shards << " shards" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Complete tree of 31 nodes with 0, 1, 1000 or 2^32 shards: std::length_error"
+              << std::endl;
+
+    // An exception from sink on any thread must reach the caller instead of terminating
+    BinaryTree<int> throwing_tree = MakeCompleteTree(7);
+    for (const size_t throwing_shard : {size_t{0}, size_t{5}, size_t{63}}) {
+        bool threw = false;
+        try {
+            throwing_tree.ForEachBstSequenceParallel(
+                    4, 64, [&](size_t shard, const std::vector<int>&) {
+                        if (shard == throwing_shard) {
+                            throw std::runtime_error("sink failed");
+                        }
+                        return true;
+                    });
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        if (!threw) {
+            std::cout << "No exception from a sink throwing in shard " << throwing_shard
+                      << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Sinks throwing on worker threads: exception rethrown to the caller"
+              << std::endl << std::endl;
+
+    // Benchmark: complete tree of 15 nodes, 21964800 sequences
+    BinaryTree<int> bench_tree = MakeCompleteTree(15);
+    const BstSequenceRanker<int> bench_ranker = bench_tree.BstSequencesRanker();
+    uint64_t sequential_count = 0;
+    uint64_t sequential_checksum = 0;
+    const double sequential_seconds = TimeSeconds([&]() {
+        sequential_count = bench_tree.ForEachBstSequence([&](const std::vector<int>& seq) {
+            sequential_checksum += SequenceChecksum(seq);
+            return true;
+        });
+    });
+    std::cout << "Benchmark: complete tree of 15 nodes, " << bench_ranker.count()
+              << " sequences" << std::endl;
+    std::cout << "    Sequential: " << sequential_seconds << " s" << std::endl;
+    for (const size_t num_threads : {1, 2, 4, 8, 16}) {
+        const size_t num_shards = 4 * num_threads;
+        std::vector<ShardResult> shard_results(num_shards);
+        const double parallel_seconds = TimeSeconds([&]() {
+            bench_tree.ForEachBstSequenceParallel(
+                    num_threads, num_shards, [&](size_t shard, const std::vector<int>& seq) {
+                        ShardResult& result = shard_results[shard];
+                        if (result.num_sequences++ == 0) {
+                            result.first_sequence = seq;
+                        }
+                        result.checksum += SequenceChecksum(seq);
+                        return true;
+                    });
+        });
+        // The checksums and counts must add up to the sequential ones, and each shard must
+        // start at its first rank and stop right before the next shard's first rank
+        uint64_t parallel_count = 0;
+        uint64_t parallel_checksum = 0;
+        bool boundaries_match = true;
+        BigUnsigned next_rank;
+        for (const ShardResult& result : shard_results) {
+            parallel_count += result.num_sequences;
+            parallel_checksum += result.checksum;
+            boundaries_match = boundaries_match &&
+                               (bench_ranker.Rank(result.first_sequence) == next_rank);
+            next_rank += BigUnsigned(result.num_sequences);
+        }
+        const bool results_match = (parallel_count == sequential_count) &&
+                                   (parallel_checksum == sequential_checksum) &&
+                                   boundaries_match && (next_rank == bench_ranker.count());
+        std::cout << "    " << num_threads << " thread(s), " << num_shards << " shards: "
+                  << parallel_seconds << " s, speedup " << sequential_seconds / parallel_seconds
+                  << "x, " << (results_match ? "results match" : "MISMATCH") << std::endl;
+    }
+    std::cout << "(hardware threads available: " << std::thread::hardware_concurrency() << ")"
+              << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,237 @@
+/* Length-only kernel for ComputeLongestAlternatingSubsequence
+ * (see longest_alternating_subsequence.cpp).
+ *
+ * Look at what the greedy keeps on its stack: every element is either pushed or replaces the
+ * top, so after processing element i - 1, the top of the stack is always input[i - 1].  The
+ * comparison is therefore always between *adjacent* elements, and the greedy is really
+ * walking the sequence of signs  s_i = sign(input[i] - input[i - 1]):
+ *   - s_i = 0 (equal values) never pushes anything.
+ *   - A run of equal nonzero signs pushes once, at its first element, if it is the direction
+ *     we are looking for - and after that, the runs alternate, so every run pushes.
+ *   - The only run that can be the wrong direction is the first one, if it is decreasing
+ *     (the first pair must be increasing).
+ * So, ignoring zeros, the length is 1 + (number of sign changes), where the sign "before"
+ * the input is taken to be decreasing - that way a leading decreasing run is not a change.
+ *
+ * Counting changes only needs the previous nonzero sign, carried across zeros.  The scalar
+ * kernel does that with a conditional move and no branches.  The AVX2 kernel computes 8
+ * signs at once, fills in zeros with the previous nonzero sign in 3 shift-and-blend steps
+ * (each lane looks 1, then 2, then 4 lanes back) plus one blend with the sign carried over
+ * from the previous 8 elements, and counts changes with a movemask and popcount.
+ *
+ * Build with -mavx2 (or -march=native) to enable the AVX2 kernel for int.
+ */
+
+#include <bit>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const std::vector<T>& v) {
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i];
+        if (i + 1 < v.size()) os << ", ";
+    }
+    os << "]";
+    return os;
+}
+
+// Copy of ComputeLongestAlternatingSubsequence from longest_alternating_subsequence.cpp,
+// kept here as the reference for correctness checks and benchmarking
+template <typename T>
+std::vector<T> ComputeLongestAlternatingSubsequence(const std::vector<T>& input_vector) {
+    if (input_vector.size() == 0) {
+        return {};
+    }
+    std::vector<T> result_vector{input_vector[0]};
+    bool looking_for_greater = true;
+    for (std::size_t i = 1; i < input_vector.size(); ++i) {
+        const T& current_value = input_vector[i];
+        const auto compare_func = [looking_for_greater](const T& left, const T& right) {
+            return looking_for_greater ? left < right : left > right;
+        };
+        if (compare_func(result_vector.back(), current_value)) {
+            result_vector.push_back(current_value);
+            looking_for_greater = !looking_for_greater;
+        } else {
+            result_vector.back() = current_value;
+        }
+    }
+    return result_vector;
+}
+
+// Counts sign changes in input[begin, end), given the previous nonzero sign, which is
+// updated to the last nonzero sign seen
+template <typename T>
+size_t CountSignChangesScalar(const T* input, size_t begin, size_t end, int* previous_sign) {
+    size_t num_changes = 0;
+    int last_sign = *previous_sign;
+    for (size_t i = begin; i < end; ++i) {
+        const int sign = static_cast<int>(input[i - 1] < input[i]) -
+                         static_cast<int>(input[i] < input[i - 1]);
+        num_changes += static_cast<size_t>((sign != 0) & (sign != last_sign));
+        last_sign = (sign != 0) ? sign : last_sign;
+    }
+    *previous_sign = last_sign;
+    return num_changes;
+}
+
+#if defined(__AVX2__)
+// Lane i of the result is lane i - kShift of v, with the first kShift lanes taken from carry
+template <int kShift>
+__m256i ShiftLanesUp(__m256i v, __m256i carry) {
+    const __m256i indices = _mm256_setr_epi32(
+            0 - kShift, 1 - kShift, 2 - kShift, 3 - kShift,
+            4 - kShift, 5 - kShift, 6 - kShift, 7 - kShift);
+    const __m256i shifted = _mm256_permutevar8x32_epi32(v, _mm256_max_epi32(indices,
+                                                            _mm256_setzero_si256()));
+    return _mm256_blend_epi32(shifted, carry, (1 << kShift) - 1);
+}
+
+// Same as CountSignChangesScalar, 8 ints at a time
+size_t CountSignChangesAvx2(const int* input, size_t begin, size_t end, int* previous_sign) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i last_lane = _mm256_set1_epi32(7);
+    // All lanes hold the last nonzero sign before the current 8 elements
+    __m256i carry = _mm256_set1_epi32(*previous_sign);
+    size_t num_changes = 0;
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+        const __m256i previous =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i - 1));
+        // -1 - 0 where decreasing, 0 - (-1) where increasing, 0 where equal
+        const __m256i sign = _mm256_sub_epi32(_mm256_cmpgt_epi32(previous, current),
+                                              _mm256_cmpgt_epi32(current, previous));
+        // Replace each zero with the nearest nonzero sign before it
+        __m256i filled = sign;
+        filled = _mm256_blendv_epi8(filled, ShiftLanesUp<1>(filled, carry),
+                                    _mm256_cmpeq_epi32(filled, zero));
+        filled = _mm256_blendv_epi8(filled, ShiftLanesUp<2>(filled, carry),
+                                    _mm256_cmpeq_epi32(filled, zero));
+        filled = _mm256_blendv_epi8(filled, ShiftLanesUp<4>(filled, carry),
+                                    _mm256_cmpeq_epi32(filled, zero));
+        // Lanes that are still zero had only zeros before them in these 8 elements
+        filled = _mm256_blendv_epi8(filled, carry, _mm256_cmpeq_epi32(filled, zero));
+        // A change is a nonzero sign that differs from the filled sign before it
+        const __m256i unchanged = _mm256_or_si256(
+                _mm256_cmpeq_epi32(sign, zero),
+                _mm256_cmpeq_epi32(sign, ShiftLanesUp<1>(filled, carry)));
+        const unsigned unchanged_mask =
+                static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(unchanged)));
+        num_changes += 8 - std::popcount(unchanged_mask);
+        carry = _mm256_permutevar8x32_epi32(filled, last_lane);
+    }
+    *previous_sign = _mm256_cvtsi256_si32(carry);
+    return num_changes + CountSignChangesScalar(input, i, end, previous_sign);
+}
+#endif
+
+// Length of the subsequence ComputeLongestAlternatingSubsequence would return
+template <typename T>
+size_t ComputeLongestAlternatingSubsequenceLength(const std::vector<T>& input_vector) {
+    static_assert(std::is_arithmetic_v<T>, "Length kernel requires an arithmetic type");
+    if (input_vector.empty()) {
+        return 0;
+    }
+    // Pretend the input was preceded by a decrease, so a leading decrease is not a change
+    int previous_sign = -1;
+#if defined(__AVX2__)
+    if constexpr (std::is_same_v<T, int>) {
+        return 1 + CountSignChangesAvx2(input_vector.data(), 1, input_vector.size(),
+                                        &previous_sign);
+    }
+#endif
+    return 1 + CountSignChangesScalar(input_vector.data(), 1, input_vector.size(),
+                                      &previous_sign);
+}
+
+// Scalar kernel only, to measure what the AVX2 kernel adds
+template <typename T>
+size_t ComputeLongestAlternatingSubsequenceLengthScalar(const std::vector<T>& input_vector) {
+    if (input_vector.empty()) {
+        return 0;
+    }
+    int previous_sign = -1;
+    return 1 + CountSignChangesScalar(input_vector.data(), 1, input_vector.size(),
+                                      &previous_sign);
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+int main() {
+    std::vector<int> test_vector{4, 2, 7, 8, 8, 9, 9, 3, 2, 3, 5, 4, 1, 1, 1, 9, 2, 1, 4, 1, 7, 8};
+    std::cout << ComputeLongestAlternatingSubsequence(test_vector) << std::endl;
+    std::cout << "Length: " << ComputeLongestAlternatingSubsequenceLength(test_vector)
+              << std::endl << std::endl;
+
+    // Small value ranges give lots of equal neighbors, which is the tricky case for the kernel
+    std::mt19937 rng(12345);
+    for (int trial = 0; trial < 5000; ++trial) {
+        std::vector<int> random_vector(trial % 100);
+        std::uniform_int_distribution<int> value_dist(0, trial % 6);
+        for (int& value : random_vector) {
+            value = value_dist(rng);
+        }
+        std::vector<double> double_vector(random_vector.begin(), random_vector.end());
+        const size_t expected = ComputeLongestAlternatingSubsequence(random_vector).size();
+        if ((ComputeLongestAlternatingSubsequenceLength(random_vector) != expected) ||
+                (ComputeLongestAlternatingSubsequenceLengthScalar(random_vector) != expected) ||
+                (ComputeLongestAlternatingSubsequenceLength(double_vector) != expected)) {
+            std::cout << "MISMATCH on " << random_vector << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Random inputs: all lengths match" << std::endl << std::endl;
+
+#if defined(__AVX2__)
+    std::cout << "AVX2 kernel enabled" << std::endl;
+#else
+    std::cout << "AVX2 kernel disabled (build with -mavx2), using scalar kernel" << std::endl;
+#endif
+    const size_t kSize = 100'000'000;
+    std::vector<int> input_vector(kSize);
+    std::uniform_int_distribution<int> value_dist(0, 15);
+    for (int& value : input_vector) {
+        value = value_dist(rng);
+    }
+    std::cout << "Benchmark: " << kSize << " elements" << std::endl;
+    size_t reference_length = 0;
+    const double reference_seconds = TimeSeconds([&]() {
+        reference_length = ComputeLongestAlternatingSubsequence(input_vector).size();
+    });
+    std::cout << "    Original:      " << reference_seconds << " s (length " << reference_length
+              << ")" << std::endl;
+    size_t scalar_length = 0;
+    const double scalar_seconds = TimeSeconds([&]() {
+        scalar_length = ComputeLongestAlternatingSubsequenceLengthScalar(input_vector);
+    });
+    std::cout << "    Scalar kernel: " << scalar_seconds << " s, speedup "
+              << reference_seconds / scalar_seconds << "x, "
+              << (scalar_length == reference_length ? "length matches" : "MISMATCH")
+              << std::endl;
+    size_t kernel_length = 0;
+    const double kernel_seconds = TimeSeconds([&]() {
+        kernel_length = ComputeLongestAlternatingSubsequenceLength(input_vector);
+    });
+    std::cout << "    Best kernel:   " << kernel_seconds << " s, speedup "
+              << reference_seconds / kernel_seconds << "x, "
+              << (kernel_length == reference_length ? "length matches" : "MISMATCH")
+              << std::endl;
+
+    return 0;
+}
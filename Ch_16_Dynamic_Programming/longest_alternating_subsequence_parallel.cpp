@@ -0,0 +1,225 @@
+/* Chunk-parallel version of ComputeLongestAlternatingSubsequence
+ * (see longest_alternating_subsequence.cpp).
+ *
+ * The greedy's state after element i - 1 is (last kept value, looking_for_greater).  The last
+ * kept value is always input[i - 1] (each element is either pushed or replaces the last
+ * kept value), so the only state we don't know at the start of a chunk is the flag.  So:
+ *   1. In parallel, find the result of the greedy over each chunk for both values of the
+ *      flag: how many values it pushes and which flag it ends with.  Only one run is needed,
+ *      since the two runs agree from the first unequal pair on: if that pair increases, the
+ *      true run pushes and the false run doesn't, and then both are looking for a decrease
+ *      (and the other way around if it decreases).
+ *   2. Stitch: chunk 0 starts with looking_for_greater = true, and each following chunk
+ *      starts with whatever flag its predecessor ended with (for that predecessor's actual
+ *      starting flag).  Prefix sums of the push counts give each chunk's output position.
+ *   3. In parallel, run the greedy over each chunk again with its actual starting flag,
+ *      writing straight into the output.
+ * Every push at index i finalizes the previous kept value, which by then has been replaced
+ * by input[i - 1]; and the very last kept value is input[n - 1].  So output position k holds
+ * input[(index of push number k + 1) - 1], and a chunk can fill in its part of the output
+ * without knowing anything else about its neighbors.  The result is exactly the sequential
+ * greedy's subsequence.
+ */
+
+#include <cmath>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const std::vector<T>& v) {
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i];
+        if (i + 1 < v.size()) os << ", ";
+    }
+    os << "]";
+    return os;
+}
+
+// Copy of ComputeLongestAlternatingSubsequence from longest_alternating_subsequence.cpp,
+// kept here as the reference for correctness checks and benchmarking
+template <typename T>
+std::vector<T> ComputeLongestAlternatingSubsequence(const std::vector<T>& input_vector) {
+    if (input_vector.size() == 0) {
+        return {};
+    }
+    std::vector<T> result_vector{input_vector[0]};
+    bool looking_for_greater = true;
+    for (std::size_t i = 1; i < input_vector.size(); ++i) {
+        const T& current_value = input_vector[i];
+        const auto compare_func = [looking_for_greater](const T& left, const T& right) {
+            return looking_for_greater ? left < right : left > right;
+        };
+        if (compare_func(result_vector.back(), current_value)) {
+            result_vector.push_back(current_value);
+            looking_for_greater = !looking_for_greater;
+        } else {
+            result_vector.back() = current_value;
+        }
+    }
+    return result_vector;
+}
+
+struct ChunkResult {
+    size_t num_pushes;
+    bool final_looking_for_greater;
+};
+
+// Runs the greedy over input[begin, end) (begin >= 1), starting from the given flag.  If
+// output is not null, output[k] is set to the value finalized by the chunk's k-th push.
+template <typename T>
+ChunkResult RunGreedyOnChunk(const std::vector<T>& input_vector, size_t begin, size_t end,
+                             bool looking_for_greater, T* output) {
+    size_t num_pushes = 0;
+    for (size_t i = begin; i < end; ++i) {
+        const T& last_kept_value = input_vector[i - 1];
+        const T& current_value = input_vector[i];
+        if (looking_for_greater ? (last_kept_value < current_value)
+                                : (current_value < last_kept_value)) {
+            if (output != nullptr) {
+                output[num_pushes] = last_kept_value;
+            }
+            ++num_pushes;
+            looking_for_greater = !looking_for_greater;
+        }
+    }
+    return {num_pushes, looking_for_greater};
+}
+
+// Calls func(thread_index) on num_threads threads (one of them the calling thread)
+template <typename Func>
+void RunOnThreads(size_t num_threads, Func&& func) {
+    std::vector<std::thread> threads;
+    for (size_t thread_index = 1; thread_index < num_threads; ++thread_index) {
+        threads.emplace_back(func, thread_index);
+    }
+    func(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+template <typename T>
+std::vector<T> ComputeLongestAlternatingSubsequenceParallel(const std::vector<T>& input_vector,
+                                                            size_t num_threads) {
+    const size_t n = input_vector.size();
+    if (n == 0) {
+        return {};
+    }
+    // Chunks split up the indices [1, n), since index 0 is just the initial kept value
+    const size_t num_chunks = std::max<size_t>(1, std::min(num_threads, n));
+    auto chunk_begin = [&](size_t chunk) { return 1 + (n - 1) * chunk / num_chunks; };
+
+    // Step 1: both possible starting flags for every chunk
+    std::vector<ChunkResult> result_if_greater(num_chunks);
+    std::vector<ChunkResult> result_if_lesser(num_chunks);
+    RunOnThreads(num_chunks, [&](size_t chunk) {
+        const size_t begin = chunk_begin(chunk);
+        const size_t end = chunk_begin(chunk + 1);
+        result_if_greater[chunk] = RunGreedyOnChunk<T>(input_vector, begin, end, true, nullptr);
+        ChunkResult& result = result_if_lesser[chunk];
+        result = result_if_greater[chunk];
+        size_t i = begin;
+        while ((i < end) && !(input_vector[i - 1] < input_vector[i]) &&
+                !(input_vector[i] < input_vector[i - 1])) {
+            ++i;
+        }
+        if (i == end) {
+            result.final_looking_for_greater = false;
+        } else if (input_vector[i - 1] < input_vector[i]) {
+            --result.num_pushes;
+        } else {
+            ++result.num_pushes;
+        }
+    });
+
+    // Step 2: stitch the chunks together
+    std::vector<bool> starts_looking_for_greater(num_chunks);
+    std::vector<size_t> output_offset(num_chunks);
+    bool looking_for_greater = true;
+    size_t num_pushes = 0;
+    for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+        starts_looking_for_greater[chunk] = looking_for_greater;
+        output_offset[chunk] = num_pushes;
+        const ChunkResult& result =
+                looking_for_greater ? result_if_greater[chunk] : result_if_lesser[chunk];
+        num_pushes += result.num_pushes;
+        looking_for_greater = result.final_looking_for_greater;
+    }
+
+    // Step 3: fill in the output
+    std::vector<T> result_vector(num_pushes + 1);
+    RunOnThreads(num_chunks, [&](size_t chunk) {
+        RunGreedyOnChunk<T>(input_vector, chunk_begin(chunk), chunk_begin(chunk + 1),
+                            starts_looking_for_greater[chunk],
+                            result_vector.data() + output_offset[chunk]);
+    });
+    result_vector.back() = input_vector.back();
+    return result_vector;
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+int main() {
+    std::vector<int> test_vector{4, 2, 7, 8, 8, 9, 9, 3, 2, 3, 5, 4, 1, 1, 1, 9, 2, 1, 4, 1, 7, 8};
+    std::cout << "Sequential: " << ComputeLongestAlternatingSubsequence(test_vector) << std::endl;
+    std::cout << "Parallel:   " << ComputeLongestAlternatingSubsequenceParallel(test_vector, 5)
+              << std::endl << std::endl;
+
+    // The parallel version must return the exact same subsequence for any number of chunks
+    std::mt19937 rng(12345);
+    for (int trial = 0; trial < 5000; ++trial) {
+        std::vector<int> random_vector(trial % 100);
+        std::uniform_int_distribution<int> value_dist(0, trial % 6);
+        for (int& value : random_vector) {
+            value = value_dist(rng);
+        }
+        if (ComputeLongestAlternatingSubsequenceParallel(random_vector, 1 + trial % 13) !=
+                ComputeLongestAlternatingSubsequence(random_vector)) {
+            std::cout << "MISMATCH on " << random_vector << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Random inputs: all subsequences match" << std::endl << std::endl;
+
+    // Noisy sensor-like signal: a slow sine wave plus noise
+    const size_t kSize = 100'000'000;
+    std::vector<double> input_vector(kSize);
+    std::normal_distribution<double> noise_dist(0.0, 0.1);
+    for (size_t i = 0; i < kSize; ++i) {
+        input_vector[i] = std::sin(i * 1e-4) + noise_dist(rng);
+    }
+    std::cout << "Benchmark: " << kSize << " doubles" << std::endl;
+    std::vector<double> sequential_result;
+    const double sequential_seconds = TimeSeconds([&]() {
+        sequential_result = ComputeLongestAlternatingSubsequence(input_vector);
+    });
+    std::cout << "    Sequential: " << sequential_seconds << " s (length "
+              << sequential_result.size() << ")" << std::endl;
+    for (const size_t num_threads : {1, 2, 4, 8, 16}) {
+        std::vector<double> parallel_result;
+        const double parallel_seconds = TimeSeconds([&]() {
+            parallel_result = ComputeLongestAlternatingSubsequenceParallel(input_vector,
+                                                                           num_threads);
+        });
+        std::cout << "    " << num_threads << " thread(s): " << parallel_seconds
+                  << " s, speedup " << sequential_seconds / parallel_seconds << "x, "
+                  << (parallel_result == sequential_result ? "results match" : "MISMATCH")
+                  << std::endl;
+    }
+    std::cout << "(hardware threads available: " << std::thread::hardware_concurrency() << ")"
+              << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,206 @@
+/* Flat-array version of ComputeLongestNondecreasingSubsequence
+ * (see longest_nondecreasing_subsequence_optimal.cpp).
+ *
+ * The BST version keeps one active sequence per length, with the invariant that shorter
+ * sequences have smaller (or equal) end values.  That means the active sequences, ordered by
+ * length, already form a sorted array - the BST and the length -> node hash map are just
+ * two ways of indexing that same array.  So we store it directly:
+ *     tail_values[k]  = end value of the active sequence of length k + 1
+ *     tail_indices[k] = index in the input of that end value
+ * and search it with a binary search.  Predecessors are stored in a flat vector indexed by
+ * input position rather than a hash map.
+ *
+ * Finding "the longest active sequence whose end value is <= current value" is exactly
+ * upper_bound on tail_values, and the new sequence replaces the one at that position (or is
+ * appended).  This makes the same choices as the BST version, including when values repeat:
+ * there, a new sequence ending in an existing end value erases the shorter sequence with
+ * that end value, and here, upper_bound always picks the *last* of several equal tails, so
+ * the shorter ones are never chosen again.  Hence the returned subsequence is identical.
+ */
+
+#include <cstdint>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const std::vector<T>& v) {
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i];
+        if (i + 1 < v.size()) os << ", ";
+    }
+    os << "]";
+    return os;
+}
+
+struct IndexLengthPair {
+    size_t index;
+    size_t length;
+};
+
+// Copy of ComputeLongestNondecreasingSubsequence from
+// longest_nondecreasing_subsequence_optimal.cpp with the logging removed,
+// kept here as the reference for correctness checks and benchmarking
+template <typename T>
+std::vector<T> ComputeLongestNondecreasingSubsequence(const std::vector<T>& input_vector) {
+    std::map<T, IndexLengthPair> active_sequence_bst;
+    using bst_const_iterator = typename std::map<T, IndexLengthPair>::const_iterator;
+    std::unordered_map<size_t, bst_const_iterator> length_to_bstnode_map;
+    size_t max_length = 0;
+    std::unordered_map<size_t, size_t> index_to_previous_index_map;
+    for (size_t i = 0; i < input_vector.size(); ++i) {
+        const T& current_value = input_vector[i];
+        bst_const_iterator upper_bound_it = active_sequence_bst.upper_bound(current_value);
+        const bool found_upper_bound = !(upper_bound_it == active_sequence_bst.begin());
+        bst_const_iterator real_upper_bound_it =
+                found_upper_bound ? std::prev(upper_bound_it) : active_sequence_bst.end();
+        const size_t new_sequence_length =
+                found_upper_bound ? real_upper_bound_it->second.length + 1 : 1;
+        const size_t new_sequence_previous_index =
+                found_upper_bound ? real_upper_bound_it->second.index : -1;
+        if (length_to_bstnode_map.contains(new_sequence_length)) {
+            active_sequence_bst.erase(length_to_bstnode_map[new_sequence_length]);
+            length_to_bstnode_map.erase(new_sequence_length);
+        }
+        if (found_upper_bound && (real_upper_bound_it->first == current_value)) {
+            length_to_bstnode_map.erase(real_upper_bound_it->second.length);
+            active_sequence_bst.erase(real_upper_bound_it);
+        }
+        bst_const_iterator new_sequence_bstnode = active_sequence_bst.insert(
+                std::make_pair(current_value, IndexLengthPair{i, new_sequence_length})).first;
+        length_to_bstnode_map[new_sequence_length] = new_sequence_bstnode;
+        index_to_previous_index_map[i] = new_sequence_previous_index;
+        max_length = std::max(max_length, new_sequence_length);
+    }
+    std::vector<T> longest_subsequence;
+    if (max_length == 0) {
+        return longest_subsequence;
+    }
+    size_t current_index = length_to_bstnode_map[max_length]->second.index;
+    while (current_index != static_cast<size_t>(-1)) {
+        longest_subsequence.push_back(input_vector[current_index]);
+        current_index = index_to_previous_index_map[current_index];
+    }
+    std::reverse(longest_subsequence.begin(), longest_subsequence.end());
+    return longest_subsequence;
+}
+
+// Index of the first element of sorted_values greater than value (like std::upper_bound).
+// The loop always runs log2(n) iterations and the comparison only selects the next base
+// pointer, which compiles to a conditional move instead of an unpredictable branch.
+template <typename T>
+size_t BranchlessUpperBound(const T* sorted_values, size_t n, const T& value) {
+    if (n == 0) {
+        return 0;
+    }
+    const T* base = sorted_values;
+    while (n > 1) {
+        const size_t half = n / 2;
+        base = (value < base[half]) ? base : base + half;
+        n -= half;
+    }
+    return (base - sorted_values) + !(value < *base);
+}
+
+template <typename T>
+std::vector<T> ComputeLongestNondecreasingSubsequenceFlat(const std::vector<T>& input_vector) {
+    constexpr uint32_t kNoPrevious = std::numeric_limits<uint32_t>::max();
+    if (input_vector.size() >= kNoPrevious) {
+        throw std::length_error("Input too large for 32-bit indices");
+    }
+    std::vector<T> tail_values;
+    std::vector<uint32_t> tail_indices;
+    std::vector<uint32_t> previous_index(input_vector.size());
+    for (uint32_t i = 0; i < input_vector.size(); ++i) {
+        const T& current_value = input_vector[i];
+        // Active sequence number `position` (of length position + 1) is replaced or appended
+        const size_t position =
+                BranchlessUpperBound(tail_values.data(), tail_values.size(), current_value);
+        previous_index[i] = (position == 0) ? kNoPrevious : tail_indices[position - 1];
+        if (position == tail_values.size()) {
+            tail_values.push_back(current_value);
+            tail_indices.push_back(i);
+        } else {
+            tail_values[position] = current_value;
+            tail_indices[position] = i;
+        }
+    }
+    // Walk back from the end of the longest active sequence
+    std::vector<T> longest_subsequence(tail_values.size());
+    uint32_t current_index = tail_indices.empty() ? kNoPrevious : tail_indices.back();
+    for (size_t k = longest_subsequence.size(); k-- > 0;) {
+        longest_subsequence[k] = input_vector[current_index];
+        current_index = previous_index[current_index];
+    }
+    return longest_subsequence;
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+int main() {
+    const std::vector<int> test_vector{1, 2, 3, 2, 2, 1, 3, 2, 3, 1, 2, 3, 3};
+    std::cout << "Longest nondec subsequence (BST):  "
+              << ComputeLongestNondecreasingSubsequence(test_vector) << std::endl;
+    std::cout << "Longest nondec subsequence (flat): "
+              << ComputeLongestNondecreasingSubsequenceFlat(test_vector) << std::endl;
+
+    // Both versions must return the exact same subsequence, not just the same length
+    std::mt19937 rng(12345);
+    for (int trial = 0; trial < 2000; ++trial) {
+        std::vector<int> random_vector(trial % 50);
+        std::uniform_int_distribution<int> value_dist(0, 1 + trial % 20);
+        for (int& value : random_vector) {
+            value = value_dist(rng);
+        }
+        if (ComputeLongestNondecreasingSubsequence(random_vector) !=
+                ComputeLongestNondecreasingSubsequenceFlat(random_vector)) {
+            std::cout << "MISMATCH on " << random_vector << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Random inputs: all subsequences match" << std::endl << std::endl;
+
+    // The BST version is only run up to 10^7 elements, since it takes minutes beyond that
+    const size_t kMaxReferenceSize = 10'000'000;
+    for (const size_t size : {1'000'000, 10'000'000, 100'000'000}) {
+        std::vector<int> input_vector(size);
+        std::uniform_int_distribution<int> value_dist(0, 1'000'000);
+        for (int& value : input_vector) {
+            value = value_dist(rng);
+        }
+        std::cout << "Benchmark: " << size << " elements" << std::endl;
+        std::vector<int> flat_result;
+        const double flat_seconds = TimeSeconds([&]() {
+            flat_result = ComputeLongestNondecreasingSubsequenceFlat(input_vector);
+        });
+        std::cout << "    Flat: " << flat_seconds << " s (length " << flat_result.size() << ")"
+                  << std::endl;
+        if (size <= kMaxReferenceSize) {
+            std::vector<int> bst_result;
+            const double bst_seconds = TimeSeconds([&]() {
+                bst_result = ComputeLongestNondecreasingSubsequence(input_vector);
+            });
+            std::cout << "    BST:  " << bst_seconds << " s (length " << bst_result.size()
+                      << "), speedup " << bst_seconds / flat_seconds << "x, "
+                      << (bst_result == flat_result ? "results match" : "MISMATCH")
+                      << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,356 @@
+/* Multi-threaded longest nondecreasing subsequence.
+ *
+ * The flat engine (longest_nondecreasing_subsequence_flat.cpp) keeps the end value of the
+ * active sequence of each length in a sorted array, tail_values, and processes the input in
+ * order: each element replaces the first tail greater than it, or is appended.
+ *
+ * We can't split the input by position and glue the chunk answers together, since what
+ * happens in a chunk depends on everything before it.  Instead we split tail_values by
+ * *value*: pick splitters v_1 < v_2 < ... and let range p own the tails with values in
+ * [v_p, v_p+1).  Since tail_values is sorted, range p owns a contiguous piece of it, and an
+ * element x in range p can only affect that piece and the pieces above it:
+ *   - If range p has a tail greater than x, x replaces the first one.  Nothing else changes.
+ *   - Otherwise x is appended to range p's piece.  In the global array, x lands where the
+ *     smallest tail of the next nonempty higher range was, so that tail is pushed out
+ *     (or if all higher ranges are empty, the global array just grew by one).
+ * So from range p's point of view, the lower ranges only matter through a stream of
+ * "a lower range grew" events, in input order:
+ *   - If range p is nonempty, it loses its smallest tail (the lower range's new tail took
+ *     its place).  Otherwise the event passes on to range p + 1.
+ * Each range is then an independent sequential process over its own elements, merged in
+ * input order with the events coming from the range below.  Every range is run by its own
+ * thread, in a pipeline: the input positions are cut into windows, and range p handles a
+ * window once range p - 1 has published its events for that window.  Each thread's piece of
+ * tail_values is small and stays in cache, just like the sequential engine's.
+ *
+ * Putting it together:
+ *   1. Pick splitters from a sample of the input, so the ranges have similar sizes.
+ *   2. In parallel over chunks of the input, bucket the element indices by range (counting
+ *      then scattering, so each range's list stays in input order).
+ *   3. Run the range pipeline.  The global position of element i is (number of events that
+ *      reached its range so far) + (its position in the range's piece), so each range
+ *      records L(i) = length of the longest nondecreasing subsequence ending at i.
+ *   4. Recover one subsequence from L: take an element with the largest L, then repeatedly
+ *      scan backwards for an element with L one smaller and a value <= the current one.
+ *      One always exists, by the definition of L, and the scan only ever moves backwards,
+ *      so this is O(n).
+ * The length is exact, and the subsequence is a valid longest one, though not always the
+ * same one the sequential engine returns.
+ *
+ * The pipeline needs element values spread out over time: for already sorted input, each
+ * range's elements all come after the previous range's, and the threads run one after
+ * another (no faster than the sequential engine).
+ */
+
+#include <cstdint>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const std::vector<T>& v) {
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i];
+        if (i + 1 < v.size()) os << ", ";
+    }
+    os << "]";
+    return os;
+}
+
+// Index of the first element of sorted_values greater than value (like std::upper_bound)
+template <typename T>
+size_t BranchlessUpperBound(const T* sorted_values, size_t n, const T& value) {
+    if (n == 0) {
+        return 0;
+    }
+    const T* base = sorted_values;
+    while (n > 1) {
+        const size_t half = n / 2;
+        base = (value < base[half]) ? base : base + half;
+        n -= half;
+    }
+    return (base - sorted_values) + !(value < *base);
+}
+
+// Sequential flat engine from longest_nondecreasing_subsequence_flat.cpp, for comparison
+template <typename T>
+std::vector<T> ComputeLongestNondecreasingSubsequenceFlat(const std::vector<T>& input_vector) {
+    constexpr uint32_t kNoPrevious = std::numeric_limits<uint32_t>::max();
+    std::vector<T> tail_values;
+    std::vector<uint32_t> tail_indices;
+    std::vector<uint32_t> previous_index(input_vector.size());
+    for (uint32_t i = 0; i < input_vector.size(); ++i) {
+        const T& current_value = input_vector[i];
+        const size_t position =
+                BranchlessUpperBound(tail_values.data(), tail_values.size(), current_value);
+        previous_index[i] = (position == 0) ? kNoPrevious : tail_indices[position - 1];
+        if (position == tail_values.size()) {
+            tail_values.push_back(current_value);
+            tail_indices.push_back(i);
+        } else {
+            tail_values[position] = current_value;
+            tail_indices[position] = i;
+        }
+    }
+    std::vector<T> longest_subsequence(tail_values.size());
+    uint32_t current_index = tail_indices.empty() ? kNoPrevious : tail_indices.back();
+    for (size_t k = longest_subsequence.size(); k-- > 0;) {
+        longest_subsequence[k] = input_vector[current_index];
+        current_index = previous_index[current_index];
+    }
+    return longest_subsequence;
+}
+
+// Calls func(thread_index) on num_threads threads (one of them the calling thread)
+template <typename Func>
+void RunOnThreads(size_t num_threads, Func&& func) {
+    std::vector<std::thread> threads;
+    for (size_t thread_index = 1; thread_index < num_threads; ++thread_index) {
+        threads.emplace_back(func, thread_index);
+    }
+    func(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+template <typename T>
+std::vector<T> ComputeLongestNondecreasingSubsequenceParallel(
+        const std::vector<T>& input_vector, size_t num_threads, size_t window_size = 1 << 16) {
+    if (input_vector.size() >= std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Input too large for 32-bit indices");
+    }
+    const size_t n = input_vector.size();
+    if (n == 0) {
+        return {};
+    }
+    const size_t num_ranges = std::max<size_t>(1, num_threads);
+
+    // Step 1: range p holds the values in [splitters[p - 1], splitters[p])
+    std::vector<T> sample;
+    const size_t sample_size = std::min(n, 64 * num_ranges);
+    for (size_t k = 0; k < sample_size; ++k) {
+        sample.push_back(input_vector[k * n / sample_size]);
+    }
+    std::sort(sample.begin(), sample.end());
+    std::vector<T> splitters;
+    for (size_t p = 1; p < num_ranges; ++p) {
+        splitters.push_back(sample[p * sample_size / num_ranges]);
+    }
+    auto range_of = [&](const T& value) {
+        return BranchlessUpperBound(splitters.data(), splitters.size(), value);
+    };
+
+    // Step 2: indices grouped by range, each group in input order
+    auto chunk_begin = [&](size_t chunk) { return n * chunk / num_ranges; };
+    std::vector<std::vector<size_t>> chunk_range_counts(num_ranges,
+                                                        std::vector<size_t>(num_ranges, 0));
+    RunOnThreads(num_ranges, [&](size_t chunk) {
+        for (size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+            ++chunk_range_counts[chunk][range_of(input_vector[i])];
+        }
+    });
+    std::vector<size_t> range_begin(num_ranges + 1, 0);
+    std::vector<std::vector<size_t>> chunk_range_offsets(num_ranges,
+                                                         std::vector<size_t>(num_ranges));
+    size_t offset = 0;
+    for (size_t p = 0; p < num_ranges; ++p) {
+        range_begin[p] = offset;
+        for (size_t chunk = 0; chunk < num_ranges; ++chunk) {
+            chunk_range_offsets[chunk][p] = offset;
+            offset += chunk_range_counts[chunk][p];
+        }
+    }
+    range_begin[num_ranges] = n;
+    std::vector<uint32_t> indices_by_range(n);
+    RunOnThreads(num_ranges, [&](size_t chunk) {
+        std::vector<size_t>& next_slot = chunk_range_offsets[chunk];
+        for (size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+            indices_by_range[next_slot[range_of(input_vector[i])]++] = static_cast<uint32_t>(i);
+        }
+    });
+
+    // Step 3: range pipeline.  events[p][w] holds the input indices at which range p passed
+    // a "lower range grew" event up to range p + 1 during window w.
+    const size_t num_windows = (n + window_size - 1) / window_size;
+    std::vector<std::vector<std::vector<uint32_t>>> events(
+            num_ranges, std::vector<std::vector<uint32_t>>(num_windows));
+    std::vector<std::atomic<size_t>> windows_done(num_ranges);
+    std::vector<size_t> final_range_size(num_ranges);
+    std::vector<uint32_t> length_ending_at(n);
+    RunOnThreads(num_ranges, [&](size_t p) {
+        // This range's piece of tail_values is tails[tails_begin, tails.size())
+        std::vector<T> tails;
+        size_t tails_begin = 0;
+        size_t num_lower_tails = 0;
+        const uint32_t* own_index = indices_by_range.data() + range_begin[p];
+        const uint32_t* own_end = indices_by_range.data() + range_begin[p + 1];
+        const std::vector<uint32_t> no_events;
+        for (size_t w = 0; w < num_windows; ++w) {
+            const size_t window_end = std::min(n, (w + 1) * window_size);
+            const std::vector<uint32_t>* incoming = &no_events;
+            if (p > 0) {
+                size_t done = windows_done[p - 1].load(std::memory_order_acquire);
+                while (done <= w) {
+                    windows_done[p - 1].wait(done, std::memory_order_acquire);
+                    done = windows_done[p - 1].load(std::memory_order_acquire);
+                }
+                incoming = &events[p - 1][w];
+            }
+            std::vector<uint32_t>& outgoing = events[p][w];
+            size_t event = 0;
+            while (true) {
+                const bool own_left = (own_index != own_end) && (*own_index < window_end);
+                const bool event_left = (event < incoming->size());
+                if (event_left && (!own_left || ((*incoming)[event] < *own_index))) {
+                    ++num_lower_tails;
+                    if (tails_begin < tails.size()) {
+                        ++tails_begin;
+                    } else {
+                        outgoing.push_back((*incoming)[event]);
+                    }
+                    ++event;
+                } else if (own_left) {
+                    const uint32_t i = *own_index++;
+                    const T& current_value = input_vector[i];
+                    const size_t position = BranchlessUpperBound(
+                            tails.data() + tails_begin, tails.size() - tails_begin,
+                            current_value);
+                    length_ending_at[i] = static_cast<uint32_t>(num_lower_tails + position + 1);
+                    if (tails_begin + position == tails.size()) {
+                        tails.push_back(current_value);
+                        outgoing.push_back(i);
+                    } else {
+                        tails[tails_begin + position] = current_value;
+                    }
+                } else {
+                    break;
+                }
+            }
+            // Tails dropped from the front are reclaimed once they are half the vector
+            if (2 * tails_begin > tails.size()) {
+                tails.erase(tails.begin(), tails.begin() + tails_begin);
+                tails_begin = 0;
+            }
+            if (p > 0) {
+                events[p - 1][w] = std::vector<uint32_t>();
+            }
+            if (p + 1 == num_ranges) {
+                outgoing = std::vector<uint32_t>();  // no range above to pass events to
+            }
+            windows_done[p].store(w + 1, std::memory_order_release);
+            windows_done[p].notify_all();
+        }
+        final_range_size[p] = tails.size() - tails_begin;
+    });
+
+    // Step 4: walk back through L, as described at the top
+    size_t longest_length = 0;
+    for (const size_t range_size : final_range_size) {
+        longest_length += range_size;
+    }
+    std::vector<T> longest_subsequence(longest_length);
+    size_t i = n;
+    do {
+        --i;
+    } while (length_ending_at[i] != longest_length);
+    longest_subsequence[longest_length - 1] = input_vector[i];
+    for (size_t length = longest_length - 1; length >= 1; --length) {
+        const T& next_value = input_vector[i];
+        do {
+            --i;
+        } while ((length_ending_at[i] != length) || (next_value < input_vector[i]));
+        longest_subsequence[length - 1] = input_vector[i];
+    }
+    return longest_subsequence;
+}
+
+template <typename T>
+bool IsNondecreasingSubsequenceOf(const std::vector<T>& subsequence,
+                                  const std::vector<T>& input_vector) {
+    size_t j = 0;
+    for (size_t i = 0; (i < input_vector.size()) && (j < subsequence.size()); ++i) {
+        if (input_vector[i] == subsequence[j]) {
+            ++j;
+        }
+    }
+    return (j == subsequence.size()) &&
+           std::is_sorted(subsequence.begin(), subsequence.end());
+}
+
+template <typename Func>
+double TimeSeconds(Func&& func) {
+    const auto start_time = std::chrono::steady_clock::now();
+    func();
+    const auto end_time = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end_time - start_time).count();
+}
+
+int main() {
+    const std::vector<int> test_vector{1, 2, 3, 2, 2, 1, 3, 2, 3, 1, 2, 3, 3};
+    std::cout << "Longest nondec subsequence (sequential): "
+              << ComputeLongestNondecreasingSubsequenceFlat(test_vector) << std::endl;
+    std::cout << "Longest nondec subsequence (parallel):   "
+              << ComputeLongestNondecreasingSubsequenceParallel(test_vector, 3, 4) << std::endl;
+
+    // The parallel version may pick a different subsequence, but it must have the same
+    // length and be a valid nondecreasing subsequence.  Small windows exercise the pipeline.
+    std::mt19937 rng(12345);
+    for (int trial = 0; trial < 3000; ++trial) {
+        std::vector<int> random_vector(trial % 200);
+        std::uniform_int_distribution<int> value_dist(0, 1 + trial % 50);
+        for (int& value : random_vector) {
+            value = value_dist(rng);
+        }
+        if (trial % 3 == 0) {
+            std::sort(random_vector.begin(), random_vector.end());
+        }
+        const std::vector<int> parallel_result = ComputeLongestNondecreasingSubsequenceParallel(
+                random_vector, 1 + trial % 9, 1 + trial % 17);
+        if ((parallel_result.size() !=
+                ComputeLongestNondecreasingSubsequenceFlat(random_vector).size()) ||
+                !IsNondecreasingSubsequenceOf(parallel_result, random_vector)) {
+            std::cout << "MISMATCH on " << random_vector << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Random inputs: all lengths match, all witnesses valid" << std::endl << std::endl;
+
+    const size_t kSize = 100'000'000;
+    std::vector<int> input_vector(kSize);
+    std::uniform_int_distribution<int> value_dist(0, 1'000'000'000);
+    for (int& value : input_vector) {
+        value = value_dist(rng);
+    }
+    std::cout << "Benchmark: " << kSize << " elements" << std::endl;
+    std::vector<int> sequential_result;
+    const double sequential_seconds = TimeSeconds([&]() {
+        sequential_result = ComputeLongestNondecreasingSubsequenceFlat(input_vector);
+    });
+    std::cout << "    Sequential flat engine: " << sequential_seconds << " s (length "
+              << sequential_result.size() << ")" << std::endl;
+    for (const size_t num_threads : {1, 2, 4, 8, 16}) {
+        std::vector<int> parallel_result;
+        const double parallel_seconds = TimeSeconds([&]() {
+            parallel_result = ComputeLongestNondecreasingSubsequenceParallel(
+                    input_vector, num_threads);
+        });
+        const bool valid = (parallel_result.size() == sequential_result.size()) &&
+                           IsNondecreasingSubsequenceOf(parallel_result, input_vector);
+        std::cout << "    " << num_threads << " thread(s): " << parallel_seconds
+                  << " s, speedup " << sequential_seconds / parallel_seconds << "x, "
+                  << (valid ? "valid" : "INVALID") << std::endl;
+    }
+    std::cout << "(hardware threads available: " << std::thread::hardware_concurrency() << ")"
+              << std::endl;
+
+    return 0;
+}
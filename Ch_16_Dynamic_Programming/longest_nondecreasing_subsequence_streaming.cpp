@@ -0,0 +1,184 @@
+/* Online version of the longest nondecreasing subsequence algorithm
+ * (see longest_nondecreasing_subsequence_flat.cpp).
+ *
+ * The active sequence algorithm only ever looks at the current element and the active
+ * sequences built so far, so nothing stops us from feeding it one element at a time.
+ * The tracker below keeps the algorithm's state between calls to push(), so the current
+ * length is always available in O(1), and the current subsequence can be rebuilt on demand.
+ *
+ * To rebuild the subsequence we need every value seen and its predecessor, which is O(n)
+ * memory.  But the length alone only needs the end values of the active sequences, one per
+ * length, so in length-only mode memory is O(LNDS length) and the tracker can run forever
+ * on an unbounded stream.
+ */
+
+#include <cstdint>
+
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const std::vector<T>& v) {
+    os << "[";
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i];
+        if (i + 1 < v.size()) os << ", ";
+    }
+    os << "]";
+    return os;
+}
+
+// Index of the first element of sorted_values greater than value (like std::upper_bound)
+template <typename T>
+size_t BranchlessUpperBound(const T* sorted_values, size_t n, const T& value) {
+    if (n == 0) {
+        return 0;
+    }
+    const T* base = sorted_values;
+    while (n > 1) {
+        const size_t half = n / 2;
+        base = (value < base[half]) ? base : base + half;
+        n -= half;
+    }
+    return (base - sorted_values) + !(value < *base);
+}
+
+template <typename T>
+class LongestNondecreasingSubsequenceTracker {
+  public:
+    enum class Mode { kLengthOnly, kMaterializable };
+
+    explicit LongestNondecreasingSubsequenceTracker(Mode mode = Mode::kMaterializable)
+            : _mode(mode) {}
+
+    void push(const T& value) {
+        const size_t position = BranchlessUpperBound(_tail_values.data(), _tail_values.size(),
+                                                     value);
+        if (position == _tail_values.size()) {
+            _tail_values.push_back(value);
+        } else {
+            _tail_values[position] = value;
+        }
+        if (_mode == Mode::kLengthOnly) {
+            return;
+        }
+        if (_values.size() >= kNoPrevious) {
+            throw std::length_error("Too many values for 32-bit indices");
+        }
+        const uint32_t index = static_cast<uint32_t>(_values.size());
+        _values.push_back(value);
+        _previous_index.push_back((position == 0) ? kNoPrevious : _tail_indices[position - 1]);
+        if (position == _tail_indices.size()) {
+            _tail_indices.push_back(index);
+        } else {
+            _tail_indices[position] = index;
+        }
+    }
+
+    size_t length() const {
+        return _tail_values.size();
+    }
+
+    // Longest nondecreasing subsequence of all values pushed so far - the same one
+    // ComputeLongestNondecreasingSubsequence would return for them.
+    // Throws std::logic_error in length-only mode.
+    std::vector<T> materialize() const {
+        if (_mode == Mode::kLengthOnly) {
+            throw std::logic_error("Cannot materialize subsequence in length-only mode");
+        }
+        std::vector<T> longest_subsequence(_tail_indices.size());
+        uint32_t current_index = _tail_indices.empty() ? kNoPrevious : _tail_indices.back();
+        for (size_t k = longest_subsequence.size(); k-- > 0;) {
+            longest_subsequence[k] = _values[current_index];
+            current_index = _previous_index[current_index];
+        }
+        return longest_subsequence;
+    }
+
+  private:
+    static constexpr uint32_t kNoPrevious = std::numeric_limits<uint32_t>::max();
+
+    Mode _mode;
+    // End value of the active sequence of each length (the only state length-only mode needs)
+    std::vector<T> _tail_values;
+    // Only used in materializable mode
+    std::vector<uint32_t> _tail_indices;
+    std::vector<T> _values;
+    std::vector<uint32_t> _previous_index;
+};
+
+// Batch version from longest_nondecreasing_subsequence_flat.cpp, to check the tracker against
+template <typename T>
+std::vector<T> ComputeLongestNondecreasingSubsequenceFlat(const std::vector<T>& input_vector) {
+    constexpr uint32_t kNoPrevious = std::numeric_limits<uint32_t>::max();
+    std::vector<T> tail_values;
+    std::vector<uint32_t> tail_indices;
+    std::vector<uint32_t> previous_index(input_vector.size());
+    for (uint32_t i = 0; i < input_vector.size(); ++i) {
+        const T& current_value = input_vector[i];
+        const size_t position =
+                BranchlessUpperBound(tail_values.data(), tail_values.size(), current_value);
+        previous_index[i] = (position == 0) ? kNoPrevious : tail_indices[position - 1];
+        if (position == tail_values.size()) {
+            tail_values.push_back(current_value);
+            tail_indices.push_back(i);
+        } else {
+            tail_values[position] = current_value;
+            tail_indices[position] = i;
+        }
+    }
+    std::vector<T> longest_subsequence(tail_values.size());
+    uint32_t current_index = tail_indices.empty() ? kNoPrevious : tail_indices.back();
+    for (size_t k = longest_subsequence.size(); k-- > 0;) {
+        longest_subsequence[k] = input_vector[current_index];
+        current_index = previous_index[current_index];
+    }
+    return longest_subsequence;
+}
+
+int main() {
+    using Tracker = LongestNondecreasingSubsequenceTracker<int>;
+
+    const std::vector<int> test_vector{1, 2, 3, 2, 2, 1, 3, 2, 3, 1, 2, 3, 3};
+    Tracker tracker;
+    for (const int value : test_vector) {
+        tracker.push(value);
+        std::cout << "push(" << value << "): length = " << tracker.length()
+                  << ", subsequence = " << tracker.materialize() << std::endl;
+    }
+    std::cout << std::endl;
+
+    // After every push, the tracker must agree with the batch algorithm on the prefix so far
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> value_dist(0, 20);
+    Tracker full_tracker;
+    Tracker length_tracker(Tracker::Mode::kLengthOnly);
+    std::vector<int> prefix;
+    for (int i = 0; i < 2000; ++i) {
+        const int value = value_dist(rng);
+        prefix.push_back(value);
+        full_tracker.push(value);
+        length_tracker.push(value);
+        const std::vector<int> expected = ComputeLongestNondecreasingSubsequenceFlat(prefix);
+        if ((full_tracker.materialize() != expected) ||
+                (length_tracker.length() != expected.size())) {
+            std::cout << "MISMATCH after " << prefix.size() << " values" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Random stream: tracker matches batch algorithm after every push" << std::endl;
+
+    // Length-only mode on a long stream: memory stays proportional to the LNDS length
+    Tracker stream_tracker(Tracker::Mode::kLengthOnly);
+    std::uniform_int_distribution<int> stream_dist(0, 1'000'000);
+    for (int i = 0; i < 50'000'000; ++i) {
+        stream_tracker.push(stream_dist(rng));
+    }
+    std::cout << "Length-only tracker after 50000000 values: length = "
+              << stream_tracker.length() << std::endl;
+
+    return 0;
+}